@@ -18,8 +18,9 @@ toolchain = generator.toolchain
 extrasources = []
 
 input_sources = [
-  'event.c', 'input.c', 'input_android.c', 'input_ios.c', 'input_linux.c', 'input_macos.c', 'input_windows.c',
-  'version.c'
+  'action.c', 'clock.c', 'condition.c', 'consumer.c', 'event.c', 'gesture.c', 'input.c', 'input_android.c',
+  'input_evdev.c', 'input_iio.c', 'input_ios.c', 'input_linux.c', 'input_macos.c', 'input_windows.c', 'loadgen.c',
+  'pad.c', 'record.c', 'ring.c', 'sequence.c', 'state.c', 'statistics.c', 'velocity.c', 'version.c'
 ]
 
 input_lib = generator.lib(module = 'input', sources = input_sources + extrasources)
@@ -35,7 +36,7 @@ if generator.is_subninja():
 
 includepaths = generator.test_includepaths()
 
-test_cases = ['basic']
+test_cases = ['basic', 'bench', 'loadgen']
 if toolchain.is_monolithic() or target.is_ios() or target.is_android() or target.is_tizen():
   #Build one fat binary with all test cases
   test_resources = []
@@ -0,0 +1,482 @@
+/* action.c  -  Input actions  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/memory.h>
+#include <foundation/array.h>
+#include <foundation/hashtable.h>
+
+/* Bindings are kept in a source list and compiled into a flat array sorted by key or
+   button code, with a direct index table giving the range of bindings for each code.
+   Axis bindings are compiled the same way by axis. All per action state is allocated up
+   front for the configured capacity, and action state bits are held in bitsets so the
+   snapshot computes edges a word at a time. Bindings are modified and events applied with
+   the event lock held.
+
+   Modifying bindings only marks the table dirty, it is compiled once before the next event
+   is applied or the next snapshot, so binding many actions in a row is linear. Compiling
+   carries the held state of bindings that are still present over to the new table. An
+   unbound action keeps its index until the snapshot after the one showing its release,
+   then the index is recycled for new actions. */
+
+typedef struct input_binding_t input_binding_t;
+
+struct input_binding_t {
+	unsigned int code;
+	unsigned int action;
+	unsigned int modifiers;
+	real value;
+};
+
+static hashtable64_t* input_action_table;
+static size_t input_action_capacity;
+static size_t input_action_count;
+static hash_t* input_action_hash;
+static uint8_t* input_action_unbound;
+static unsigned int* input_action_unbinding;
+static unsigned int* input_action_free;
+static size_t input_action_erased;
+static bool input_action_dirty;
+static unsigned int* input_action_held;
+static real* input_action_hold_value;
+static real* input_action_axis_value;
+static real* input_action_value_frame;
+static uint64_t* input_action_down_live;
+static uint64_t* input_action_changed;
+static uint64_t* input_action_down_frame;
+static uint64_t* input_action_pressed_frame;
+static uint64_t* input_action_released_frame;
+
+static input_binding_t* input_action_bindings;
+static input_binding_t* input_action_compiled;
+static uint8_t* input_action_active;
+static input_binding_t* input_action_carry;
+static unsigned int input_action_code_first[INPUT_CODE_COUNT + 1];
+static input_binding_t* input_action_axis_bindings;
+static input_binding_t* input_action_axis_compiled;
+static unsigned int input_action_axis_first[INPUTAXIS_COUNT + 1];
+
+int
+input_action_initialize(const input_config_t config) {
+	size_t capacity = config.action_capacity ? config.action_capacity : 1024;
+	capacity = (capacity + 63) & ~(size_t)63;
+	size_t words = capacity / 64;
+
+	input_action_table = hashtable64_allocate(capacity * 2);
+	input_action_capacity = capacity;
+	input_action_count = 0;
+	input_action_held = memory_allocate(HASH_INPUT, sizeof(unsigned int) * capacity, 0,
+	                                    MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	input_action_hash =
+	    memory_allocate(HASH_INPUT, sizeof(hash_t) * capacity, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	input_action_unbound = memory_allocate(HASH_INPUT, capacity, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	input_action_dirty = false;
+	input_action_erased = 0;
+	input_action_hold_value =
+	    memory_allocate(HASH_INPUT, sizeof(real) * capacity, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	input_action_axis_value =
+	    memory_allocate(HASH_INPUT, sizeof(real) * capacity, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	input_action_value_frame =
+	    memory_allocate(HASH_INPUT, sizeof(real) * capacity, 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	input_action_down_live = memory_allocate(HASH_INPUT, sizeof(uint64_t) * words * 5, 16,
+	                                         MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	input_action_changed = input_action_down_live + words;
+	input_action_down_frame = input_action_changed + words;
+	input_action_pressed_frame = input_action_down_frame + words;
+	input_action_released_frame = input_action_pressed_frame + words;
+
+	memset(input_action_code_first, 0, sizeof(input_action_code_first));
+	memset(input_action_axis_first, 0, sizeof(input_action_axis_first));
+	return 0;
+}
+
+void
+input_action_finalize(void) {
+	array_deallocate(input_action_bindings);
+	array_deallocate(input_action_compiled);
+	array_deallocate(input_action_active);
+	array_deallocate(input_action_carry);
+	array_deallocate(input_action_unbinding);
+	array_deallocate(input_action_free);
+	array_deallocate(input_action_axis_bindings);
+	array_deallocate(input_action_axis_compiled);
+	memory_deallocate(input_action_held);
+	memory_deallocate(input_action_hash);
+	memory_deallocate(input_action_unbound);
+	memory_deallocate(input_action_hold_value);
+	memory_deallocate(input_action_axis_value);
+	memory_deallocate(input_action_value_frame);
+	memory_deallocate(input_action_down_live);
+	hashtable64_deallocate(input_action_table);
+	input_action_table = 0;
+	input_action_capacity = 0;
+	input_action_count = 0;
+}
+
+static FOUNDATION_FORCEINLINE bool
+input_action_test(const uint64_t* bits, unsigned int action) {
+	return (bits[action >> 6] & (((uint64_t)1) << (action & 63))) != 0;
+}
+
+static unsigned int
+input_action_lookup(hash_t action) {
+	uint64_t index = input_action_table ? hashtable64_get(input_action_table, action) : 0;
+	return index ? (unsigned int)(index - 1) : (unsigned int)input_action_capacity;
+}
+
+static unsigned int
+input_action_register(hash_t action) {
+	unsigned int index = input_action_lookup(action);
+	if (index < input_action_capacity) {
+		// Binding an unbound action again keeps its index
+		if (input_action_unbound[index]) {
+			input_action_unbound[index] = 0;
+			for (size_t iunbind = 0, count = array_size(input_action_unbinding); iunbind < count; ++iunbind) {
+				if (input_action_unbinding[iunbind] == index) {
+					array_erase(input_action_unbinding, iunbind);
+					break;
+				}
+			}
+		}
+		return index;
+	}
+	if (array_size(input_action_free)) {
+		index = input_action_free[array_size(input_action_free) - 1];
+		array_pop(input_action_free);
+	} else if (input_action_count < input_action_capacity) {
+		index = (unsigned int)input_action_count++;
+	} else {
+		return index;
+	}
+	input_action_hash[index] = action;
+	hashtable64_set(input_action_table, action, index + 1);
+	return index;
+}
+
+static void
+input_action_reset(unsigned int index) {
+	uint64_t mask = ~(((uint64_t)1) << (index & 63));
+	size_t word = index >> 6;
+	input_action_down_live[word] &= mask;
+	input_action_changed[word] &= mask;
+	input_action_down_frame[word] &= mask;
+	input_action_pressed_frame[word] &= mask;
+	input_action_released_frame[word] &= mask;
+	input_action_held[index] = 0;
+	input_action_hold_value[index] = 0;
+	input_action_axis_value[index] = 0;
+	input_action_value_frame[index] = 0;
+}
+
+static void
+input_action_retire(void) {
+	// Indices unbound before the previous snapshot have had their release seen and are freed,
+	// indices unbound since are kept until the next snapshot
+	size_t count = array_size(input_action_unbinding);
+	for (size_t iunbind = 0; iunbind < count;) {
+		unsigned int index = input_action_unbinding[iunbind];
+		if (input_action_unbound[index] == 1) {
+			input_action_unbound[index] = 2;
+			++iunbind;
+			continue;
+		}
+		hashtable64_erase(input_action_table, input_action_hash[index]);
+		input_action_hash[index] = 0;
+		++input_action_erased;
+		input_action_reset(index);
+		input_action_unbound[index] = 0;
+		array_push(input_action_free, index);
+		array_erase(input_action_unbinding, iunbind);
+		--count;
+	}
+
+	// Erased keys keep their slot in the table, rebuild it before the slots run out
+	if (input_action_erased >= input_action_capacity) {
+		hashtable64_clear(input_action_table);
+		for (unsigned int iaction = 0; iaction < input_action_count; ++iaction) {
+			if (input_action_hash[iaction])
+				hashtable64_set(input_action_table, input_action_hash[iaction], iaction + 1);
+		}
+		input_action_erased = 0;
+	}
+}
+
+static void
+input_action_compile_bindings(const input_binding_t* bindings, unsigned int* first, unsigned int count,
+                              input_binding_t** compiled) {
+	// Counting sort by code into the flat compiled array
+	size_t binding_count = array_size(bindings);
+	memset(first, 0, sizeof(unsigned int) * (count + 1));
+	for (size_t ibinding = 0; ibinding < binding_count; ++ibinding)
+		++first[bindings[ibinding].code + 1];
+	for (unsigned int icode = 0; icode < count; ++icode)
+		first[icode + 1] += first[icode];
+
+	array_resize(*compiled, binding_count);
+	for (size_t ibinding = 0; ibinding < binding_count; ++ibinding)
+		(*compiled)[first[bindings[ibinding].code]++] = bindings[ibinding];
+	// The fill advanced each start to the end of its range, shift back to get the starts
+	for (unsigned int icode = count; icode > 0; --icode)
+		first[icode] = first[icode - 1];
+	first[0] = 0;
+}
+
+static void
+input_action_compile(void) {
+	// Keep the held bindings aside to find them again in the new table
+	array_clear(input_action_carry);
+	for (size_t ibinding = 0, bound = array_size(input_action_compiled); ibinding < bound; ++ibinding) {
+		if (input_action_active[ibinding])
+			array_push_memcpy(input_action_carry, input_action_compiled + ibinding);
+	}
+
+	input_action_compile_bindings(input_action_bindings, input_action_code_first, INPUT_CODE_COUNT,
+	                              &input_action_compiled);
+	input_action_compile_bindings(input_action_axis_bindings, input_action_axis_first, INPUTAXIS_COUNT,
+	                              &input_action_axis_compiled);
+	array_resize(input_action_active, array_size(input_action_compiled));
+	if (array_size(input_action_active))
+		memset(input_action_active, 0, array_size(input_action_active));
+
+	for (size_t icarry = 0, carried = array_size(input_action_carry); icarry < carried; ++icarry) {
+		const input_binding_t* held = input_action_carry + icarry;
+		for (unsigned int ibinding = input_action_code_first[held->code];
+		     ibinding < input_action_code_first[held->code + 1]; ++ibinding) {
+			const input_binding_t* binding = input_action_compiled + ibinding;
+			if (!input_action_active[ibinding] && (binding->action == held->action) &&
+			    (binding->modifiers == held->modifiers)) {
+				input_action_active[ibinding] = 1;
+				break;
+			}
+		}
+	}
+
+	// Recount held actions, only actions that lost all their held bindings are released
+	memset(input_action_held, 0, sizeof(unsigned int) * input_action_count);
+	memset(input_action_hold_value, 0, sizeof(real) * input_action_count);
+	for (size_t ibinding = 0, bound = array_size(input_action_compiled); ibinding < bound; ++ibinding) {
+		if (input_action_active[ibinding]) {
+			const input_binding_t* binding = input_action_compiled + ibinding;
+			++input_action_held[binding->action];
+			input_action_hold_value[binding->action] += binding->value;
+		}
+	}
+	for (unsigned int iaction = 0; iaction < input_action_count; ++iaction) {
+		uint64_t bit = ((uint64_t)1) << (iaction & 63);
+		bool down = (input_action_held[iaction] != 0);
+		if (down != input_action_test(input_action_down_live, iaction)) {
+			input_action_down_live[iaction >> 6] ^= bit;
+			input_action_changed[iaction >> 6] |= bit;
+		}
+	}
+	input_action_dirty = false;
+}
+
+static bool
+input_action_bind(hash_t action, unsigned int code, unsigned int modifiers, real value, bool axis) {
+	bool bound = false;
+	input_event_lock();
+	unsigned int index = input_action_register(action);
+	if (index < input_action_capacity) {
+		input_binding_t binding;
+		binding.code = code;
+		binding.action = index;
+		binding.modifiers = modifiers;
+		binding.value = value;
+		if (axis)
+			array_push_memcpy(input_action_axis_bindings, &binding);
+		else
+			array_push_memcpy(input_action_bindings, &binding);
+		input_action_dirty = true;
+		bound = true;
+	}
+	input_event_unlock();
+	return bound;
+}
+
+bool
+input_action_bind_key(hash_t action, unsigned int key, unsigned int modifiers, real value) {
+	unsigned int index = input_key_index(key);
+	if (index >= INPUT_KEY_COUNT)
+		return false;
+	return input_action_bind(action, index, modifiers, value, false);
+}
+
+bool
+input_action_bind_mouse(hash_t action, unsigned int button, unsigned int modifiers, real value) {
+	unsigned int code = input_mouse_code(button);
+	if (code >= INPUT_CODE_COUNT)
+		return false;
+	return input_action_bind(action, code, modifiers, value, false);
+}
+
+bool
+input_action_bind_axis(hash_t action, input_axis_id axis, real scale) {
+	if ((unsigned int)axis >= INPUTAXIS_COUNT)
+		return false;
+	return input_action_bind(action, (unsigned int)axis, 0, scale, true);
+}
+
+static void
+input_action_unbind_list(input_binding_t* bindings, unsigned int index) {
+	for (size_t ibinding = 0; ibinding < array_size(bindings);) {
+		if (bindings[ibinding].action == index)
+			array_erase(bindings, ibinding);
+		else
+			++ibinding;
+	}
+}
+
+void
+input_action_unbind(hash_t action) {
+	input_event_lock();
+	unsigned int index = input_action_lookup(action);
+	if ((index < input_action_capacity) && !input_action_unbound[index]) {
+		input_action_unbind_list(input_action_bindings, index);
+		input_action_unbind_list(input_action_axis_bindings, index);
+		input_action_unbound[index] = 1;
+		array_push(input_action_unbinding, index);
+		input_action_dirty = true;
+	}
+	input_event_unlock();
+}
+
+static void
+input_action_transition(unsigned int code, bool down) {
+	unsigned int first = input_action_code_first[code];
+	unsigned int last = input_action_code_first[code + 1];
+	if (first == last)
+		return;
+	unsigned int modifiers = down ? input_state_modifiers() : 0;
+	for (unsigned int ibinding = first; ibinding < last; ++ibinding) {
+		const input_binding_t* binding = input_action_compiled + ibinding;
+		unsigned int action = binding->action;
+		uint64_t bit = ((uint64_t)1) << (action & 63);
+		if (down) {
+			if (input_action_active[ibinding] || ((binding->modifiers & modifiers) != binding->modifiers))
+				continue;
+			input_action_active[ibinding] = 1;
+			input_action_hold_value[action] += binding->value;
+			if (!input_action_held[action]++) {
+				input_action_down_live[action >> 6] |= bit;
+				input_action_changed[action >> 6] |= bit;
+			}
+		} else {
+			if (!input_action_active[ibinding])
+				continue;
+			input_action_active[ibinding] = 0;
+			input_action_hold_value[action] -= binding->value;
+			if (!--input_action_held[action]) {
+				input_action_hold_value[action] = 0;
+				input_action_down_live[action >> 6] &= ~bit;
+				input_action_changed[action >> 6] |= bit;
+			}
+		}
+	}
+}
+
+static void
+input_action_move(input_axis_id axis, real delta) {
+	for (unsigned int ibinding = input_action_axis_first[axis]; ibinding < input_action_axis_first[axis + 1];
+	     ++ibinding) {
+		const input_binding_t* binding = input_action_axis_compiled + ibinding;
+		input_action_axis_value[binding->action] += delta * binding->value;
+	}
+}
+
+void
+input_action_apply(unsigned int id, const input_event_payload_t* payload) {
+	if (!input_action_count)
+		return;
+	if (input_action_dirty)
+		input_action_compile();
+	switch (id) {
+		case INPUTEVENT_KEYDOWN:
+		case INPUTEVENT_KEYUP: {
+			unsigned int index = input_key_index(payload->key.key);
+			if (index < INPUT_KEY_COUNT)
+				input_action_transition(index, id == INPUTEVENT_KEYDOWN);
+			break;
+		}
+
+		case INPUTEVENT_MOUSEDOWN:
+		case INPUTEVENT_MOUSEUP:
+			for (unsigned int ibutton = 0; ibutton < INPUT_MOUSE_BUTTON_COUNT; ++ibutton) {
+				if (payload->mouse.button & (1U << ibutton))
+					input_action_transition(INPUT_KEY_COUNT + ibutton, id == INPUTEVENT_MOUSEDOWN);
+			}
+			break;
+
+		case INPUTEVENT_MOUSEMOVE:
+			input_action_move(INPUTAXIS_MOUSE_X, payload->mouse.dx);
+			input_action_move(INPUTAXIS_MOUSE_Y, payload->mouse.dy);
+			input_action_move(INPUTAXIS_MOUSE_WHEEL, payload->mouse.dz);
+			break;
+
+		case INPUTEVENT_TOUCHMOVE:
+			input_action_move(INPUTAXIS_TOUCH_X, payload->touch.dx);
+			input_action_move(INPUTAXIS_TOUCH_Y, payload->touch.dy);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void
+input_action_snapshot(void) {
+	if (input_action_dirty)
+		input_action_compile();
+	size_t words = (input_action_count + 63) / 64;
+	for (size_t iword = 0; iword < words; ++iword) {
+		input_bitset_edges(input_action_down_live[iword], input_action_down_frame[iword], input_action_changed[iword],
+		                   input_action_pressed_frame + iword, input_action_released_frame + iword);
+		input_action_down_frame[iword] = input_action_down_live[iword];
+		input_action_changed[iword] = 0;
+	}
+	for (size_t iaction = 0; iaction < input_action_count; ++iaction) {
+		input_action_value_frame[iaction] = input_action_hold_value[iaction] + input_action_axis_value[iaction];
+		input_action_axis_value[iaction] = 0;
+	}
+	if (array_size(input_action_unbinding))
+		input_action_retire();
+}
+
+bool
+input_action_down(hash_t action) {
+	unsigned int index = input_action_lookup(action);
+	return (index < input_action_capacity) && input_action_test(input_action_down_frame, index);
+}
+
+bool
+input_action_pressed(hash_t action) {
+	unsigned int index = input_action_lookup(action);
+	return (index < input_action_capacity) && input_action_test(input_action_pressed_frame, index);
+}
+
+bool
+input_action_released(hash_t action) {
+	unsigned int index = input_action_lookup(action);
+	return (index < input_action_capacity) && input_action_test(input_action_released_frame, index);
+}
+
+real
+input_action_value(hash_t action) {
+	unsigned int index = input_action_lookup(action);
+	return (index < input_action_capacity) ? input_action_value_frame[index] : 0;
+}
@@ -0,0 +1,85 @@
+/* action.h  -  Input actions  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file action.h
+    Input actions. Actions are identified by a hash and bound to keys, mouse buttons and
+    axes. Bindings are compiled into a table indexed directly by key and button, so each
+    event updates the bound actions without searching. Action state is snapshotted along
+    with the input state in input_event_process and queries read the latest snapshot.
+    Bindings take effect for events drained after the call. Actions held through a binding
+    that is kept stay held when other bindings change, a key already held when it is bound
+    is picked up on its next press. */
+
+#include <input/types.h>
+
+/*! Bind a key to an action. The binding only triggers if all the given modifiers are
+held when the key is pressed, and holds the action until the key is released.
+\param action Action
+\param key Key code
+\param modifiers Required modifiers, see input_key_modifier_id
+\param value Value added to the action value while the key is held
+\return true if bound, false if the key is not tracked or action capacity is exhausted */
+INPUT_API bool
+input_action_bind_key(hash_t action, unsigned int key, unsigned int modifiers, real value);
+
+/*! Bind a mouse button to an action
+\param action Action
+\param button Mouse button, see input_mouse_button_id
+\param modifiers Required modifiers, see input_key_modifier_id
+\param value Value added to the action value while the button is held
+\return true if bound, false if button is invalid or action capacity is exhausted */
+INPUT_API bool
+input_action_bind_mouse(hash_t action, unsigned int button, unsigned int modifiers, real value);
+
+/*! Bind an axis to an action. Axis movement between two snapshots is accumulated and
+added to the action value
+\param action Action
+\param axis Axis
+\param scale Scale applied to axis movement
+\return true if bound, false if axis is invalid or action capacity is exhausted */
+INPUT_API bool
+input_action_bind_axis(hash_t action, input_axis_id axis, real scale);
+
+/*! Remove all bindings of an action. A held action is released in the next snapshot, and
+the action no longer counts towards the action capacity after the snapshot following that
+\param action Action */
+INPUT_API void
+input_action_unbind(hash_t action);
+
+/*! Query if an action is held down
+\param action Action
+\return true if action is down, false if not */
+INPUT_API bool
+input_action_down(hash_t action);
+
+/*! Query if an action was pressed since the previous snapshot
+\param action Action
+\return true if action was pressed, false if not */
+INPUT_API bool
+input_action_pressed(hash_t action);
+
+/*! Query if an action was released since the previous snapshot
+\param action Action
+\return true if action was released, false if not */
+INPUT_API bool
+input_action_released(hash_t action);
+
+/*! Get action value, the sum of values of held bindings and accumulated axis movement
+\param action Action
+\return Action value */
+INPUT_API real
+input_action_value(hash_t action);
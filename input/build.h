@@ -19,3 +19,9 @@
     Build setup */
 
 #include <foundation/platform.h>
+
+/*! Maintain event counters and latency histograms, see statistics.h. Counting is cheap
+enough to leave enabled in release builds */
+#ifndef INPUT_ENABLE_STATISTICS
+#define INPUT_ENABLE_STATISTICS 1
+#endif
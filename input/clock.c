@@ -0,0 +1,95 @@
+/* clock.c  -  Input timestamp clock domains  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/time.h>
+
+#if FOUNDATION_PLATFORM_POSIX
+#include <foundation/posix.h>
+#include <time.h>
+#endif
+
+/* Native events are stamped in the clock of their source. Millisecond clocks such as the X
+   server time have an unknown epoch and wrap at 32 bits, so they are extended to 64 bits and
+   mapped with the smallest offset to the tick clock observed so far. Delivery delay only
+   ever adds to the observed offset, so the smallest one is the best estimate and converted
+   timestamps are never later than the time they were observed. The monotonic nanosecond
+   clock used by evdev and Android is mapped with an offset measured once at startup. */
+
+#define INPUT_CLOCK_RESYNC_MS 1000
+
+static tick_t input_clock_monotonic_offset;
+
+static tick_t
+input_clock_ticks_from_ns(int64_t ns) {
+	tick_t ticks_per_second = time_ticks_per_second();
+	if (ticks_per_second == 1000000000LL)
+		return ns;
+	return ((ns / 1000000000LL) * ticks_per_second) + (((ns % 1000000000LL) * ticks_per_second) / 1000000000LL);
+}
+
+#if FOUNDATION_PLATFORM_POSIX
+
+static int64_t
+input_clock_monotonic_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((int64_t)ts.tv_sec * 1000000000LL) + (int64_t)ts.tv_nsec;
+}
+
+#endif
+
+void
+input_clock_initialize(void) {
+#if FOUNDATION_PLATFORM_POSIX
+	// Bracket the monotonic clock read with tick clock reads and use the midpoint
+	tick_t before = time_current();
+	int64_t monotonic = input_clock_monotonic_ns();
+	tick_t after = time_current();
+	input_clock_monotonic_offset = (before + ((after - before) / 2)) - input_clock_ticks_from_ns(monotonic);
+#else
+	input_clock_monotonic_offset = 0;
+#endif
+}
+
+tick_t
+input_clock_from_monotonic(int64_t ns, tick_t now) {
+	tick_t timestamp = input_clock_ticks_from_ns(ns) + input_clock_monotonic_offset;
+	return (timestamp < now) ? timestamp : now;
+}
+
+tick_t
+input_clock_from_milliseconds(input_clock_t* clock, uint32_t ms, tick_t now) {
+	int32_t delta = (int32_t)(ms - clock->last);
+	if (!clock->valid || (delta < -INPUT_CLOCK_RESYNC_MS)) {
+		// First sample, or the source clock was reset
+		clock->extended = ms;
+		clock->valid = false;
+	} else {
+		clock->extended += delta;
+	}
+	clock->last = ms;
+
+	tick_t source = (clock->extended * time_ticks_per_second()) / 1000;
+	tick_t offset = now - source;
+	if (!clock->valid || (offset < clock->offset)) {
+		clock->offset = offset;
+		clock->valid = true;
+	}
+	return source + clock->offset;
+}
@@ -0,0 +1,212 @@
+/* condition.c  -  Analog signal conditioning  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/math.h>
+#include <foundation/time.h>
+
+/* Channels are stored as a structure of arrays. Parameters are precomputed when a channel
+   is configured so the pass over all channels is straight line arithmetic on flat arrays,
+   with selects instead of branches, which compilers vectorize. The One Euro filter runs at
+   the snapshot interval with a fixed cutoff for the speed estimate, as in the reference
+   implementation. Exponential smoothing is the special case of zero beta, and a bypass
+   mask turns smoothing off without a branch per channel. */
+
+#define INPUT_CONDITION_DERIVATIVE_CUTOFF REAL_C(1.0)
+
+typedef struct input_condition_channels_t input_condition_channels_t;
+
+struct input_condition_channels_t {
+	real raw[INPUTCHANNEL_COUNT];
+	real shaped[INPUTCHANNEL_COUNT];
+	real value[INPUTCHANNEL_COUNT];
+	real derivative[INPUTCHANNEL_COUNT];
+	real normalize[INPUTCHANNEL_COUNT];
+	real deadzone[INPUTCHANNEL_COUNT];
+	real stretch[INPUTCHANNEL_COUNT];
+	real curve[INPUTCHANNEL_COUNT];
+	real output[INPUTCHANNEL_COUNT];
+	real cutoff[INPUTCHANNEL_COUNT];
+	real beta[INPUTCHANNEL_COUNT];
+	real bypass[INPUTCHANNEL_COUNT];
+	real restart[INPUTCHANNEL_COUNT];
+	input_condition_t condition[INPUTCHANNEL_COUNT];
+};
+
+static input_condition_channels_t input_condition_channels;
+static real input_condition_acceleration[3];
+static real input_condition_rotation[3];
+static tick_t input_condition_timestamp;
+
+static void
+input_condition_store(unsigned int channel, const input_condition_t* condition) {
+	input_condition_channels_t* channels = &input_condition_channels;
+	real range = (condition->range > 0) ? condition->range : REAL_ONE;
+	real scale = (condition->scale != 0) ? condition->scale : REAL_ONE;
+	real deadzone = (condition->deadzone > 0) ? condition->deadzone : 0;
+	if (deadzone > REAL_C(0.999))
+		deadzone = REAL_C(0.999);
+	channels->condition[channel] = *condition;
+	channels->normalize[channel] = REAL_ONE / range;
+	channels->deadzone[channel] = deadzone;
+	channels->stretch[channel] = REAL_ONE / (REAL_ONE - deadzone);
+	channels->curve[channel] = condition->curve;
+	channels->output[channel] = range * scale;
+	channels->cutoff[channel] = condition->cutoff;
+	channels->beta[channel] = condition->beta;
+	channels->bypass[channel] = (condition->cutoff > 0) ? 0 : REAL_ONE;
+	channels->restart[channel] = REAL_ONE;
+	channels->derivative[channel] = 0;
+}
+
+void
+input_condition_initialize(void) {
+	input_condition_t condition;
+	memset(&condition, 0, sizeof(condition));
+	memset(&input_condition_channels, 0, sizeof(input_condition_channels));
+	for (unsigned int ichannel = 0; ichannel < INPUTCHANNEL_COUNT; ++ichannel)
+		input_condition_store(ichannel, &condition);
+	memset(input_condition_acceleration, 0, sizeof(input_condition_acceleration));
+	memset(input_condition_rotation, 0, sizeof(input_condition_rotation));
+	input_condition_timestamp = 0;
+}
+
+void
+input_condition_apply(unsigned int id, const input_event_payload_t* payload) {
+	if (id == INPUTEVENT_ACCELERATION) {
+		input_condition_acceleration[0] = payload->acceleration.x;
+		input_condition_acceleration[1] = payload->acceleration.y;
+		input_condition_acceleration[2] = payload->acceleration.z;
+	} else if (id == INPUTEVENT_ROTATION) {
+		input_condition_rotation[0] = payload->acceleration.x;
+		input_condition_rotation[1] = payload->acceleration.y;
+		input_condition_rotation[2] = payload->acceleration.z;
+	}
+}
+
+static void
+input_condition_shape(input_condition_channels_t* channels, size_t count) {
+	const real* RESTRICT raw = channels->raw;
+	const real* RESTRICT normalize = channels->normalize;
+	const real* RESTRICT deadzone = channels->deadzone;
+	const real* RESTRICT stretch = channels->stretch;
+	const real* RESTRICT curve = channels->curve;
+	const real* RESTRICT output = channels->output;
+	real* RESTRICT shaped = channels->shaped;
+	for (size_t ichannel = 0; ichannel < count; ++ichannel) {
+		real normalized = raw[ichannel] * normalize[ichannel];
+		real magnitude = math_abs(normalized) - deadzone[ichannel];
+		magnitude = ((magnitude > 0) ? magnitude : 0) * stretch[ichannel];
+		magnitude += curve[ichannel] * ((magnitude * magnitude * magnitude) - magnitude);
+		real sign = (normalized < 0) ? -REAL_ONE : REAL_ONE;
+		shaped[ichannel] = sign * magnitude * output[ichannel];
+	}
+}
+
+static void
+input_condition_smooth(input_condition_channels_t* channels, size_t count, real dt) {
+	const real* RESTRICT shaped = channels->shaped;
+	const real* RESTRICT cutoff = channels->cutoff;
+	const real* RESTRICT beta = channels->beta;
+	const real* RESTRICT bypass = channels->bypass;
+	const real* RESTRICT restart = channels->restart;
+	real* RESTRICT value = channels->value;
+	real* RESTRICT derivative = channels->derivative;
+	real rate = REAL_ONE / dt;
+	real tau = REAL_TWOPI * INPUT_CONDITION_DERIVATIVE_CUTOFF * dt;
+	real derivative_alpha = tau / (tau + REAL_ONE);
+	for (size_t ichannel = 0; ichannel < count; ++ichannel) {
+		real previous = value[ichannel];
+		real speed = (shaped[ichannel] - previous) * rate;
+		real filtered = derivative[ichannel] + derivative_alpha * (speed - derivative[ichannel]);
+		real cut = REAL_TWOPI * (cutoff[ichannel] + beta[ichannel] * math_abs(filtered)) * dt;
+		real alpha = cut / (cut + REAL_ONE);
+		bool hold = (bypass[ichannel] + restart[ichannel]) > 0;
+		alpha = hold ? REAL_ONE : alpha;
+		derivative[ichannel] = (restart[ichannel] > 0) ? 0 : filtered;
+		value[ichannel] = previous + alpha * (shaped[ichannel] - previous);
+	}
+	memset(channels->restart, 0, sizeof(real) * count);
+}
+
+void
+input_condition_snapshot(void) {
+	input_condition_channels_t* channels = &input_condition_channels;
+	const input_state_t* state = input_state();
+	channels->raw[INPUTCHANNEL_ACCELERATION_X] = input_condition_acceleration[0];
+	channels->raw[INPUTCHANNEL_ACCELERATION_Y] = input_condition_acceleration[1];
+	channels->raw[INPUTCHANNEL_ACCELERATION_Z] = input_condition_acceleration[2];
+	channels->raw[INPUTCHANNEL_ROTATION_X] = input_condition_rotation[0];
+	channels->raw[INPUTCHANNEL_ROTATION_Y] = input_condition_rotation[1];
+	channels->raw[INPUTCHANNEL_ROTATION_Z] = input_condition_rotation[2];
+	channels->raw[INPUTCHANNEL_MOUSE_DX] = state->mouse_dx;
+	channels->raw[INPUTCHANNEL_MOUSE_DY] = state->mouse_dy;
+	channels->raw[INPUTCHANNEL_MOUSE_WHEEL] = state->mouse_wheel;
+	for (unsigned int ipad = 0; ipad < INPUT_PAD_MAX; ++ipad)
+		memcpy(channels->raw + INPUTCHANNEL_PAD + (ipad * PADAXIS_COUNT), input_pad_state(ipad)->axis,
+		       sizeof(real) * PADAXIS_COUNT);
+
+	// Snapshots in the same tick are one tick apart, the first snapshot restarts all filters
+	tick_t timestamp = state->timestamp;
+	if (timestamp <= input_condition_timestamp)
+		timestamp = input_condition_timestamp + 1;
+	real dt = input_condition_timestamp ? (real)time_ticks_to_seconds(timestamp - input_condition_timestamp) : REAL_ONE;
+	input_condition_timestamp = timestamp;
+
+	input_condition_shape(channels, INPUTCHANNEL_COUNT);
+	input_condition_smooth(channels, INPUTCHANNEL_COUNT, dt);
+}
+
+void
+input_condition_set(input_channel_id channel, unsigned int count, const input_condition_t* condition) {
+	input_condition_t passthrough;
+	memset(&passthrough, 0, sizeof(passthrough));
+	if (!condition)
+		condition = &passthrough;
+	input_event_lock();
+	for (unsigned int ichannel = (unsigned int)channel; (ichannel < INPUTCHANNEL_COUNT) && count; ++ichannel, --count)
+		input_condition_store(ichannel, condition);
+	input_event_unlock();
+}
+
+input_condition_t
+input_condition(input_channel_id channel) {
+	input_condition_t condition;
+	memset(&condition, 0, sizeof(condition));
+	if ((unsigned int)channel < INPUTCHANNEL_COUNT) {
+		input_event_lock();
+		condition = input_condition_channels.condition[channel];
+		input_event_unlock();
+	}
+	return condition;
+}
+
+real
+input_channel_value(input_channel_id channel) {
+	return ((unsigned int)channel < INPUTCHANNEL_COUNT) ? input_condition_channels.value[channel] : 0;
+}
+
+real
+input_channel_raw(input_channel_id channel) {
+	return ((unsigned int)channel < INPUTCHANNEL_COUNT) ? input_condition_channels.raw[channel] : 0;
+}
+
+const real*
+input_channel_values(void) {
+	return input_condition_channels.value;
+}
@@ -0,0 +1,66 @@
+/* condition.h  -  Analog signal conditioning  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file condition.h
+    Analog signal conditioning. Acceleration, mouse movement and pad axes are gathered as
+    input channels in each call to input_event_process, and all channels are conditioned in
+    one pass: dead zone, response curve and scale, then smoothing with a One Euro filter at
+    the interval between snapshots. Channels pass through unchanged until configured. Events
+    and the input and pad state keep the raw values, conditioned values are read with
+    input_channel_value and are stable until the next call to input_event_process. */
+
+#include <input/types.h>
+
+/*! Get the channel of a pad axis
+\param pad Pad index
+\param axis Axis
+\return Channel */
+static FOUNDATION_FORCEINLINE input_channel_id
+input_channel_pad(unsigned int pad, input_pad_axis_id axis) {
+	return (input_channel_id)(INPUTCHANNEL_PAD + (pad * PADAXIS_COUNT) + (unsigned int)axis);
+}
+
+/*! Set the conditioning of a range of channels. The smoothing filter of the channels
+restarts from the next snapshot
+\param channel First channel
+\param count Number of channels
+\param condition Conditioning, null to pass values through unchanged */
+INPUT_API void
+input_condition_set(input_channel_id channel, unsigned int count, const input_condition_t* condition);
+
+/*! Get the conditioning of a channel
+\param channel Channel
+\return Conditioning, zero initialized if channel is out of range */
+INPUT_API input_condition_t
+input_condition(input_channel_id channel);
+
+/*! Get the conditioned value of a channel in the latest snapshot
+\param channel Channel
+\return Conditioned value, zero if channel is out of range */
+INPUT_API real
+input_channel_value(input_channel_id channel);
+
+/*! Get the raw value of a channel in the latest snapshot
+\param channel Channel
+\return Raw value, zero if channel is out of range */
+INPUT_API real
+input_channel_raw(input_channel_id channel);
+
+/*! Get the conditioned values of all channels in the latest snapshot
+\return Array of INPUTCHANNEL_COUNT values indexed by channel */
+INPUT_API const real*
+input_channel_values(void);
@@ -0,0 +1,178 @@
+/* consumer.c  -  Input event broadcast consumers  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/atomic.h>
+#include <foundation/memory.h>
+
+#define INPUT_CONSUMER_MAX 32
+
+/* The broadcast ring has a single writer, the event pump, which runs with the event lock
+   held. Consumers are registered and unregistered with the same lock held. Each consumer
+   publishes the index of the oldest event it may still reference, and the writer only
+   recomputes the minimum over all consumers once its cached room runs out, so the write
+   cost does not grow with the number of consumers. */
+
+FOUNDATION_ALIGNED_STRUCT(input_consumer_t, 64) {
+	uint64_t mask;
+	int64_t read;
+	atomic64_t release;
+};
+
+static input_event_t* input_broadcast_events;
+static int64_t input_broadcast_capacity;
+static int64_t input_broadcast_mask;
+static atomic64_t input_broadcast_head;
+static int64_t input_broadcast_room_cached;
+static input_consumer_t* input_broadcast_consumers[INPUT_CONSUMER_MAX];
+static size_t input_broadcast_consumer_count;
+
+int
+input_broadcast_initialize(size_t capacity) {
+	int64_t size = 64;
+	while (size < (int64_t)capacity)
+		size <<= 1;
+	input_broadcast_events =
+	    memory_allocate(HASH_INPUT, sizeof(input_event_t) * (size_t)size, 64, MEMORY_PERSISTENT);
+	input_broadcast_capacity = size;
+	input_broadcast_mask = size - 1;
+	input_broadcast_room_cached = size;
+	input_broadcast_consumer_count = 0;
+	atomic_store64(&input_broadcast_head, 0, memory_order_release);
+	return 0;
+}
+
+void
+input_broadcast_finalize(void) {
+	for (size_t iconsumer = 0; iconsumer < input_broadcast_consumer_count; ++iconsumer)
+		memory_deallocate(input_broadcast_consumers[iconsumer]);
+	input_broadcast_consumer_count = 0;
+	memory_deallocate(input_broadcast_events);
+	input_broadcast_events = 0;
+}
+
+bool
+input_broadcast_enabled(void) {
+	return input_broadcast_events != 0;
+}
+
+static int64_t
+input_broadcast_oldest(int64_t write) {
+	int64_t oldest = write;
+	for (size_t iconsumer = 0; iconsumer < input_broadcast_consumer_count; ++iconsumer) {
+		int64_t release = atomic_load64(&input_broadcast_consumers[iconsumer]->release, memory_order_acquire);
+		if (release < oldest)
+			oldest = release;
+	}
+	return oldest;
+}
+
+size_t
+input_broadcast_room(size_t required) {
+	if (input_broadcast_room_cached < (int64_t)required) {
+		int64_t write = atomic_load64(&input_broadcast_head, memory_order_relaxed);
+		input_broadcast_room_cached = input_broadcast_capacity - (write - input_broadcast_oldest(write));
+	}
+	return (size_t)input_broadcast_room_cached;
+}
+
+bool
+input_broadcast_write(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	if (!input_broadcast_room(1))
+		return false;
+	int64_t write = atomic_load64(&input_broadcast_head, memory_order_relaxed);
+	input_event_t* event = input_broadcast_events + (write & input_broadcast_mask);
+	event->id = id;
+	event->size = (unsigned int)size;
+	event->timestamp = timestamp;
+	if (size)
+		memcpy(&event->payload, payload, size);
+	--input_broadcast_room_cached;
+	atomic_store64(&input_broadcast_head, write + 1, memory_order_release);
+	return true;
+}
+
+input_consumer_t*
+input_consumer_allocate(uint64_t mask) {
+	if (!input_broadcast_enabled())
+		return 0;
+	input_consumer_t* consumer = 0;
+	input_event_lock();
+	if (input_broadcast_consumer_count < INPUT_CONSUMER_MAX) {
+		consumer = memory_allocate(HASH_INPUT, sizeof(input_consumer_t), 64, MEMORY_PERSISTENT);
+		consumer->mask = mask;
+		consumer->read = atomic_load64(&input_broadcast_head, memory_order_relaxed);
+		atomic_store64(&consumer->release, consumer->read, memory_order_release);
+		input_broadcast_consumers[input_broadcast_consumer_count++] = consumer;
+	}
+	input_event_unlock();
+	return consumer;
+}
+
+void
+input_consumer_deallocate(input_consumer_t* consumer) {
+	if (!consumer)
+		return;
+	input_event_lock();
+	for (size_t iconsumer = 0; iconsumer < input_broadcast_consumer_count; ++iconsumer) {
+		if (input_broadcast_consumers[iconsumer] == consumer) {
+			input_broadcast_consumers[iconsumer] = input_broadcast_consumers[--input_broadcast_consumer_count];
+			break;
+		}
+	}
+	input_event_unlock();
+	memory_deallocate(consumer);
+}
+
+const input_event_t*
+input_consumer_next(input_consumer_t* consumer) {
+	int64_t write = atomic_load64(&input_broadcast_head, memory_order_acquire);
+	if (consumer->read == write) {
+		// Releasing everything read so far before pumping gives the writer the most room
+		atomic_store64(&consumer->release, consumer->read, memory_order_release);
+		input_event_pump();
+		write = atomic_load64(&input_broadcast_head, memory_order_acquire);
+	}
+	while (consumer->read < write) {
+		int64_t index = consumer->read++;
+		const input_event_t* event = input_broadcast_events + (index & input_broadcast_mask);
+		if (consumer->mask & INPUT_EVENT_MASK(event->id)) {
+			atomic_store64(&consumer->release, index, memory_order_release);
+			return event;
+		}
+	}
+	atomic_store64(&consumer->release, consumer->read, memory_order_release);
+	return 0;
+}
+
+size_t
+input_consumer_lag(const input_consumer_t* consumer) {
+	int64_t write = atomic_load64(&input_broadcast_head, memory_order_acquire);
+	return (size_t)(write - consumer->read);
+}
+
+size_t
+input_broadcast_lag(void) {
+	if (!input_broadcast_enabled())
+		return 0;
+	input_event_lock();
+	int64_t write = atomic_load64(&input_broadcast_head, memory_order_relaxed);
+	size_t lag = (size_t)(write - input_broadcast_oldest(write));
+	input_event_unlock();
+	return lag;
+}
@@ -0,0 +1,61 @@
+/* consumer.h  -  Input event broadcast consumers  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file consumer.h
+    Broadcast event consumers. When the broadcast ring is enabled with
+    input_config_t.event_broadcast_size, events are published to a ring that any number
+    of consumers read through their own cursor, instead of the single input event stream.
+    Events are read in place, a consumer never copies events it is not interested in. The
+    ring is only overwritten once every consumer has moved past an event, so the slowest
+    consumer applies back pressure to the event queue and its overflow policy. */
+
+#include <input/types.h>
+
+/*! Event mask bit for the given event id */
+#define INPUT_EVENT_MASK(id) (((uint64_t)1) << (unsigned int)(id))
+
+/*! Event mask matching all events */
+#define INPUT_EVENT_MASK_ALL (~(uint64_t)0)
+
+/*! Register a new consumer. The consumer starts reading at the next event published.
+\param mask Mask of events the consumer is interested in, see INPUT_EVENT_MASK
+\return New consumer, null if broadcast is not enabled or too many consumers are registered */
+INPUT_API input_consumer_t*
+input_consumer_allocate(uint64_t mask);
+
+/*! Unregister and deallocate a consumer
+\param consumer Consumer */
+INPUT_API void
+input_consumer_deallocate(input_consumer_t* consumer);
+
+/*! Read the next event matching the consumer mask. The returned event is valid until the
+next call for the same consumer. Each consumer must only be read from one thread at a time.
+\param consumer Consumer
+\return Next event, null if no more events are available */
+INPUT_API const input_event_t*
+input_consumer_next(input_consumer_t* consumer);
+
+/*! Get number of published events the consumer has not yet read
+\param consumer Consumer
+\return Number of events */
+INPUT_API size_t
+input_consumer_lag(const input_consumer_t* consumer);
+
+/*! Get number of published events the slowest consumer has not yet read
+\return Number of events */
+INPUT_API size_t
+input_broadcast_lag(void);
@@ -0,0 +1,53 @@
+/* evdev.h  -  Linux evdev input  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file evdev.h
+    Linux evdev input. Keyboard, mouse and gamepad input is read directly from the event
+    device nodes in /dev/input, bypassing the window system, and works without a display
+    server. Events are read in batches from all devices with epoll when input_event_process
+    is called, or as they arrive on the input thread if enabled in the input configuration,
+    and the events of each SYN_REPORT frame are posted together with the frame timestamp.
+    Mouse position is the sum of relative motion, or the absolute position reported by
+    absolute pointer devices. Character events are not posted, as text input requires a
+    keymap. On platforms other than Linux the functions are available but no devices can
+    be attached. */
+
+#include <input/types.h>
+
+/*! Attach an open file descriptor as an evdev device. The descriptor can be an event device
+node or any other readable descriptor carrying a stream of struct input_event records, such
+as a pipe replaying a stream captured from a device node. The descriptor is set non-blocking
+and on success is owned by the input library, closed when the device is detached at end of
+stream, on error or when the input module is finalized. Devices can be attached from any
+thread
+\param fd File descriptor
+\return true if attached, false if not */
+INPUT_API bool
+input_evdev_attach(int fd);
+
+/*! Attach an open file descriptor as an evdev gamepad or joystick, see input_evdev_attach
+and pad.h. Descriptors that are not device nodes are assumed to report sticks in the range
+of signed 16-bit integers and triggers in [0,255]
+\param fd File descriptor
+\return Pad index if attached, -1 if not */
+INPUT_API int
+input_evdev_attach_pad(int fd);
+
+/*! Get the number of attached evdev devices
+\return Number of devices */
+INPUT_API size_t
+input_evdev_device_count(void);
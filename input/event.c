@@ -18,43 +18,611 @@
 #include <input/internal.h>
 
 #include <foundation/event.h>
+#include <foundation/atomic.h>
+#include <foundation/thread.h>
+#include <foundation/mutex.h>
+#include <foundation/array.h>
 #include <foundation/log.h>
+#include <foundation/string.h>
+#include <foundation/time.h>
 
 event_stream_t* input_event_stream_current;
 
+#define INPUT_EVENT_PENDING_MAX 32
+#define INPUT_EVENT_EVICT_MAX 64
+#define INPUT_EVENT_DERIVED_MAX 2
+#define INPUT_EVENT_CHAR_BATCH 32
+
+static input_ring_t* input_event_ring;
+static bool input_event_broadcasting;
+static bool input_event_gestures;
+static bool input_event_text_runs;
+static atomic32_t input_event_pump_lock;
+static mutex_t* input_event_pump_mutex;
+static bool input_event_realtime;
+static bool input_event_compact;
+static bool input_event_coalescing;
+static input_event_t input_event_pending[INPUT_EVENT_PENDING_MAX];
+static unsigned int input_event_pending_samples[INPUT_EVENT_PENDING_MAX];
+static size_t input_event_pending_count;
+static input_overflow_policy input_event_overflow;
+static mutex_t* input_event_overflow_lock;
+static input_event_t* input_event_overflow_records;
+static atomic32_t input_event_overflowing;
+static input_event_t* input_event_evicted;
+static size_t input_event_queued;
+static size_t input_event_high_water;
+static atomic64_t input_event_dropped;
+static atomic64_t input_event_consumer;
+static uint64_t input_event_coalesced;
+static uint64_t input_event_overflowed;
+static tick_t input_event_publish_time;
+
 int
-input_event_initialize(void) {
-	input_event_stream_current = event_stream_allocate(1024);
+input_event_initialize(const input_config_t config) {
+	size_t stream_size = config.event_stream_size ? config.event_stream_size : 1024;
+	size_t ring_size = config.event_ring_size ? config.event_ring_size : stream_size;
+
+	input_event_stream_current = event_stream_allocate(stream_size);
+	input_event_ring = input_ring_allocate(ring_size);
+	input_event_broadcasting = (config.event_broadcast_size > 0);
+	if (input_event_broadcasting)
+		input_broadcast_initialize(config.event_broadcast_size);
+	atomic_store32(&input_event_pump_lock, 0, memory_order_release);
+	/* A real-time input thread spinning on the lock or on a full ring can starve the thread it
+	waits on, so block in the scheduler instead of yielding when a thread priority is set */
+	input_event_realtime = (config.thread && (config.thread_priority > 0));
+	if (input_event_realtime)
+		input_event_pump_mutex = mutex_allocate(STRING_CONST("input_event_pump"));
+	input_event_compact = config.event_compact;
+	input_event_coalescing = config.event_coalesce;
+	input_event_gestures = config.event_gestures;
+	input_event_text_runs = config.event_text_runs;
+	if (input_event_gestures)
+		input_gesture_initialize();
+	input_event_pending_count = 0;
+	input_event_overflow = config.event_overflow;
+	input_event_overflow_lock = mutex_allocate(STRING_CONST("input_event_overflow"));
+	atomic_store32(&input_event_overflowing, 0, memory_order_release);
+	input_event_queued = 0;
+	input_event_high_water = 0;
+	atomic_store64(&input_event_dropped, 0, memory_order_release);
+	atomic_store64(&input_event_consumer, (int64_t)thread_id(), memory_order_release);
+	input_event_coalesced = 0;
+	input_event_overflowed = 0;
+	input_state_initialize();
 	return 0;
 }
 
 void
 input_event_finalize(void) {
+	input_ring_deallocate(input_event_ring);
+	input_event_ring = 0;
+	if (input_event_broadcasting)
+		input_broadcast_finalize();
+	input_event_broadcasting = false;
+	array_deallocate(input_event_overflow_records);
+	array_deallocate(input_event_evicted);
+	mutex_deallocate(input_event_overflow_lock);
+	input_event_overflow_lock = 0;
+	mutex_deallocate(input_event_pump_mutex);
+	input_event_pump_mutex = 0;
+	input_event_realtime = false;
 	event_stream_deallocate(input_event_stream_current);
+	input_event_stream_current = 0;
+}
+
+static int16_t
+input_event_saturate16(int value) {
+	if (value > INT16_MAX)
+		return INT16_MAX;
+	if (value < INT16_MIN)
+		return INT16_MIN;
+	return (int16_t)value;
+}
+
+static void
+input_event_write(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	if (input_event_broadcasting) {
+		// Room is reserved before publishing, count anything beyond that instead of losing it silently
+		if (!input_broadcast_write(id, timestamp, payload, size))
+			atomic_incr64(&input_event_dropped, memory_order_relaxed);
+		return;
+	}
+	if (!input_event_compact || !size) {
+		event_post(input_event_stream_current, (int)id, 0, timestamp, size ? payload : 0, size);
+		return;
+	}
+
+	switch (id) {
+		case INPUTEVENT_KEYDOWN:
+		case INPUTEVENT_KEYUP:
+		case INPUTEVENT_CHAR: {
+			input_key_compact_t key;
+			key.key = payload->key.key;
+			key.scancode = (uint16_t)payload->key.scancode;
+			key.flags = (uint16_t)payload->key.flags;
+			event_post(input_event_stream_current, (int)id, 0, timestamp, &key, sizeof(key));
+			break;
+		}
+
+		case INPUTEVENT_MOUSEDOWN:
+		case INPUTEVENT_MOUSEUP:
+		case INPUTEVENT_MOUSEMOVE: {
+			input_mouse_compact_t mouse;
+			mouse.x = input_event_saturate16(payload->mouse.x);
+			mouse.y = input_event_saturate16(payload->mouse.y);
+			mouse.dx = (float32_t)payload->mouse.dx;
+			mouse.dy = (float32_t)payload->mouse.dy;
+			mouse.dz = (float32_t)payload->mouse.dz;
+			mouse.button = (uint8_t)payload->mouse.button;
+			mouse.buttons = (uint8_t)payload->mouse.buttons;
+			event_post(input_event_stream_current, (int)id, 0, timestamp, &mouse, sizeof(mouse));
+			break;
+		}
+
+		case INPUTEVENT_TOUCHBEGIN:
+		case INPUTEVENT_TOUCHEND:
+		case INPUTEVENT_TOUCHCANCEL:
+		case INPUTEVENT_TOUCHMOVE:
+		case INPUTEVENT_TOUCHSWIPE: {
+			input_touch_compact_t touch;
+			touch.x = input_event_saturate16(payload->touch.x);
+			touch.y = input_event_saturate16(payload->touch.y);
+			touch.dx = (float32_t)payload->touch.dx;
+			touch.dy = (float32_t)payload->touch.dy;
+			touch.velocity = (float32_t)payload->touch.velocity;
+			touch.touch = (uint16_t)payload->touch.touch;
+			touch.touches = (uint16_t)payload->touch.touches;
+			event_post(input_event_stream_current, (int)id, 0, timestamp, &touch, sizeof(touch));
+			break;
+		}
+
+		case INPUTEVENT_ACCELERATION:
+		case INPUTEVENT_ROTATION: {
+			input_acceleration_compact_t acceleration;
+			acceleration.x = (float32_t)payload->acceleration.x;
+			acceleration.y = (float32_t)payload->acceleration.y;
+			acceleration.z = (float32_t)payload->acceleration.z;
+			event_post(input_event_stream_current, (int)id, 0, timestamp, &acceleration, sizeof(acceleration));
+			break;
+		}
+
+		default:
+			event_post(input_event_stream_current, (int)id, 0, timestamp, payload, size);
+			break;
+	}
+}
+
+bool
+input_event_decode(const event_t* event, input_event_payload_t* payload) {
+	size_t size = event->size - sizeof(event_t);
+	if (!size)
+		return false;
+
+	if (input_event_compact) {
+		switch (event->id) {
+			case INPUTEVENT_KEYDOWN:
+			case INPUTEVENT_KEYUP:
+			case INPUTEVENT_CHAR: {
+				const input_key_compact_t* key = (const input_key_compact_t*)event->payload;
+				if (size < sizeof(*key))
+					return false;
+				payload->key.key = key->key;
+				payload->key.scancode = key->scancode;
+				payload->key.flags = key->flags;
+				return true;
+			}
+
+			case INPUTEVENT_MOUSEDOWN:
+			case INPUTEVENT_MOUSEUP:
+			case INPUTEVENT_MOUSEMOVE: {
+				const input_mouse_compact_t* mouse = (const input_mouse_compact_t*)event->payload;
+				if (size < sizeof(*mouse))
+					return false;
+				payload->mouse.x = mouse->x;
+				payload->mouse.y = mouse->y;
+				payload->mouse.dx = (real)mouse->dx;
+				payload->mouse.dy = (real)mouse->dy;
+				payload->mouse.dz = (real)mouse->dz;
+				payload->mouse.button = mouse->button;
+				payload->mouse.buttons = mouse->buttons;
+				return true;
+			}
+
+			case INPUTEVENT_TOUCHBEGIN:
+			case INPUTEVENT_TOUCHEND:
+			case INPUTEVENT_TOUCHCANCEL:
+			case INPUTEVENT_TOUCHMOVE:
+			case INPUTEVENT_TOUCHSWIPE: {
+				const input_touch_compact_t* touch = (const input_touch_compact_t*)event->payload;
+				if (size < sizeof(*touch))
+					return false;
+				payload->touch.x = touch->x;
+				payload->touch.y = touch->y;
+				payload->touch.dx = (real)touch->dx;
+				payload->touch.dy = (real)touch->dy;
+				payload->touch.velocity = (real)touch->velocity;
+				payload->touch.touch = touch->touch;
+				payload->touch.touches = touch->touches;
+				return true;
+			}
+
+			case INPUTEVENT_ACCELERATION:
+			case INPUTEVENT_ROTATION: {
+				const input_acceleration_compact_t* acceleration = (const input_acceleration_compact_t*)event->payload;
+				if (size < sizeof(*acceleration))
+					return false;
+				payload->acceleration.x = (real)acceleration->x;
+				payload->acceleration.y = (real)acceleration->y;
+				payload->acceleration.z = (real)acceleration->z;
+				return true;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	if (size > sizeof(input_event_payload_t))
+		size = sizeof(input_event_payload_t);
+	memcpy(payload, event->payload, size);
+	return true;
+}
+
+void
+input_event_lock(void) {
+	if (input_event_pump_mutex) {
+		mutex_lock(input_event_pump_mutex);
+		return;
+	}
+	while (!atomic_cas32(&input_event_pump_lock, 1, 0, memory_order_acquire, memory_order_relaxed))
+		thread_yield();
+}
+
+void
+input_event_unlock(void) {
+	if (input_event_pump_mutex) {
+		mutex_unlock(input_event_pump_mutex);
+		return;
+	}
+	atomic_store32(&input_event_pump_lock, 0, memory_order_release);
+}
+
+static void
+input_event_wait(void) {
+	// Yielding does not let a lower priority consumer run, sleep to give up the core
+	if (input_event_realtime)
+		thread_sleep(1);
+	else
+		thread_yield();
+}
+
+static void
+input_event_flush(void) {
+	for (size_t ipending = 0; ipending < input_event_pending_count; ++ipending) {
+		const input_event_t* record = input_event_pending + ipending;
+		input_event_write(record->id, record->timestamp, &record->payload, record->size);
+	}
+	input_event_pending_count = 0;
+}
+
+static bool
+input_event_coalesce(unsigned int id, tick_t timestamp, const input_event_payload_t* payload) {
+	for (size_t ipending = 0; ipending < input_event_pending_count; ++ipending) {
+		input_event_t* record = input_event_pending + ipending;
+		if (record->id != id)
+			continue;
+		if ((id == INPUTEVENT_TOUCHMOVE) && (record->payload.touch.touch != payload->touch.touch))
+			continue;
+		// Merged events carry the timestamp of the latest sample
+		record->timestamp = timestamp;
+		if (id == INPUTEVENT_MOUSEMOVE) {
+			record->payload.mouse.x = payload->mouse.x;
+			record->payload.mouse.y = payload->mouse.y;
+			record->payload.mouse.dx += payload->mouse.dx;
+			record->payload.mouse.dy += payload->mouse.dy;
+			record->payload.mouse.dz += payload->mouse.dz;
+			record->payload.mouse.button = payload->mouse.button;
+			record->payload.mouse.buttons = payload->mouse.buttons;
+			++input_event_coalesced;
+			return true;
+		}
+		if (id == INPUTEVENT_TOUCHMOVE) {
+			record->payload.touch.x = payload->touch.x;
+			record->payload.touch.y = payload->touch.y;
+			record->payload.touch.dx += payload->touch.dx;
+			record->payload.touch.dy += payload->touch.dy;
+			record->payload.touch.velocity = payload->touch.velocity;
+			record->payload.touch.touches = payload->touch.touches;
+			++input_event_coalesced;
+			return true;
+		}
+		// Acceleration and rotation samples are averaged over the coalesced run
+		real weight = REAL_ONE / (real)(++input_event_pending_samples[ipending]);
+		record->payload.acceleration.x += (payload->acceleration.x - record->payload.acceleration.x) * weight;
+		record->payload.acceleration.y += (payload->acceleration.y - record->payload.acceleration.y) * weight;
+		record->payload.acceleration.z += (payload->acceleration.z - record->payload.acceleration.z) * weight;
+		++input_event_coalesced;
+		return true;
+	}
+	return false;
+}
+
+static bool
+input_event_is_continuous(unsigned int id) {
+	return (id == INPUTEVENT_MOUSEMOVE) || (id == INPUTEVENT_TOUCHMOVE) || (id == INPUTEVENT_ACCELERATION) ||
+	       (id == INPUTEVENT_ROTATION);
+}
+
+static void
+input_event_queue(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	if (input_event_coalescing) {
+		if (input_event_is_continuous(id) && size) {
+			if (input_event_coalesce(id, timestamp, payload))
+				return;
+			if (input_event_pending_count == INPUT_EVENT_PENDING_MAX)
+				input_event_flush();
+			input_event_t* record = input_event_pending + input_event_pending_count;
+			input_event_pending_samples[input_event_pending_count++] = 1;
+			record->id = id;
+			record->size = (unsigned int)size;
+			record->timestamp = timestamp;
+			memcpy(&record->payload, payload, size);
+			return;
+		}
+		// Discrete events flush pending continuous events first to preserve ordering
+		input_event_flush();
+	}
+	input_event_write(id, timestamp, payload, size);
+}
+
+/* Publish an event to consumers. Must be called with the event lock held by the thread
+   draining the event ring, which makes this the single point where events are serialized
+   and where derived state is updated. Posting threads only write to the ring and never take
+   the event lock. Events derived from the published event, like gestures, are published
+   after it */
+void
+input_event_publish(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	++input_event_queued;
+	input_event_payload_t tracked;
+	if (size && input_velocity_apply(id, timestamp, payload, &tracked))
+		payload = &tracked;
+	if (size) {
+		input_state_apply(id, timestamp, payload);
+		input_action_apply(id, payload);
+		input_sequence_apply(id, timestamp, payload);
+		input_condition_apply(id, payload);
+	}
+	input_statistics_publish(timestamp, input_event_publish_time);
+	input_event_queue(id, timestamp, payload, size);
+	if (input_event_gestures && size)
+		input_gesture_apply(id, timestamp, payload);
+}
+
+/* Check if the broadcast ring has room for a publish, which can flush all pending
+   coalesced events ahead of the published event */
+static bool
+input_event_can_publish(void) {
+	size_t required = input_event_pending_count + 1 + INPUT_EVENT_DERIVED_MAX;
+	return !input_event_broadcasting || (input_broadcast_room(required) >= required);
+}
+
+void
+input_event_pump(void) {
+	input_event_lock();
+	input_event_publish_time = time_current();
+	atomic_store64(&input_event_consumer, (int64_t)thread_id(), memory_order_relaxed);
+
+	// Discrete events evicted from the ring by the drop oldest policy precede anything in the ring
+	size_t evicted_count = array_size(input_event_evicted);
+	size_t ievicted = 0;
+	for (; (ievicted < evicted_count) && input_event_can_publish(); ++ievicted) {
+		const input_event_t* record = input_event_evicted + ievicted;
+		input_event_publish(record->id, record->timestamp, &record->payload, record->size);
+	}
+	if (ievicted)
+		array_erase_ordered_range(input_event_evicted, 0, ievicted);
+
+	if (ievicted == evicted_count) {
+		const input_event_t* record;
+		while (input_event_can_publish() && (record = input_ring_peek(input_event_ring))) {
+			input_event_publish(record->id, record->timestamp, &record->payload, record->size);
+			input_ring_pop(input_event_ring);
+		}
+
+		// Overflowed events follow the ring, but only once every claimed slot has been drained
+		// so an event still being written to the ring is not overtaken by later overflowed events
+		if (atomic_load32(&input_event_overflowing, memory_order_acquire) && !input_ring_size(input_event_ring)) {
+			mutex_lock(input_event_overflow_lock);
+			size_t overflow_count = array_size(input_event_overflow_records);
+			size_t ioverflow = 0;
+			for (; (ioverflow < overflow_count) && input_event_can_publish(); ++ioverflow) {
+				const input_event_t* overflow = input_event_overflow_records + ioverflow;
+				input_event_publish(overflow->id, overflow->timestamp, &overflow->payload, overflow->size);
+			}
+			if (ioverflow == overflow_count) {
+				array_clear(input_event_overflow_records);
+				atomic_store32(&input_event_overflowing, 0, memory_order_release);
+			} else if (ioverflow) {
+				array_erase_ordered_range(input_event_overflow_records, 0, ioverflow);
+			}
+			mutex_unlock(input_event_overflow_lock);
+		}
+	}
+
+	if (!input_event_broadcasting || (input_broadcast_room(input_event_pending_count) >= input_event_pending_count))
+		input_event_flush();
+
+	if (input_event_queued > input_event_high_water)
+		input_event_high_water = input_event_queued;
+	input_event_queued = 0;
+
+	input_event_unlock();
+}
+
+static void
+input_event_post_overflow(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	input_event_t record;
+	record.id = id;
+	record.size = (unsigned int)size;
+	record.timestamp = timestamp;
+	if (size)
+		memcpy(&record.payload, payload, size);
+	mutex_lock(input_event_overflow_lock);
+	array_push_memcpy(input_event_overflow_records, &record);
+	++input_event_overflowed;
+	atomic_store32(&input_event_overflowing, 1, memory_order_release);
+	mutex_unlock(input_event_overflow_lock);
+}
+
+static void
+input_event_evict(void) {
+	// Act as the consumer and pop from the head until a continuous event has been dropped,
+	// moving discrete events aside so they are still delivered in order on the next drain.
+	// Discrete events moved aside are bounded by the ring capacity, beyond that the oldest
+	// discrete event is dropped as well
+	bool evicted = false;
+	size_t evicted_max = input_ring_capacity(input_event_ring);
+	input_event_lock();
+	for (int ievict = 0; ievict < INPUT_EVENT_EVICT_MAX; ++ievict) {
+		const input_event_t* record = input_ring_peek(input_event_ring);
+		if (!record)
+			break;
+		bool continuous = input_event_is_continuous(record->id);
+		if (continuous) {
+			atomic_incr64(&input_event_dropped, memory_order_relaxed);
+		} else {
+			if (array_size(input_event_evicted) >= evicted_max) {
+				array_erase_ordered(input_event_evicted, 0);
+				atomic_incr64(&input_event_dropped, memory_order_relaxed);
+			}
+			array_push_memcpy(input_event_evicted, record);
+		}
+		input_ring_pop(input_event_ring);
+		evicted = true;
+		if (continuous)
+			break;
+	}
+	input_event_unlock();
+	if (!evicted)
+		input_event_wait();
+}
+
+static void
+input_event_post_ring(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	// While events are in the overflow buffer, following events must go there too to keep order
+	if (atomic_load32(&input_event_overflowing, memory_order_acquire)) {
+		input_event_post_overflow(id, timestamp, payload, size);
+		return;
+	}
+	while (!input_ring_post(input_event_ring, id, timestamp, payload, size)) {
+		switch (input_event_overflow) {
+			case INPUTOVERFLOW_GROW:
+				input_event_post_overflow(id, timestamp, payload, size);
+				return;
+			case INPUTOVERFLOW_DROP_NEWEST:
+				atomic_incr64(&input_event_dropped, memory_order_relaxed);
+				return;
+			case INPUTOVERFLOW_DROP_OLDEST:
+				input_event_evict();
+				break;
+			case INPUTOVERFLOW_BLOCK:
+			default:
+				// Waiting on the thread draining the ring would never return
+				if (thread_id() == (uint64_t)atomic_load64(&input_event_consumer, memory_order_relaxed)) {
+					input_event_post_overflow(id, timestamp, payload, size);
+					return;
+				}
+				input_event_wait();
+				break;
+		}
+	}
+}
+
+void
+input_event_post_payload(input_event_id id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	input_statistics_post((unsigned int)id, 1);
+	input_record_post((unsigned int)id, timestamp, payload, size);
+	input_event_post_ring((unsigned int)id, timestamp, payload, size);
+}
+
+void
+input_event_post_payload_batch(input_event_id id, tick_t timestamp, const void* payload, size_t size, size_t count) {
+	const uint8_t* source = payload;
+	input_statistics_post((unsigned int)id, count);
+	input_record_post_batch((unsigned int)id, timestamp, payload, size, count);
+	size_t posted = 0;
+	if (!atomic_load32(&input_event_overflowing, memory_order_acquire))
+		posted = input_ring_post_batch(input_event_ring, (unsigned int)id, timestamp, payload, size, count);
+	// Remainder that did not fit goes through the overflow policy one event at a time
+	for (source += posted * size; posted < count; ++posted, source += size)
+		input_event_post_ring((unsigned int)id, timestamp, (const input_event_payload_t*)source, size);
+}
+
+void
+input_event_process(void) {
+	input_event_process_native();
+	input_event_pump();
+	input_event_lock();
+	// A long press is published here outside of the pump, so it needs room in the broadcast
+	// ring as well. If there is none it is picked up on a later frame
+	if (input_event_gestures && input_event_can_publish())
+		input_gesture_update(time_current());
+	input_state_snapshot();
+	input_pad_snapshot();
+	input_condition_snapshot();
+	input_action_snapshot();
+	input_sequence_snapshot();
+	input_event_unlock();
 }
 
 event_stream_t*
 input_event_stream(void) {
+	input_event_pump();
 	return input_event_stream_current;
 }
 
 void
 input_event_post(input_event_id id) {
-	event_post(input_event_stream_current, (int)id, 0, 0, 0, 0);
+	input_event_post_payload(id, time_current(), 0, 0);
 }
 
 void
 input_event_post_key(input_event_id id, unsigned int key, unsigned int scancode, unsigned int flags) {
+	input_event_post_key_at(id, time_current(), key, scancode, flags);
+}
+
+void
+input_event_post_mouse(input_event_id id, int x, int y, real dx, real dy, real dz, unsigned int button,
+                       unsigned int buttons) {
+	input_event_post_mouse_at(id, time_current(), x, y, dx, dy, dz, button, buttons);
+}
+
+void
+input_event_post_touch(input_event_id id, int x, int y, real dx, real dy, real velocity, unsigned int touch,
+                       unsigned int touches) {
+	input_event_post_touch_at(id, time_current(), x, y, dx, dy, velocity, touch, touches);
+}
+
+void
+input_event_post_acceleration(input_event_id id, real x, real y, real z) {
+	input_event_post_acceleration_at(id, time_current(), x, y, z);
+}
+
+void
+input_event_post_key_at(input_event_id id, tick_t timestamp, unsigned int key, unsigned int scancode,
+                        unsigned int flags) {
 	input_event_payload_t payload;
 	payload.key.key = key;
 	payload.key.scancode = scancode;
 	payload.key.flags = flags;
-	event_post(input_event_stream_current, (int)id, 0, 0, &payload, sizeof(payload));
+	input_event_post_payload(id, timestamp, &payload, sizeof(payload));
 }
 
 void
-input_event_post_mouse(input_event_id id, int x, int y, real dx, real dy, real dz, unsigned int button,
-                       unsigned int buttons) {
+input_event_post_mouse_at(input_event_id id, tick_t timestamp, int x, int y, real dx, real dy, real dz,
+                          unsigned int button, unsigned int buttons) {
 	input_event_payload_t payload;
 	payload.mouse.x = x;
 	payload.mouse.y = y;
@@ -63,12 +631,12 @@ input_event_post_mouse(input_event_id id, int x, int y, real dx, real dy, real d
 	payload.mouse.dz = dz;
 	payload.mouse.button = button;
 	payload.mouse.buttons = buttons;
-	event_post(input_event_stream_current, (int)id, 0, 0, &payload, sizeof(payload));
+	input_event_post_payload(id, timestamp, &payload, sizeof(payload));
 }
 
 void
-input_event_post_touch(input_event_id id, int x, int y, real dx, real dy, real velocity, unsigned int touch,
-                       unsigned int touches) {
+input_event_post_touch_at(input_event_id id, tick_t timestamp, int x, int y, real dx, real dy, real velocity,
+                          unsigned int touch, unsigned int touches) {
 	input_event_payload_t payload;
 	payload.touch.x = x;
 	payload.touch.y = y;
@@ -77,14 +645,97 @@ input_event_post_touch(input_event_id id, int x, int y, real dx, real dy, real v
 	payload.touch.velocity = velocity;
 	payload.touch.touch = touch;
 	payload.touch.touches = touches;
-	event_post(input_event_stream_current, (int)id, 0, 0, &payload, sizeof(payload));
+	input_event_post_payload(id, timestamp, &payload, sizeof(payload));
 }
 
 void
-input_event_post_acceleration(input_event_id id, real x, real y, real z) {
+input_event_post_acceleration_at(input_event_id id, tick_t timestamp, real x, real y, real z) {
 	input_event_payload_t payload;
 	payload.acceleration.x = x;
 	payload.acceleration.y = y;
 	payload.acceleration.z = z;
-	event_post(input_event_stream_current, (int)id, 0, 0, &payload, sizeof(payload));
+	input_event_post_payload(id, timestamp, &payload, sizeof(payload));
+}
+
+void
+input_event_post_text(const char* text, size_t length) {
+	input_event_post_text_at(time_current(), text, length);
+}
+
+void
+input_event_post_text_at(tick_t timestamp, const char* text, size_t length) {
+	if (input_event_text_runs) {
+		// Runs end before a lead byte so no code point is split across events
+		input_event_payload_t payload;
+		size_t offset = 0;
+		while (offset < length) {
+			size_t run = length - offset;
+			if (run > INPUT_TEXT_MAX) {
+				run = INPUT_TEXT_MAX;
+				while ((run > 1) && ((text[offset + run] & 0xC0) == 0x80))
+					--run;
+			}
+			payload.text.length = (unsigned int)run;
+			memcpy(payload.text.text, text + offset, run);
+			input_event_post_payload(INPUTEVENT_TEXT, timestamp, &payload, sizeof(payload.text.length) + run);
+			offset += run;
+		}
+		return;
+	}
+
+	input_key_event_t chars[INPUT_EVENT_CHAR_BATCH];
+	size_t count = 0;
+	size_t offset = 0;
+	while (offset < length) {
+		size_t consumed = 0;
+		chars[count].key = string_glyph(text, length, offset, &consumed);
+		chars[count].scancode = 0;
+		chars[count].flags = 0;
+		offset += consumed ? consumed : 1;
+		if (++count == INPUT_EVENT_CHAR_BATCH) {
+			input_event_post_payload_batch(INPUTEVENT_CHAR, timestamp, chars, sizeof(input_key_event_t), count);
+			count = 0;
+		}
+	}
+	if (count)
+		input_event_post_payload_batch(INPUTEVENT_CHAR, timestamp, chars, sizeof(input_key_event_t), count);
+}
+
+void
+input_event_post_key_batch(input_event_id id, const input_key_event_t* key, size_t count) {
+	input_event_post_payload_batch(id, time_current(), key, sizeof(input_key_event_t), count);
+}
+
+void
+input_event_post_mouse_batch(input_event_id id, const input_mouse_event_t* mouse, size_t count) {
+	input_event_post_payload_batch(id, time_current(), mouse, sizeof(input_mouse_event_t), count);
+}
+
+void
+input_event_post_touch_batch(input_event_id id, const input_touch_event_t* touch, size_t count) {
+	input_event_post_payload_batch(id, time_current(), touch, sizeof(input_touch_event_t), count);
+}
+
+void
+input_event_post_acceleration_batch(input_event_id id, const input_acceleration_event_t* acceleration,
+                                    size_t count) {
+	input_event_post_payload_batch(id, time_current(), acceleration, sizeof(input_acceleration_event_t), count);
+}
+
+size_t
+input_event_queue_depth(void) {
+	return input_ring_size(input_event_ring);
+}
+
+input_queue_statistics_t
+input_event_queue_statistics(void) {
+	input_queue_statistics_t statistics;
+	input_event_lock();
+	statistics.capacity = input_ring_capacity(input_event_ring);
+	statistics.high_water = input_event_high_water;
+	statistics.dropped = (uint64_t)atomic_load64(&input_event_dropped, memory_order_acquire);
+	statistics.coalesced = input_event_coalesced;
+	statistics.overflowed = input_event_overflowed;
+	input_event_unlock();
+	return statistics;
 }
@@ -16,7 +16,15 @@
 #pragma once
 
 /*! \file event.h
-    Input events */
+    Input events. The timestamp of an input event is the time the event was generated, in
+    ticks of the foundation time clock. Platform backends convert the timestamp of the
+    native event from its source clock, events posted without a timestamp are stamped with
+    the current time when posted.
+
+    Posting writes the event to a bounded ring and is lock-free but not wait-free. Events
+    are published to the event stream or broadcast ring, and the input state, actions,
+    sequences and other derived state are updated, when the ring is drained by
+    input_event_process or input_event_stream on the consuming thread. */
 
 #include <input/types.h>
 
@@ -37,12 +45,125 @@ input_event_post_touch(input_event_id id, int x, int y, real dx, real dy, real v
 INPUT_API void
 input_event_post_acceleration(input_event_id id, real x, real y, real z);
 
+/*! Post a key event with a timestamp. The timestamp must not be later than the current time
+\param id Event id
+\param timestamp Time the event was generated, in ticks
+\param key Key
+\param scancode Scancode
+\param flags Flags */
+INPUT_API void
+input_event_post_key_at(input_event_id id, tick_t timestamp, unsigned int key, unsigned int scancode,
+                        unsigned int flags);
+
+/*! Post a mouse event with a timestamp. The timestamp must not be later than the current time
+\param id Event id
+\param timestamp Time the event was generated, in ticks
+\param x Position x coordinate
+\param y Position y coordinate
+\param dx Delta x
+\param dy Delta y
+\param dz Delta wheel
+\param button Button
+\param buttons Buttons currently held */
+INPUT_API void
+input_event_post_mouse_at(input_event_id id, tick_t timestamp, int x, int y, real dx, real dy, real dz,
+                          unsigned int button, unsigned int buttons);
+
+/*! Post a touch event with a timestamp. The timestamp must not be later than the current time
+\param id Event id
+\param timestamp Time the event was generated, in ticks
+\param x Position x coordinate
+\param y Position y coordinate
+\param dx Delta x
+\param dy Delta y
+\param velocity Velocity
+\param touch Touch index
+\param touches Touches currently active */
+INPUT_API void
+input_event_post_touch_at(input_event_id id, tick_t timestamp, int x, int y, real dx, real dy, real velocity,
+                          unsigned int touch, unsigned int touches);
+
+/*! Post an acceleration event with a timestamp. The timestamp must not be later than the
+current time
+\param id Event id
+\param timestamp Time the event was generated, in ticks
+\param x Acceleration x component
+\param y Acceleration y component
+\param z Acceleration z component */
+INPUT_API void
+input_event_post_acceleration_at(input_event_id id, tick_t timestamp, real x, real y, real z);
+
+/*! Post text input. With event_text_runs in the input configuration the text is posted as
+INPUTEVENT_TEXT events of up to INPUT_TEXT_MAX bytes, otherwise as one INPUTEVENT_CHAR event per
+code point with the code point as key. Nothing is allocated when posting
+\param text UTF-8 text
+\param length Length of text in bytes */
+INPUT_API void
+input_event_post_text(const char* text, size_t length);
+
+/*! Post text input with a timestamp, see input_event_post_text. The timestamp must not be
+later than the current time
+\param timestamp Time the text was entered, in ticks
+\param text UTF-8 text
+\param length Length of text in bytes */
+INPUT_API void
+input_event_post_text_at(tick_t timestamp, const char* text, size_t length);
+
+/*! Post a batch of key events with the same event id. Ring slots for the batch are claimed
+in runs rather than one at a time.
+\param id Event id
+\param key Key event payloads
+\param count Number of events */
+INPUT_API void
+input_event_post_key_batch(input_event_id id, const input_key_event_t* key, size_t count);
+
+/*! Post a batch of mouse events with the same event id
+\param id Event id
+\param mouse Mouse event payloads
+\param count Number of events */
+INPUT_API void
+input_event_post_mouse_batch(input_event_id id, const input_mouse_event_t* mouse, size_t count);
+
+/*! Post a batch of touch events with the same event id
+\param id Event id
+\param touch Touch event payloads
+\param count Number of events */
+INPUT_API void
+input_event_post_touch_batch(input_event_id id, const input_touch_event_t* touch, size_t count);
+
+/*! Post a batch of acceleration events with the same event id
+\param id Event id
+\param acceleration Acceleration event payloads
+\param count Number of events */
+INPUT_API void
+input_event_post_acceleration_batch(input_event_id id, const input_acceleration_event_t* acceleration,
+                                    size_t count);
+
+/*! Process native input events, move posted events to the event stream and take a new
+input state snapshot, see state.h */
 INPUT_API void
 input_event_process(void);
 
+/*! Get the input event stream. Events posted to the lock-free event ring are moved to the
+stream before it is returned. If the broadcast ring is
+enabled, events are read through consumers instead and the stream remains empty.
+\return Input event stream */
 INPUT_API event_stream_t*
 input_event_stream(void);
 
+/*! Get the event queue counters, accumulated since the input module was initialized
+\return Queue statistics */
+INPUT_API input_queue_statistics_t
+input_event_queue_statistics(void);
+
+/*! Decode the payload of an input event read from the input event stream into the full
+payload representation, in either the default or the compact encoding
+\param event Input event
+\param payload Payload to fill
+\return true if event carried a payload, false if not */
+INPUT_API bool
+input_event_decode(const event_t* event, input_event_payload_t* payload);
+
 /*! Handle window events. No other event types should be
 passed to this function.
 \param event Window event */
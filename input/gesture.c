@@ -0,0 +1,243 @@
+/* gesture.c  -  Input gestures  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/math.h>
+#include <foundation/time.h>
+
+/* Gestures are recognized incrementally from touch events as they are published, with the
+   event lock held. Each touch sample only updates the state of its own touch and, while two
+   touches are active, the distance and angle of the pair, so the work per sample is
+   constant. A gesture starts when the first touch begins and ends when the last touch ends.
+   A gesture that ever had more than one touch is never a tap, long press or swipe. */
+
+typedef struct input_gesture_touch_t input_gesture_touch_t;
+
+struct input_gesture_touch_t {
+	int begin_x;
+	int begin_y;
+	int x;
+	int y;
+	tick_t begin;
+	bool moved;
+};
+
+static input_gesture_touch_t input_gesture_touch[INPUT_TOUCH_MAX];
+static unsigned int input_gesture_touches;
+static bool input_gesture_single;
+static bool input_gesture_longpressed;
+static unsigned int input_gesture_primary;
+static unsigned int input_gesture_pair[2];
+static bool input_gesture_paired;
+static real input_gesture_pair_distance;
+static real input_gesture_pair_angle;
+static bool input_gesture_pinching;
+static bool input_gesture_rotating;
+static bool input_gesture_tapped;
+static tick_t input_gesture_tap_time;
+static int input_gesture_tap_x;
+static int input_gesture_tap_y;
+
+void
+input_gesture_initialize(void) {
+	memset(input_gesture_touch, 0, sizeof(input_gesture_touch));
+	input_gesture_touches = 0;
+	input_gesture_single = false;
+	input_gesture_paired = false;
+	input_gesture_tapped = false;
+}
+
+static tick_t
+input_gesture_ms(unsigned int ms) {
+	return ((tick_t)ms * time_ticks_per_second()) / 1000;
+}
+
+static void
+input_gesture_post(unsigned int id, tick_t timestamp, int x, int y, real dx, real dy, real value) {
+	input_event_payload_t payload;
+	payload.gesture.x = x;
+	payload.gesture.y = y;
+	payload.gesture.dx = dx;
+	payload.gesture.dy = dy;
+	payload.gesture.value = value;
+	payload.gesture.touches = input_gesture_touches;
+	input_event_publish(id, timestamp, &payload, sizeof(input_gesture_event_t));
+}
+
+static unsigned int
+input_gesture_count(unsigned int touches) {
+	unsigned int count = 0;
+	for (; touches; touches &= touches - 1)
+		++count;
+	return count;
+}
+
+static void
+input_gesture_pair_measure(real* distance, real* angle) {
+	const input_gesture_touch_t* first = input_gesture_touch + input_gesture_pair[0];
+	const input_gesture_touch_t* second = input_gesture_touch + input_gesture_pair[1];
+	real dx = (real)(second->x - first->x);
+	real dy = (real)(second->y - first->y);
+	*distance = math_sqrt((dx * dx) + (dy * dy));
+	*angle = math_atan2(dy, dx);
+}
+
+static void
+input_gesture_pair_begin(void) {
+	unsigned int ipair = 0;
+	for (unsigned int itouch = 0; (itouch < INPUT_TOUCH_MAX) && (ipair < 2); ++itouch) {
+		if (input_gesture_touches & (1U << itouch))
+			input_gesture_pair[ipair++] = itouch;
+	}
+	input_gesture_pair_measure(&input_gesture_pair_distance, &input_gesture_pair_angle);
+	input_gesture_paired = (input_gesture_pair_distance > REAL_ONE);
+	input_gesture_pinching = false;
+	input_gesture_rotating = false;
+}
+
+static void
+input_gesture_pair_move(tick_t timestamp) {
+	real distance, angle;
+	input_gesture_pair_measure(&distance, &angle);
+	real scale = distance / input_gesture_pair_distance;
+	real rotation = angle - input_gesture_pair_angle;
+	if (rotation > REAL_PI)
+		rotation -= REAL_TWOPI;
+	else if (rotation < -REAL_PI)
+		rotation += REAL_TWOPI;
+
+	const input_gesture_touch_t* first = input_gesture_touch + input_gesture_pair[0];
+	const input_gesture_touch_t* second = input_gesture_touch + input_gesture_pair[1];
+	int x = (first->x + second->x) / 2;
+	int y = (first->y + second->y) / 2;
+	if (!input_gesture_pinching && (math_abs(scale - REAL_ONE) > INPUT_GESTURE_PINCH_THRESHOLD))
+		input_gesture_pinching = true;
+	if (input_gesture_pinching)
+		input_gesture_post(INPUTEVENT_GESTUREPINCH, timestamp, x, y, 0, 0, scale);
+	if (!input_gesture_rotating && (math_abs(rotation) > INPUT_GESTURE_ROTATE_THRESHOLD))
+		input_gesture_rotating = true;
+	if (input_gesture_rotating)
+		input_gesture_post(INPUTEVENT_GESTUREROTATE, timestamp, x, y, 0, 0, rotation);
+}
+
+static void
+input_gesture_end(unsigned int touch, tick_t timestamp, bool cancel) {
+	const input_gesture_touch_t* state = input_gesture_touch + touch;
+	if (!input_gesture_single || cancel || input_gesture_longpressed || (touch != input_gesture_primary))
+		return;
+
+	tick_t duration = timestamp - state->begin;
+	if (!state->moved) {
+		if (duration > input_gesture_ms(INPUT_GESTURE_TAP_MS))
+			return;
+		input_gesture_post(INPUTEVENT_GESTURETAP, timestamp, state->x, state->y, 0, 0, 0);
+		int tap_dx = state->x - input_gesture_tap_x;
+		int tap_dy = state->y - input_gesture_tap_y;
+		int tap_slop = INPUT_GESTURE_DOUBLETAP_SLOP * INPUT_GESTURE_DOUBLETAP_SLOP;
+		bool close = ((tap_dx * tap_dx) + (tap_dy * tap_dy)) <= tap_slop;
+		if (input_gesture_tapped && close &&
+		    (timestamp - input_gesture_tap_time <= input_gesture_ms(INPUT_GESTURE_DOUBLETAP_MS))) {
+			input_gesture_post(INPUTEVENT_GESTUREDOUBLETAP, timestamp, state->x, state->y, 0, 0, 0);
+			input_gesture_tapped = false;
+		} else {
+			input_gesture_tapped = true;
+			input_gesture_tap_time = timestamp;
+			input_gesture_tap_x = state->x;
+			input_gesture_tap_y = state->y;
+		}
+		return;
+	}
+
+	real dx = (real)(state->x - state->begin_x);
+	real dy = (real)(state->y - state->begin_y);
+	real distance = math_sqrt((dx * dx) + (dy * dy));
+	// Samples posted in the same tick still get a finite velocity
+	real seconds = (real)duration / (real)time_ticks_per_second();
+	if (seconds < REAL_C(0.001))
+		seconds = REAL_C(0.001);
+	real velocity = distance / seconds;
+	if ((distance >= (real)INPUT_GESTURE_SWIPE_DISTANCE) && (velocity >= (real)INPUT_GESTURE_SWIPE_VELOCITY))
+		input_gesture_post(INPUTEVENT_GESTURESWIPE, timestamp, state->x, state->y, dx, dy, velocity);
+}
+
+void
+input_gesture_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload) {
+	if ((id < INPUTEVENT_TOUCHBEGIN) || (id > INPUTEVENT_TOUCHMOVE) || (id == INPUTEVENT_TOUCHSWIPE))
+		return;
+	unsigned int touch = payload->touch.touch;
+	if (touch >= INPUT_TOUCH_MAX)
+		return;
+	input_gesture_touch_t* state = input_gesture_touch + touch;
+	unsigned int bit = 1U << touch;
+
+	if (id == INPUTEVENT_TOUCHBEGIN) {
+		state->begin_x = state->x = payload->touch.x;
+		state->begin_y = state->y = payload->touch.y;
+		state->begin = timestamp;
+		state->moved = false;
+		if (!input_gesture_touches) {
+			input_gesture_single = true;
+			input_gesture_longpressed = false;
+			input_gesture_primary = touch;
+		} else {
+			input_gesture_single = false;
+		}
+		input_gesture_touches |= bit;
+		input_gesture_paired = false;
+		if (input_gesture_count(input_gesture_touches) == 2)
+			input_gesture_pair_begin();
+		return;
+	}
+
+	if (!(input_gesture_touches & bit))
+		return;
+	state->x = payload->touch.x;
+	state->y = payload->touch.y;
+	if (!state->moved) {
+		int dx = state->x - state->begin_x;
+		int dy = state->y - state->begin_y;
+		state->moved = ((dx * dx) + (dy * dy)) > (INPUT_GESTURE_SLOP * INPUT_GESTURE_SLOP);
+	}
+
+	if (id == INPUTEVENT_TOUCHMOVE) {
+		if (input_gesture_paired && ((touch == input_gesture_pair[0]) || (touch == input_gesture_pair[1])))
+			input_gesture_pair_move(timestamp);
+		else
+			input_gesture_update(timestamp);
+		return;
+	}
+
+	input_gesture_end(touch, timestamp, id == INPUTEVENT_TOUCHCANCEL);
+	input_gesture_touches &= ~bit;
+	input_gesture_paired = false;
+	if (input_gesture_count(input_gesture_touches) == 2)
+		input_gesture_pair_begin();
+}
+
+void
+input_gesture_update(tick_t timestamp) {
+	if (!input_gesture_single || input_gesture_longpressed || !input_gesture_touches)
+		return;
+	const input_gesture_touch_t* state = input_gesture_touch + input_gesture_primary;
+	tick_t duration = timestamp - state->begin;
+	if (state->moved || (duration < input_gesture_ms(INPUT_GESTURE_LONGPRESS_MS)))
+		return;
+	input_gesture_longpressed = true;
+	input_gesture_post(INPUTEVENT_GESTURELONGPRESS, timestamp, state->x, state->y, 0, 0,
+	                   (real)duration / (real)time_ticks_per_second());
+}
@@ -0,0 +1,60 @@
+/* gesture.h  -  Input gestures  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file gesture.h
+    Touch gestures. When enabled with input_config_t.event_gestures, gestures are recognized
+    incrementally from touch events on all platforms and posted as gesture events with an
+    input_gesture_event_t payload, directly after the touch event completing the gesture.
+
+    A single touch released within INPUT_GESTURE_TAP_MS without moving more than
+    INPUT_GESTURE_SLOP pixels is a tap, and a second tap close to the first within
+    INPUT_GESTURE_DOUBLETAP_MS is also a double tap. A single touch held still for
+    INPUT_GESTURE_LONGPRESS_MS is a long press, reported once, at the latest on the next
+    call to input_event_process. A single touch released after moving at least
+    INPUT_GESTURE_SWIPE_DISTANCE pixels at a speed of at least INPUT_GESTURE_SWIPE_VELOCITY
+    pixels per second is a swipe. While exactly two touches are active, pinch and rotate
+    events are posted for every move once the scale or angle has changed by more than the
+    respective threshold. */
+
+#include <input/types.h>
+
+/*! Maximum movement in pixels of a tap or long press */
+#define INPUT_GESTURE_SLOP 10
+
+/*! Maximum duration in milliseconds of a tap */
+#define INPUT_GESTURE_TAP_MS 300
+
+/*! Maximum time in milliseconds between two taps of a double tap */
+#define INPUT_GESTURE_DOUBLETAP_MS 300
+
+/*! Maximum distance in pixels between two taps of a double tap */
+#define INPUT_GESTURE_DOUBLETAP_SLOP 40
+
+/*! Minimum duration in milliseconds of a long press */
+#define INPUT_GESTURE_LONGPRESS_MS 500
+
+/*! Minimum distance in pixels of a swipe */
+#define INPUT_GESTURE_SWIPE_DISTANCE 50
+
+/*! Minimum velocity in pixels per second of a swipe */
+#define INPUT_GESTURE_SWIPE_VELOCITY 200
+
+/*! Minimum relative change in touch distance before pinch events are posted */
+#define INPUT_GESTURE_PINCH_THRESHOLD REAL_C(0.1)
+
+/*! Minimum change in touch angle in radians before rotate events are posted */
+#define INPUT_GESTURE_ROTATE_THRESHOLD REAL_C(0.15)
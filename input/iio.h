@@ -0,0 +1,47 @@
+/* iio.h  -  Linux IIO sensor input  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file iio.h
+    Linux Industrial I/O sensors. Accelerometer and gyroscope channels of IIO devices are
+    enabled through the scan elements in sysfs, and samples are read from the buffered
+    character device of each device in each call to input_event_process. A read returns
+    many samples, which are decoded one channel at a time over the whole batch, then posted
+    as INPUTEVENT_ACCELERATION in m/s^2 and INPUTEVENT_ROTATION in rad/s. Samples carry the
+    timestamp of the device when it has a timestamp channel on the monotonic clock, and the
+    time of the read otherwise. On platforms other than Linux the functions are available
+    but no devices are found. */
+
+#include <input/types.h>
+
+/*! Scan for IIO sensors and open the accelerometers and gyroscopes found. Each directory
+iio:deviceN in the sysfs directory is a device, read from the character device of the same
+name in the device directory. Devices are scanned in /sys/bus/iio/devices and /dev when
+sensors are enabled in the input configuration, other directories can be given to open
+devices from a different tree. Must be called on the thread calling input_event_process
+\param sysfs Directory of IIO device attributes
+\param sysfs_length Length of sysfs directory
+\param devfs Directory of IIO character devices
+\param devfs_length Length of devfs directory
+\return Number of devices opened */
+INPUT_API size_t
+input_iio_scan(const char* sysfs, size_t sysfs_length, const char* devfs, size_t devfs_length);
+
+/*! Get the number of open IIO devices. A device is closed when reading it fails or reaches
+end of file, and when the input module is finalized
+\return Number of devices */
+INPUT_API size_t
+input_iio_device_count(void);
@@ -18,14 +18,31 @@
 
 int
 input_module_initialize(const input_config_t config) {
-	FOUNDATION_UNUSED(config);
+	input_clock_initialize();
 	if (input_module_initialize_native())
 		return -1;
-	return input_event_initialize();
+	if (input_action_initialize(config))
+		return -1;
+	input_sequence_initialize();
+	input_record_initialize(config);
+	input_statistics_initialize();
+	input_pad_initialize();
+	input_velocity_initialize();
+	input_condition_initialize();
+	if (input_event_initialize(config))
+		return -1;
+	if (input_evdev_initialize(config))
+		return -1;
+	return input_iio_initialize(config);
 }
 
 void
 input_module_finalize(void) {
+	input_record_finalize();
+	input_iio_finalize();
+	input_evdev_finalize();
 	input_event_finalize();
+	input_sequence_finalize();
+	input_action_finalize();
 	input_module_finalize_native();
 }
@@ -20,6 +20,20 @@
 
 #include <input/types.h>
 #include <input/event.h>
+#include <input/consumer.h>
+#include <input/state.h>
+#include <input/action.h>
+#include <input/sequence.h>
+#include <input/gesture.h>
+#include <input/record.h>
+#include <input/loadgen.h>
+#include <input/statistics.h>
+#include <input/evdev.h>
+#include <input/iio.h>
+#include <input/xinput.h>
+#include <input/pad.h>
+#include <input/velocity.h>
+#include <input/condition.h>
 #include <input/hashstrings.h>
 
 INPUT_API int
@@ -14,6 +14,7 @@
  */
 
 #include <input/input.h>
+#include <input/internal.h>
 
 #if FOUNDATION_PLATFORM_ANDROID
 
@@ -226,7 +227,7 @@ android_handle_input(struct android_app* app, AInputEvent* event) {
 	static int begin_x[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
 	static int begin_y[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
 
-	static time_t begin_time[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	static tick_t begin_time[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 
 	static uint32_t current_fingers = 0;
 
@@ -234,6 +235,7 @@ android_handle_input(struct android_app* app, AInputEvent* event) {
 		int32_t action = AMotionEvent_getAction(event);
 		int32_t flags = AMotionEvent_getMetaState(event);
 		size_t pointers = AMotionEvent_getPointerCount(event);
+		tick_t timestamp = input_clock_from_monotonic(AMotionEvent_getEventTime(event), time_current());
 
 		// debug_logf( "Motion event: action=%d flags=0x%x pointers=%d", action, flags, pointers );
 		for (size_t pointer = 0; pointer < pointers; ++pointer) {
@@ -283,7 +285,7 @@ android_handle_input(struct android_app* app, AInputEvent* event) {
 				last_x[finger] = x;
 				last_y[finger] = y;
 
-				begin_time[finger] = time_current();
+				begin_time[finger] = timestamp;
 			}
 
 			dx = x - last_x[finger];
@@ -293,7 +295,7 @@ android_handle_input(struct android_app* app, AInputEvent* event) {
 			real dy_begin = y - begin_y[finger];
 
 			real velocity = 0;
-			real t = time_elapsed(begin_time[finger]);
+			real t = (real)time_ticks_to_seconds(time_diff(begin_time[finger], timestamp));
 			if (t > 0)
 				velocity = neo_sqrt(dx_begin * dx_begin + dy_begin * dy_begin) / t;
 
@@ -301,18 +303,19 @@ android_handle_input(struct android_app* app, AInputEvent* event) {
 			last_y[finger] = y;
 
 			if (id == INPUTEVENT_TOUCHCANCEL)
-				dx = dy = t = velocity = 0;
+				dx = dy = velocity = 0;
 
 			if (id == INPUTEVENT_TOUCHEND) {
 				dx = dx_begin;
 				dy = dy_begin;
 			}
 
-			input_event_post_touch(id, x, y, dx, dy, (id == INPUTEVENT_TOUCHEND) ? t : velocity, finger,
-			                       current_fingers);
+			// Touch velocity is estimated by the velocity tracker when the event is published, the
+			// swipe carries the average velocity over the whole touch
+			input_event_post_touch_at(id, timestamp, x, y, dx, dy, 0, finger, current_fingers);
 
 			if (id == INPUTEVENT_TOUCHEND)
-				input_event_post_touch(INPUTEVENT_TOUCHSWIPE, x, y, dx, dy, velocity, 0, 0);
+				input_event_post_touch_at(INPUTEVENT_TOUCHSWIPE, timestamp, x, y, dx, dy, velocity, 0, 0);
 		}
 
 		return 1;
@@ -327,19 +330,20 @@ android_handle_input(struct android_app* app, AInputEvent* event) {
 		int32_t scancode = AKeyEvent_getScanCode(event);
 		int32_t flags = AKeyEvent_getFlags(event);
 		int32_t source = AInputEvent_getSource(event);
+		tick_t timestamp = input_clock_from_monotonic(event_time, time_current());
 
 		info_logf("Key event: action=%d keycode=%d metastate=0x%x flags=%x", action, keycode, metastate, flags);
 
 		if (keycode < TRANSLATED_KEYS_COUNT) {
-			input_event_post_key((action == AKEY_EVENT_ACTION_DOWN) ? INPUTEVENT_KEYDOWN : INPUTEVENT_KEYUP,
-			                     key_translator[keycode], keycode);
+			input_event_post_key_at((action == AKEY_EVENT_ACTION_DOWN) ? INPUTEVENT_KEYDOWN : INPUTEVENT_KEYUP,
+			                        timestamp, key_translator[keycode], keycode, 0);
 
 			if (action == AKEY_EVENT_ACTION_UP) {
 				uint16_t unicode_char = _keyevent_to_unicode(down_time, event_time, action, keycode, repeat, metastate,
 				                                             device_id, scancode, flags, source);
 				if (unicode_char) {
 					// info_logf( "Input unicode char: %d", (int)unicode_char );
-					input_event_post_key(INPUTEVENT_CHAR, unicode_char, keycode);
+					input_event_post_key_at(INPUTEVENT_CHAR, timestamp, unicode_char, keycode, 0);
 				}
 			}
 		}
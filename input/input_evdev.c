@@ -0,0 +1,852 @@
+/* input_evdev.c  -  Input library Linux evdev implementation  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#if FOUNDATION_PLATFORM_LINUX
+
+#include <foundation/memory.h>
+#include <foundation/time.h>
+#include <foundation/log.h>
+#include <foundation/posix.h>
+#include <foundation/mutex.h>
+#include <foundation/thread.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Events of a frame are collected until the SYN_REPORT closing it. Motion is summed and posted
+   as one move ahead of the button and key transitions, so transitions carry the position at
+   the end of the frame. After a SYN_DROPPED the kernel buffer overflowed and events are
+   discarded up to the next SYN_REPORT, after which key state is queried from the device and
+   the transitions that were lost are posted. linux/input.h is not included since its key code
+   macros collide with the key enumeration, the parts of the kernel ABI used are defined here.
+
+   Gamepads and joysticks keep their button mask and absolute axis values in the device. At
+   each SYN_REPORT that changed anything the complete pad state is normalized and handed to
+   the pad module, which posts events only for button transitions.
+
+   With the input thread enabled the thread blocks in epoll_wait on the devices and an eventfd
+   signalled at shutdown, and input_evdev_process does nothing. Devices are read and detached
+   with the device lock held, attaching from other threads takes the same lock. */
+
+#define INPUT_EVDEV_DEVICE_MAX 32
+#define INPUT_EVDEV_READ_BATCH 64
+#define INPUT_EVDEV_FRAME_MAX 32
+#define INPUT_EVDEV_ABS_MAX 0x12
+
+#define EVDEV_EV_SYN 0x00
+#define EVDEV_EV_KEY 0x01
+#define EVDEV_EV_REL 0x02
+#define EVDEV_EV_ABS 0x03
+#define EVDEV_SYN_REPORT 0
+#define EVDEV_SYN_DROPPED 3
+#define EVDEV_REL_X 0x00
+#define EVDEV_REL_Y 0x01
+#define EVDEV_REL_WHEEL 0x08
+#define EVDEV_ABS_X 0x00
+#define EVDEV_ABS_Y 0x01
+#define EVDEV_ABS_HAT0X 0x10
+#define EVDEV_ABS_HAT0Y 0x11
+#define EVDEV_KEY_ENTER 28
+#define EVDEV_KEY_A 30
+#define EVDEV_BTN_LEFT 0x110
+#define EVDEV_BTN_TASK 0x117
+#define EVDEV_BTN_JOYSTICK 0x120
+#define EVDEV_BTN_SOUTH 0x130
+#define EVDEV_KEY_MAX 0x2ff
+
+#define EVDEV_IOCGKEY(len) _IOC(_IOC_READ, 'E', 0x18, len)
+#define EVDEV_IOCGBIT(ev, len) _IOC(_IOC_READ, 'E', 0x20 + (ev), len)
+#define EVDEV_IOCGABS(abs) _IOC(_IOC_READ, 'E', 0x40 + (abs), sizeof(input_evdev_absinfo_t))
+#define EVDEV_IOCSCLOCKID _IOW('E', 0xa0, int)
+
+typedef struct input_evdev_event_t input_evdev_event_t;
+typedef struct input_evdev_absinfo_t input_evdev_absinfo_t;
+typedef struct input_evdev_device_t input_evdev_device_t;
+
+// Layout of struct input_event
+struct input_evdev_event_t {
+	struct timeval time;
+	uint16_t type;
+	uint16_t code;
+	int32_t value;
+};
+
+// Layout of struct input_absinfo
+struct input_evdev_absinfo_t {
+	int32_t value;
+	int32_t minimum;
+	int32_t maximum;
+	int32_t fuzz;
+	int32_t flat;
+	int32_t resolution;
+};
+
+struct input_evdev_device_t {
+	int fd;
+	bool monotonic;
+	bool dropped;
+	int pad;
+	bool pad_changed;
+	unsigned int pad_buttons;
+	int32_t abs_value[INPUT_EVDEV_ABS_MAX];
+	int32_t abs_minimum[INPUT_EVDEV_ABS_MAX];
+	int32_t abs_maximum[INPUT_EVDEV_ABS_MAX];
+	int dx;
+	int dy;
+	int dz;
+	int x;
+	int y;
+	unsigned int absolute;
+	size_t changes;
+	uint16_t change_code[INPUT_EVDEV_FRAME_MAX];
+	bool change_down[INPUT_EVDEV_FRAME_MAX];
+	uint8_t keys[(EVDEV_KEY_MAX + 8) / 8];
+	size_t fill;
+	input_evdev_event_t buffer[INPUT_EVDEV_READ_BATCH];
+};
+
+static const uint32_t input_evdev_keys[256] = {
+    [1] = KEY_ESCAPE,         [2] = KEY_1,
+    [3] = KEY_2,              [4] = KEY_3,
+    [5] = KEY_4,              [6] = KEY_5,
+    [7] = KEY_6,              [8] = KEY_7,
+    [9] = KEY_8,              [10] = KEY_9,
+    [11] = KEY_0,             [12] = KEY_MINUS,
+    [13] = KEY_EQUAL,         [14] = KEY_BACKSPACE,
+    [15] = KEY_TAB,           [16] = KEY_Q,
+    [17] = KEY_W,             [18] = KEY_E,
+    [19] = KEY_R,             [20] = KEY_T,
+    [21] = KEY_Y,             [22] = KEY_U,
+    [23] = KEY_I,             [24] = KEY_O,
+    [25] = KEY_P,             [26] = KEY_LEFTBRACKET,
+    [27] = KEY_RIGHTBRACKET,  [28] = KEY_RETURN,
+    [29] = KEY_LCTRL,         [30] = KEY_A,
+    [31] = KEY_S,             [32] = KEY_D,
+    [33] = KEY_F,             [34] = KEY_G,
+    [35] = KEY_H,             [36] = KEY_J,
+    [37] = KEY_K,             [38] = KEY_L,
+    [39] = KEY_SEMICOLON,     [40] = KEY_APOSTROPHE,
+    [41] = KEY_GRAVEACCENT,   [42] = KEY_LSHIFT,
+    [43] = KEY_BACKSLASH,     [44] = KEY_Z,
+    [45] = KEY_X,             [46] = KEY_C,
+    [47] = KEY_V,             [48] = KEY_B,
+    [49] = KEY_N,             [50] = KEY_M,
+    [51] = KEY_COMMA,         [52] = KEY_PERIOD,
+    [53] = KEY_SLASH,         [54] = KEY_RSHIFT,
+    [55] = KEY_NP_MULTIPLY,   [56] = KEY_LALT,
+    [57] = KEY_SPACE,         [58] = KEY_CAPSLOCK,
+    [59] = KEY_F1,            [60] = KEY_F2,
+    [61] = KEY_F3,            [62] = KEY_F4,
+    [63] = KEY_F5,            [64] = KEY_F6,
+    [65] = KEY_F7,            [66] = KEY_F8,
+    [67] = KEY_F9,            [68] = KEY_F10,
+    [69] = KEY_NP_NUMLOCK,    [70] = KEY_SCROLLLOCK,
+    [71] = KEY_NP_7,          [72] = KEY_NP_8,
+    [73] = KEY_NP_9,          [74] = KEY_NP_MINUS,
+    [75] = KEY_NP_4,          [76] = KEY_NP_5,
+    [77] = KEY_NP_6,          [78] = KEY_NP_PLUS,
+    [79] = KEY_NP_1,          [80] = KEY_NP_2,
+    [81] = KEY_NP_3,          [82] = KEY_NP_0,
+    [83] = KEY_NP_DECIMAL,    [86] = KEY_LESS,
+    [87] = KEY_F11,           [88] = KEY_F12,
+    [96] = KEY_NP_ENTER,      [97] = KEY_RCTRL,
+    [98] = KEY_NP_DIVIDE,     [99] = KEY_PRINTSCREEN,
+    [100] = KEY_RALT,         [102] = KEY_HOME,
+    [103] = KEY_UP,           [104] = KEY_PAGEUP,
+    [105] = KEY_LEFT,         [106] = KEY_RIGHT,
+    [107] = KEY_END,          [108] = KEY_DOWN,
+    [109] = KEY_PAGEDOWN,     [110] = KEY_INSERT,
+    [111] = KEY_DELETE,       [117] = KEY_NP_EQUAL,
+    [119] = KEY_PAUSE,        [125] = KEY_LMETA,
+    [126] = KEY_RMETA,        [127] = KEY_MENU,
+    [183] = KEY_F13,          [184] = KEY_F14,
+    [185] = KEY_F15,          [186] = KEY_F16,
+    [187] = KEY_F17,          [188] = KEY_F18,
+    [189] = KEY_F19,          [190] = KEY_F20,
+    [191] = KEY_F21,          [192] = KEY_F22,
+    [193] = KEY_F23,          [194] = KEY_F24,
+};
+
+// Absolute axes of pads, offset by one so zero is unmapped. Some pads report the triggers as
+// brake and gas pedals
+static const uint8_t input_evdev_pad_axis[INPUT_EVDEV_ABS_MAX] = {
+    [0x00] = PADAXIS_LEFT_X + 1,        [0x01] = PADAXIS_LEFT_Y + 1,         [0x02] = PADAXIS_LEFT_TRIGGER + 1,
+    [0x03] = PADAXIS_RIGHT_X + 1,       [0x04] = PADAXIS_RIGHT_Y + 1,        [0x05] = PADAXIS_RIGHT_TRIGGER + 1,
+    [0x09] = PADAXIS_RIGHT_TRIGGER + 1, [0x0a] = PADAXIS_LEFT_TRIGGER + 1,
+};
+
+static int input_evdev_poll = -1;
+static int input_evdev_wakeup = -1;
+static mutex_t* input_evdev_lock;
+static thread_t input_evdev_thread;
+static bool input_evdev_threaded;
+static uint64_t input_evdev_affinity;
+static int input_evdev_priority;
+static input_evdev_device_t* input_evdev_devices[INPUT_EVDEV_DEVICE_MAX];
+static size_t input_evdev_count;
+static int input_evdev_x;
+static int input_evdev_y;
+static unsigned int input_evdev_buttons;
+static tick_t input_evdev_down_time[8];
+
+static bool
+input_evdev_bit(const uint8_t* bits, unsigned int bit) {
+	return (bits[bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+static void
+input_evdev_key(unsigned int code, bool down, tick_t timestamp) {
+	if (code < sizeof(input_evdev_keys) / sizeof(input_evdev_keys[0])) {
+		unsigned int key = input_evdev_keys[code];
+		input_event_post_key_at(down ? INPUTEVENT_KEYDOWN : INPUTEVENT_KEYUP, timestamp, key ? key : KEY_UNKNOWN,
+		                        code, 0);
+	} else if ((code >= EVDEV_BTN_LEFT) && (code <= EVDEV_BTN_TASK)) {
+		// Button codes from BTN_LEFT are in the same order as the mouse button bits
+		unsigned int index = code - EVDEV_BTN_LEFT;
+		unsigned int button = 1U << index;
+		if (down) {
+			input_evdev_buttons |= button;
+			input_evdev_down_time[index] = timestamp;
+			input_event_post_mouse_at(INPUTEVENT_MOUSEDOWN, timestamp, input_evdev_x, input_evdev_y, 0, 0, 0,
+			                          button, input_evdev_buttons);
+		} else {
+			real held = (real)time_ticks_to_seconds(time_diff(input_evdev_down_time[index], timestamp));
+			input_evdev_buttons &= ~button;
+			input_event_post_mouse_at(INPUTEVENT_MOUSEUP, timestamp, input_evdev_x, input_evdev_y, 0, 0, held,
+			                          button, input_evdev_buttons);
+		}
+	}
+}
+
+static void
+input_evdev_set_key(input_evdev_device_t* device, unsigned int code, bool down) {
+	if (down)
+		device->keys[code / 8] |= (uint8_t)(1 << (code % 8));
+	else
+		device->keys[code / 8] &= (uint8_t)~(1 << (code % 8));
+}
+
+static void
+input_evdev_resync(input_evdev_device_t* device, tick_t timestamp) {
+	uint8_t keys[sizeof(device->keys)];
+	memset(keys, 0, sizeof(keys));
+	if (ioctl(device->fd, EVDEV_IOCGKEY(sizeof(keys)), keys) < 0)
+		return;
+	for (unsigned int code = 0; code <= EVDEV_KEY_MAX; ++code) {
+		bool down = input_evdev_bit(keys, code);
+		if (down != input_evdev_bit(device->keys, code)) {
+			input_evdev_set_key(device, code, down);
+			input_evdev_key(code, down, timestamp);
+		}
+	}
+}
+
+static void
+input_evdev_flush(input_evdev_device_t* device, tick_t timestamp) {
+	if (device->dx || device->dy || device->dz || device->absolute) {
+		int x = (device->absolute & 1) ? device->x : input_evdev_x + device->dx;
+		int y = (device->absolute & 2) ? device->y : input_evdev_y + device->dy;
+		input_event_post_mouse_at(INPUTEVENT_MOUSEMOVE, timestamp, x, y, (real)(x - input_evdev_x),
+		                          (real)(y - input_evdev_y), (real)device->dz, 0, input_evdev_buttons);
+		input_evdev_x = x;
+		input_evdev_y = y;
+	}
+	for (size_t ichange = 0; ichange < device->changes; ++ichange) {
+		input_evdev_set_key(device, device->change_code[ichange], device->change_down[ichange]);
+		input_evdev_key(device->change_code[ichange], device->change_down[ichange], timestamp);
+	}
+	device->dx = device->dy = device->dz = 0;
+	device->absolute = 0;
+	device->changes = 0;
+}
+
+static unsigned int
+input_evdev_pad_button(unsigned int code) {
+	switch (code) {
+		case 0x130:
+			return PADBUTTON_SOUTH;
+		case 0x131:
+			return PADBUTTON_EAST;
+		case 0x133:
+			return PADBUTTON_NORTH;
+		case 0x134:
+			return PADBUTTON_WEST;
+		case 0x136:
+			return PADBUTTON_LSHOULDER;
+		case 0x137:
+			return PADBUTTON_RSHOULDER;
+		case 0x138:
+			return PADBUTTON_LTRIGGER;
+		case 0x139:
+			return PADBUTTON_RTRIGGER;
+		case 0x13a:
+			return PADBUTTON_BACK;
+		case 0x13b:
+			return PADBUTTON_START;
+		case 0x13c:
+			return PADBUTTON_GUIDE;
+		case 0x13d:
+			return PADBUTTON_LSTICK;
+		case 0x13e:
+			return PADBUTTON_RSTICK;
+		case 0x220:
+			return PADBUTTON_DPAD_UP;
+		case 0x221:
+			return PADBUTTON_DPAD_DOWN;
+		case 0x222:
+			return PADBUTTON_DPAD_LEFT;
+		case 0x223:
+			return PADBUTTON_DPAD_RIGHT;
+		default:
+			break;
+	}
+	// Joystick buttons from BTN_TRIGGER
+	if ((code >= EVDEV_BTN_JOYSTICK) && (code < EVDEV_BTN_JOYSTICK + 15))
+		return PADBUTTON_JOYSTICK << (code - EVDEV_BTN_JOYSTICK);
+	return 0;
+}
+
+static void
+input_evdev_pad_ranges(input_evdev_device_t* device) {
+	for (unsigned int code = 0; code < INPUT_EVDEV_ABS_MAX; ++code) {
+		input_evdev_absinfo_t info;
+		memset(&info, 0, sizeof(info));
+		if (ioctl(device->fd, EVDEV_IOCGABS(code), &info) < 0) {
+			// Streams that are not device nodes get the ranges of common pads
+			unsigned int axis = input_evdev_pad_axis[code];
+			if ((code == EVDEV_ABS_HAT0X) || (code == EVDEV_ABS_HAT0Y)) {
+				info.minimum = -1;
+				info.maximum = 1;
+			} else if ((axis == PADAXIS_LEFT_TRIGGER + 1) || (axis == PADAXIS_RIGHT_TRIGGER + 1)) {
+				info.maximum = 255;
+			} else if (axis) {
+				info.minimum = -32768;
+				info.maximum = 32767;
+			}
+		}
+		device->abs_value[code] = info.value;
+		device->abs_minimum[code] = info.minimum;
+		device->abs_maximum[code] = info.maximum;
+	}
+}
+
+static void
+input_evdev_pad_resync(input_evdev_device_t* device) {
+	uint8_t keys[(EVDEV_KEY_MAX + 8) / 8];
+	memset(keys, 0, sizeof(keys));
+	if (ioctl(device->fd, EVDEV_IOCGKEY(sizeof(keys)), keys) >= 0) {
+		device->pad_buttons = 0;
+		for (unsigned int code = EVDEV_BTN_JOYSTICK; code <= EVDEV_KEY_MAX; ++code) {
+			if (input_evdev_bit(keys, code))
+				device->pad_buttons |= input_evdev_pad_button(code);
+		}
+	}
+	for (unsigned int code = 0; code < INPUT_EVDEV_ABS_MAX; ++code) {
+		input_evdev_absinfo_t info;
+		if (ioctl(device->fd, EVDEV_IOCGABS(code), &info) >= 0)
+			device->abs_value[code] = info.value;
+	}
+	device->pad_changed = true;
+}
+
+static void
+input_evdev_pad_flush(input_evdev_device_t* device, tick_t timestamp) {
+	real axis[PADAXIS_COUNT];
+	memset(axis, 0, sizeof(axis));
+	for (unsigned int code = 0; code < INPUT_EVDEV_ABS_MAX; ++code) {
+		unsigned int map = input_evdev_pad_axis[code];
+		int32_t range = device->abs_maximum[code] - device->abs_minimum[code];
+		if (!map || (range <= 0))
+			continue;
+		real value = (real)(device->abs_value[code] - device->abs_minimum[code]) / (real)range;
+		value = (value < 0) ? 0 : ((value > REAL_ONE) ? REAL_ONE : value);
+		if ((map == PADAXIS_LEFT_TRIGGER + 1) || (map == PADAXIS_RIGHT_TRIGGER + 1)) {
+			if (value > axis[map - 1])
+				axis[map - 1] = value;
+		} else {
+			axis[map - 1] = (value * REAL_TWO) - REAL_ONE;
+		}
+	}
+
+	unsigned int buttons = device->pad_buttons;
+	if (device->abs_value[EVDEV_ABS_HAT0X] < 0)
+		buttons |= PADBUTTON_DPAD_LEFT;
+	else if (device->abs_value[EVDEV_ABS_HAT0X] > 0)
+		buttons |= PADBUTTON_DPAD_RIGHT;
+	if (device->abs_value[EVDEV_ABS_HAT0Y] < 0)
+		buttons |= PADBUTTON_DPAD_UP;
+	else if (device->abs_value[EVDEV_ABS_HAT0Y] > 0)
+		buttons |= PADBUTTON_DPAD_DOWN;
+
+	input_pad_update((unsigned int)device->pad, timestamp, buttons, axis);
+	device->pad_changed = false;
+}
+
+static void
+input_evdev_pad_handle(input_evdev_device_t* device, const input_evdev_event_t* event) {
+	if (event->type == EVDEV_EV_KEY) {
+		unsigned int button = input_evdev_pad_button(event->code);
+		if (!button || (event->value > 1))
+			return;
+		if (event->value)
+			device->pad_buttons |= button;
+		else
+			device->pad_buttons &= ~button;
+		device->pad_changed = true;
+	} else if ((event->type == EVDEV_EV_ABS) && (event->code < INPUT_EVDEV_ABS_MAX)) {
+		device->abs_value[event->code] = event->value;
+		device->pad_changed = true;
+	}
+}
+
+static tick_t
+input_evdev_timestamp(const input_evdev_device_t* device, const input_evdev_event_t* event, tick_t now) {
+	// Streams that are not device nodes cannot select the clock, their timestamps are unrelated
+	if (!device->monotonic)
+		return now;
+	int64_t ns = ((int64_t)event->time.tv_sec * 1000000000LL) + ((int64_t)event->time.tv_usec * 1000LL);
+	return input_clock_from_monotonic(ns, now);
+}
+
+static void
+input_evdev_handle(input_evdev_device_t* device, const input_evdev_event_t* event, tick_t now) {
+	if (event->type == EVDEV_EV_SYN) {
+		if (event->code == EVDEV_SYN_DROPPED) {
+			device->dropped = true;
+		} else if (event->code == EVDEV_SYN_REPORT) {
+			tick_t timestamp = input_evdev_timestamp(device, event, now);
+			if (device->pad >= 0) {
+				if (device->dropped) {
+					device->dropped = false;
+					input_evdev_pad_resync(device);
+				}
+				if (device->pad_changed)
+					input_evdev_pad_flush(device, timestamp);
+			} else if (device->dropped) {
+				device->dx = device->dy = device->dz = 0;
+				device->absolute = 0;
+				device->changes = 0;
+				device->dropped = false;
+				input_evdev_resync(device, timestamp);
+			} else {
+				input_evdev_flush(device, timestamp);
+			}
+		}
+		return;
+	}
+	if (device->dropped)
+		return;
+	if (device->pad >= 0) {
+		input_evdev_pad_handle(device, event);
+		return;
+	}
+
+	switch (event->type) {
+		case EVDEV_EV_KEY:
+			// Autorepeat (value 2) is not a transition
+			if ((event->value > 1) || (event->code > EVDEV_KEY_MAX))
+				break;
+			if (device->changes == INPUT_EVDEV_FRAME_MAX)
+				input_evdev_flush(device, input_evdev_timestamp(device, event, now));
+			device->change_code[device->changes] = event->code;
+			device->change_down[device->changes] = (event->value != 0);
+			++device->changes;
+			break;
+
+		case EVDEV_EV_REL:
+			if (event->code == EVDEV_REL_X)
+				device->dx += event->value;
+			else if (event->code == EVDEV_REL_Y)
+				device->dy += event->value;
+			else if (event->code == EVDEV_REL_WHEEL)
+				device->dz += event->value;
+			break;
+
+		case EVDEV_EV_ABS:
+			if (event->code == EVDEV_ABS_X) {
+				device->x = event->value;
+				device->absolute |= 1;
+			} else if (event->code == EVDEV_ABS_Y) {
+				device->y = event->value;
+				device->absolute |= 2;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+static bool
+input_evdev_read(input_evdev_device_t* device) {
+	while (true) {
+		uint8_t* buffer = (uint8_t*)device->buffer;
+		ssize_t bytes = read(device->fd, buffer + device->fill, sizeof(device->buffer) - device->fill);
+		if (bytes < 0) {
+			if (errno == EINTR)
+				continue;
+			return (errno == EAGAIN);
+		}
+		if (!bytes)
+			return false;
+
+		tick_t now = time_current();
+		device->fill += (size_t)bytes;
+		size_t count = device->fill / sizeof(input_evdev_event_t);
+		for (size_t ievent = 0; ievent < count; ++ievent)
+			input_evdev_handle(device, device->buffer + ievent, now);
+
+		// Keep a partial record until the rest of it has been read
+		size_t used = count * sizeof(input_evdev_event_t);
+		if (used < device->fill)
+			memmove(buffer, buffer + used, device->fill - used);
+		device->fill -= used;
+	}
+}
+
+static input_evdev_device_t*
+input_evdev_add(int fd, bool pad) {
+	if (input_evdev_count >= INPUT_EVDEV_DEVICE_MAX)
+		return 0;
+
+	input_evdev_device_t* device =
+	    memory_allocate(HASH_INPUT, sizeof(input_evdev_device_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	device->fd = fd;
+	device->pad = -1;
+	int clock = CLOCK_MONOTONIC;
+	device->monotonic = (ioctl(fd, EVDEV_IOCSCLOCKID, &clock) == 0);
+	if (device->monotonic)
+		ioctl(fd, EVDEV_IOCGKEY(sizeof(device->keys)), device->keys);
+
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = device;
+	if (epoll_ctl(input_evdev_poll, EPOLL_CTL_ADD, fd, &event) < 0) {
+		memory_deallocate(device);
+		return 0;
+	}
+
+	if (pad) {
+		input_evdev_pad_ranges(device);
+		input_evdev_pad_resync(device);
+		device->pad = input_pad_connect(time_current());
+		if (device->pad < 0) {
+			epoll_ctl(input_evdev_poll, EPOLL_CTL_DEL, fd, 0);
+			memory_deallocate(device);
+			return 0;
+		}
+		input_evdev_pad_flush(device, time_current());
+	}
+
+	input_evdev_devices[input_evdev_count++] = device;
+	return device;
+}
+
+static void
+input_evdev_detach(input_evdev_device_t* device) {
+	epoll_ctl(input_evdev_poll, EPOLL_CTL_DEL, device->fd, 0);
+	close(device->fd);
+	if (device->pad >= 0)
+		input_pad_disconnect((unsigned int)device->pad, time_current());
+	for (size_t idevice = 0; idevice < input_evdev_count; ++idevice) {
+		if (input_evdev_devices[idevice] == device) {
+			input_evdev_devices[idevice] = input_evdev_devices[--input_evdev_count];
+			break;
+		}
+	}
+	memory_deallocate(device);
+}
+
+typedef enum input_evdev_class {
+	INPUTEVDEV_UNSUPPORTED = 0,
+	INPUTEVDEV_KEYBOARD_MOUSE,
+	INPUTEVDEV_PAD
+} input_evdev_class;
+
+static input_evdev_class
+input_evdev_classify(int fd) {
+	uint8_t types[4];
+	uint8_t keys[(EVDEV_KEY_MAX + 8) / 8];
+	uint8_t relative[4];
+	uint8_t absolute[8];
+	memset(types, 0, sizeof(types));
+	memset(keys, 0, sizeof(keys));
+	memset(relative, 0, sizeof(relative));
+	memset(absolute, 0, sizeof(absolute));
+	if (ioctl(fd, EVDEV_IOCGBIT(0, sizeof(types)), types) < 0)
+		return INPUTEVDEV_UNSUPPORTED;
+	if (input_evdev_bit(types, EVDEV_EV_KEY))
+		ioctl(fd, EVDEV_IOCGBIT(EVDEV_EV_KEY, sizeof(keys)), keys);
+	if (input_evdev_bit(types, EVDEV_EV_REL))
+		ioctl(fd, EVDEV_IOCGBIT(EVDEV_EV_REL, sizeof(relative)), relative);
+	if (input_evdev_bit(types, EVDEV_EV_ABS))
+		ioctl(fd, EVDEV_IOCGBIT(EVDEV_EV_ABS, sizeof(absolute)), absolute);
+	bool keyboard = input_evdev_bit(keys, EVDEV_KEY_A) && input_evdev_bit(keys, EVDEV_KEY_ENTER);
+	bool mouse = input_evdev_bit(keys, EVDEV_BTN_LEFT) && input_evdev_bit(relative, EVDEV_REL_X) &&
+	             input_evdev_bit(relative, EVDEV_REL_Y);
+	if (keyboard || mouse)
+		return INPUTEVDEV_KEYBOARD_MOUSE;
+	bool pad = (input_evdev_bit(keys, EVDEV_BTN_SOUTH) || input_evdev_bit(keys, EVDEV_BTN_JOYSTICK)) &&
+	           input_evdev_bit(absolute, EVDEV_ABS_X) && input_evdev_bit(absolute, EVDEV_ABS_Y);
+	return pad ? INPUTEVDEV_PAD : INPUTEVDEV_UNSUPPORTED;
+}
+
+static void
+input_evdev_scan(bool keyboard_mouse, bool pads) {
+	DIR* dir = opendir("/dev/input");
+	if (!dir) {
+		log_warn(HASH_INPUT, WARNING_SUSPICIOUS, STRING_CONST("Unable to open /dev/input"));
+		return;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(dir))) {
+		if (strncmp(entry->d_name, "event", 5))
+			continue;
+		char path[64];
+		int length = snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name);
+		if ((length < 0) || ((size_t)length >= sizeof(path)))
+			continue;
+		int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (fd < 0)
+			continue;
+		input_evdev_class kind = input_evdev_classify(fd);
+		bool wanted = ((kind == INPUTEVDEV_KEYBOARD_MOUSE) && keyboard_mouse) || ((kind == INPUTEVDEV_PAD) && pads);
+		if (!wanted || !input_evdev_add(fd, kind == INPUTEVDEV_PAD))
+			close(fd);
+	}
+	closedir(dir);
+	log_infof(HASH_INPUT, STRING_CONST("Opened %u evdev devices"), (unsigned int)input_evdev_count);
+}
+
+static bool
+input_evdev_wait(int timeout) {
+	struct epoll_event ready[INPUT_EVDEV_DEVICE_MAX + 1];
+	int count = epoll_wait(input_evdev_poll, ready, INPUT_EVDEV_DEVICE_MAX + 1, timeout);
+	if (count < 0)
+		return (errno == EINTR);
+	bool running = true;
+	mutex_lock(input_evdev_lock);
+	for (int iready = 0; iready < count; ++iready) {
+		input_evdev_device_t* device = ready[iready].data.ptr;
+		if (!device)
+			running = false;
+		else if (!input_evdev_read(device))
+			input_evdev_detach(device);
+	}
+	mutex_unlock(input_evdev_lock);
+	return running;
+}
+
+static void
+input_evdev_thread_schedule(void) {
+	if (input_evdev_affinity) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (unsigned int cpu = 0; (cpu < 64) && (cpu < CPU_SETSIZE); ++cpu) {
+			if (input_evdev_affinity & (1ULL << cpu))
+				CPU_SET(cpu, &set);
+		}
+		if (sched_setaffinity(0, sizeof(set), &set) < 0)
+			log_warnf(HASH_INPUT, WARNING_SYSTEM_CALL_FAIL, STRING_CONST("Unable to set input thread affinity: %s"),
+			          strerror(errno));
+	}
+	if (input_evdev_priority > 0) {
+		struct sched_param param;
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = input_evdev_priority;
+		if (sched_setscheduler(0, SCHED_FIFO, &param) < 0)
+			log_warnf(HASH_INPUT, WARNING_SYSTEM_CALL_FAIL,
+			          STRING_CONST("Unable to set input thread real-time priority %d: %s"), input_evdev_priority,
+			          strerror(errno));
+	}
+}
+
+static void*
+input_evdev_thread_main(void* arg) {
+	FOUNDATION_UNUSED(arg);
+	input_evdev_thread_schedule();
+	while (input_evdev_wait(-1)) {
+	}
+	return 0;
+}
+
+static void
+input_evdev_thread_start(void) {
+	input_evdev_wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = 0;
+	if ((input_evdev_wakeup < 0) || (epoll_ctl(input_evdev_poll, EPOLL_CTL_ADD, input_evdev_wakeup, &event) < 0)) {
+		log_warn(HASH_INPUT, WARNING_SYSTEM_CALL_FAIL,
+		         STRING_CONST("Unable to create input thread wakeup, reading input in input_event_process"));
+		if (input_evdev_wakeup >= 0)
+			close(input_evdev_wakeup);
+		input_evdev_wakeup = -1;
+		return;
+	}
+
+	thread_initialize(&input_evdev_thread, input_evdev_thread_main, 0, STRING_CONST("input"),
+	                  THREAD_PRIORITY_HIGHEST, 0);
+	if (!thread_start(&input_evdev_thread)) {
+		log_warn(HASH_INPUT, WARNING_SYSTEM_CALL_FAIL,
+		         STRING_CONST("Unable to start input thread, reading input in input_event_process"));
+		thread_finalize(&input_evdev_thread);
+		close(input_evdev_wakeup);
+		input_evdev_wakeup = -1;
+		return;
+	}
+	input_evdev_threaded = true;
+}
+
+static void
+input_evdev_thread_stop(void) {
+	if (!input_evdev_threaded)
+		return;
+	uint64_t signal = 1;
+	while ((write(input_evdev_wakeup, &signal, sizeof(signal)) < 0) && (errno == EINTR)) {
+	}
+	thread_finalize(&input_evdev_thread);
+	close(input_evdev_wakeup);
+	input_evdev_wakeup = -1;
+	input_evdev_threaded = false;
+}
+
+int
+input_evdev_initialize(const input_config_t config) {
+	input_evdev_count = 0;
+	input_evdev_x = 0;
+	input_evdev_y = 0;
+	input_evdev_buttons = 0;
+	input_evdev_threaded = false;
+	input_evdev_affinity = config.thread_affinity;
+	input_evdev_priority = config.thread_priority;
+	input_evdev_poll = epoll_create1(EPOLL_CLOEXEC);
+	if (input_evdev_poll < 0)
+		return -1;
+	input_evdev_lock = mutex_allocate(STRING_CONST("input_evdev"));
+	if (config.evdev || config.gamepads)
+		input_evdev_scan(config.evdev, config.gamepads);
+	if (config.thread)
+		input_evdev_thread_start();
+	return 0;
+}
+
+void
+input_evdev_finalize(void) {
+	input_evdev_thread_stop();
+	while (input_evdev_count)
+		input_evdev_detach(input_evdev_devices[0]);
+	if (input_evdev_poll >= 0)
+		close(input_evdev_poll);
+	input_evdev_poll = -1;
+	if (input_evdev_lock)
+		mutex_deallocate(input_evdev_lock);
+	input_evdev_lock = 0;
+}
+
+void
+input_evdev_process(void) {
+	if (input_evdev_threaded || !input_evdev_count)
+		return;
+	input_evdev_wait(0);
+}
+
+static bool
+input_evdev_nonblocking(int fd) {
+	if ((input_evdev_poll < 0) || (fd < 0))
+		return false;
+	int flags = fcntl(fd, F_GETFL);
+	return (flags >= 0) && (fcntl(fd, F_SETFL, flags | O_NONBLOCK) >= 0);
+}
+
+bool
+input_evdev_attach(int fd) {
+	if (!input_evdev_nonblocking(fd))
+		return false;
+	mutex_lock(input_evdev_lock);
+	bool attached = (input_evdev_add(fd, false) != 0);
+	mutex_unlock(input_evdev_lock);
+	return attached;
+}
+
+int
+input_evdev_attach_pad(int fd) {
+	if (!input_evdev_nonblocking(fd))
+		return -1;
+	mutex_lock(input_evdev_lock);
+	input_evdev_device_t* device = input_evdev_add(fd, true);
+	int pad = device ? device->pad : -1;
+	mutex_unlock(input_evdev_lock);
+	return pad;
+}
+
+size_t
+input_evdev_device_count(void) {
+	return input_evdev_count;
+}
+
+#else
+
+int
+input_evdev_initialize(const input_config_t config) {
+	FOUNDATION_UNUSED(config);
+	return 0;
+}
+
+void
+input_evdev_finalize(void) {
+}
+
+void
+input_evdev_process(void) {
+}
+
+bool
+input_evdev_attach(int fd) {
+	FOUNDATION_UNUSED(fd);
+	return false;
+}
+
+int
+input_evdev_attach_pad(int fd) {
+	FOUNDATION_UNUSED(fd);
+	return -1;
+}
+
+size_t
+input_evdev_device_count(void) {
+	return 0;
+}
+
+#endif
@@ -0,0 +1,541 @@
+/* input_iio.c  -  Input library Linux IIO sensor implementation  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#if FOUNDATION_PLATFORM_LINUX
+
+#include <foundation/memory.h>
+#include <foundation/time.h>
+#include <foundation/log.h>
+#include <foundation/posix.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A device is set up by disabling its buffer, enabling the scan elements of the channels
+   used, setting the sampling rate and enabling the buffer again. The kernel then writes one
+   scan per sample to the character device, with the enabled channels in index order, each
+   aligned to its storage size. Reads fill a buffer of many scans, and each channel is then
+   decoded over all complete scans before any event is posted, keeping the per sample work
+   to a few loads and multiplies. A partial scan is kept until the rest of it is read. The
+   timestamp clock is switched to the monotonic clock so device timestamps can be converted
+   to ticks. */
+
+#define INPUT_IIO_DEVICE_MAX 8
+#define INPUT_IIO_READ_SCANS 64
+#define INPUT_IIO_SCAN_MAX 64
+#define INPUT_IIO_BUFFER_LENGTH 256
+#define INPUT_IIO_PATH_MAX 512
+
+typedef enum input_iio_channel_id {
+	INPUTIIO_ACCEL_X = 0,
+	INPUTIIO_ACCEL_Y,
+	INPUTIIO_ACCEL_Z,
+	INPUTIIO_ANGLVEL_X,
+	INPUTIIO_ANGLVEL_Y,
+	INPUTIIO_ANGLVEL_Z,
+	INPUTIIO_TIMESTAMP,
+	INPUTIIO_CHANNEL_COUNT
+} input_iio_channel_id;
+
+typedef struct input_iio_channel_t input_iio_channel_t;
+typedef struct input_iio_device_t input_iio_device_t;
+
+struct input_iio_channel_t {
+	bool enabled;
+	bool is_signed;
+	bool big_endian;
+	unsigned int index;
+	unsigned int offset;
+	unsigned int bytes;
+	unsigned int bits;
+	unsigned int shift;
+	real scale;
+	real bias;
+};
+
+struct input_iio_device_t {
+	int fd;
+	bool accelerometer;
+	bool gyroscope;
+	bool monotonic;
+	size_t scan_size;
+	size_t fill;
+	input_iio_channel_t channel[INPUTIIO_CHANNEL_COUNT];
+	char sysfs[INPUT_IIO_PATH_MAX];
+	uint8_t buffer[INPUT_IIO_READ_SCANS * INPUT_IIO_SCAN_MAX];
+	real value[INPUTIIO_TIMESTAMP][INPUT_IIO_READ_SCANS];
+	int64_t time[INPUT_IIO_READ_SCANS];
+};
+
+static const char* input_iio_channel_name[INPUTIIO_CHANNEL_COUNT] = {
+    "accel_x", "accel_y", "accel_z", "anglvel_x", "anglvel_y", "anglvel_z", "timestamp"};
+
+static input_iio_device_t* input_iio_devices[INPUT_IIO_DEVICE_MAX];
+static size_t input_iio_count;
+static unsigned int input_iio_rate;
+
+static bool
+input_iio_path(char* path, const char* dir, const char* name) {
+	int length = snprintf(path, INPUT_IIO_PATH_MAX, "%s/%s", dir, name);
+	return (length > 0) && (length < INPUT_IIO_PATH_MAX);
+}
+
+static bool
+input_iio_read_attribute(const char* dir, const char* name, char* value, size_t capacity) {
+	char path[INPUT_IIO_PATH_MAX];
+	if (!input_iio_path(path, dir, name))
+		return false;
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	ssize_t bytes;
+	while (((bytes = read(fd, value, capacity - 1)) < 0) && (errno == EINTR)) {
+	}
+	close(fd);
+	if (bytes <= 0)
+		return false;
+	while ((bytes > 0) && ((value[bytes - 1] == '\n') || (value[bytes - 1] == ' ')))
+		--bytes;
+	value[bytes] = 0;
+	return true;
+}
+
+static bool
+input_iio_write_attribute(const char* dir, const char* name, const char* value) {
+	char path[INPUT_IIO_PATH_MAX];
+	if (!input_iio_path(path, dir, name))
+		return false;
+	int fd = open(path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	size_t length = strlen(value);
+	ssize_t bytes;
+	while (((bytes = write(fd, value, length)) < 0) && (errno == EINTR)) {
+	}
+	close(fd);
+	return (bytes == (ssize_t)length);
+}
+
+static bool
+input_iio_read_real(const char* dir, const char* name, real* value) {
+	char buffer[64];
+	if (!input_iio_read_attribute(dir, name, buffer, sizeof(buffer)))
+		return false;
+	*value = (real)strtod(buffer, 0);
+	return true;
+}
+
+// Parse a scan element type like "le:s12/16>>4". Repeated elements are not supported
+static bool
+input_iio_parse_type(const char* type, input_iio_channel_t* channel) {
+	char endian[3];
+	char sign = 0;
+	unsigned int bits = 0;
+	unsigned int storage = 0;
+	unsigned int shift = 0;
+	if (strchr(type, 'X'))
+		return false;
+	if (sscanf(type, "%2s:%c%u/%u>>%u", endian, &sign, &bits, &storage, &shift) < 4)
+		return false;
+	if ((storage != 8) && (storage != 16) && (storage != 32) && (storage != 64))
+		return false;
+	if (!bits || (bits > storage) || (shift >= storage))
+		return false;
+	channel->big_endian = (strcmp(endian, "be") == 0);
+	channel->is_signed = (sign == 's');
+	channel->bits = bits;
+	channel->bytes = storage / 8;
+	channel->shift = shift;
+	return true;
+}
+
+// Scale and offset are per axis or shared by the axes of a sensor type
+static void
+input_iio_channel_calibration(const char* dir, input_iio_channel_id id, input_iio_channel_t* channel) {
+	char name[64];
+	const char* type = (id < INPUTIIO_ANGLVEL_X) ? "accel" : "anglvel";
+	channel->scale = REAL_ONE;
+	channel->bias = 0;
+	snprintf(name, sizeof(name), "in_%s_scale", input_iio_channel_name[id]);
+	if (!input_iio_read_real(dir, name, &channel->scale)) {
+		snprintf(name, sizeof(name), "in_%s_scale", type);
+		input_iio_read_real(dir, name, &channel->scale);
+	}
+	snprintf(name, sizeof(name), "in_%s_offset", input_iio_channel_name[id]);
+	if (!input_iio_read_real(dir, name, &channel->bias)) {
+		snprintf(name, sizeof(name), "in_%s_offset", type);
+		input_iio_read_real(dir, name, &channel->bias);
+	}
+}
+
+static bool
+input_iio_has_channel(const char* dir, input_iio_channel_id id) {
+	char path[INPUT_IIO_PATH_MAX];
+	int length = snprintf(path, sizeof(path), "%s/scan_elements/in_%s_en", dir, input_iio_channel_name[id]);
+	return (length > 0) && (length < (int)sizeof(path)) && (access(path, W_OK) == 0);
+}
+
+static void
+input_iio_channel_disable(const char* dir, input_iio_channel_id id) {
+	char name[64];
+	snprintf(name, sizeof(name), "scan_elements/in_%s_en", input_iio_channel_name[id]);
+	input_iio_write_attribute(dir, name, "0");
+}
+
+static bool
+input_iio_channel_enable(const char* dir, input_iio_channel_id id, input_iio_channel_t* channel) {
+	char name[64];
+	char value[64];
+	memset(channel, 0, sizeof(input_iio_channel_t));
+	snprintf(name, sizeof(name), "scan_elements/in_%s_en", input_iio_channel_name[id]);
+	if (!input_iio_write_attribute(dir, name, "1"))
+		return false;
+	snprintf(name, sizeof(name), "scan_elements/in_%s_index", input_iio_channel_name[id]);
+	if (!input_iio_read_attribute(dir, name, value, sizeof(value))) {
+		input_iio_channel_disable(dir, id);
+		return false;
+	}
+	channel->index = (unsigned int)strtoul(value, 0, 10);
+	snprintf(name, sizeof(name), "scan_elements/in_%s_type", input_iio_channel_name[id]);
+	if (!input_iio_read_attribute(dir, name, value, sizeof(value)) || !input_iio_parse_type(value, channel)) {
+		input_iio_channel_disable(dir, id);
+		return false;
+	}
+	if (id != INPUTIIO_TIMESTAMP)
+		input_iio_channel_calibration(dir, id, channel);
+	channel->enabled = true;
+	return true;
+}
+
+// Lay out the enabled channels in index order, each aligned to its storage size
+static bool
+input_iio_layout(input_iio_device_t* device) {
+	size_t offset = 0;
+	size_t alignment = 1;
+	unsigned int placed = 0;
+	unsigned int previous = 0;
+	while (true) {
+		input_iio_channel_t* next = 0;
+		for (unsigned int ichannel = 0; ichannel < INPUTIIO_CHANNEL_COUNT; ++ichannel) {
+			input_iio_channel_t* channel = device->channel + ichannel;
+			if (!channel->enabled || (placed && (channel->index <= previous)))
+				continue;
+			if (!next || (channel->index < next->index))
+				next = channel;
+		}
+		if (!next)
+			break;
+		offset = (offset + next->bytes - 1) & ~(size_t)(next->bytes - 1);
+		next->offset = (unsigned int)offset;
+		offset += next->bytes;
+		if (next->bytes > alignment)
+			alignment = next->bytes;
+		previous = next->index;
+		++placed;
+	}
+	device->scan_size = (offset + alignment - 1) & ~(alignment - 1);
+	return placed && (device->scan_size <= INPUT_IIO_SCAN_MAX);
+}
+
+static void
+input_iio_set_rate(const char* dir) {
+	if (!input_iio_rate)
+		return;
+	char rate[32];
+	snprintf(rate, sizeof(rate), "%u", input_iio_rate);
+	bool set = input_iio_write_attribute(dir, "sampling_frequency", rate);
+	set |= input_iio_write_attribute(dir, "in_accel_sampling_frequency", rate);
+	set |= input_iio_write_attribute(dir, "in_anglvel_sampling_frequency", rate);
+	if (!set)
+		log_warnf(HASH_INPUT, WARNING_UNSUPPORTED, STRING_CONST("Unable to set sampling rate of IIO device %s"),
+		          dir);
+}
+
+// Devices sampled on a data ready trigger need the trigger selected before the buffer can be
+// enabled, by convention the trigger of the device itself is named after the device
+static void
+input_iio_set_trigger(const char* dir, const char* name) {
+	char trigger[128];
+	char device_name[64];
+	if (!input_iio_read_attribute(dir, "trigger/current_trigger", trigger, sizeof(trigger)) || trigger[0])
+		return;
+	if (!input_iio_read_attribute(dir, "name", device_name, sizeof(device_name)))
+		return;
+	snprintf(trigger, sizeof(trigger), "%s-dev%s", device_name, name + 10);
+	input_iio_write_attribute(dir, "trigger/current_trigger", trigger);
+}
+
+static input_iio_device_t*
+input_iio_open(const char* sysfs, const char* devfs, const char* name) {
+	if (input_iio_count >= INPUT_IIO_DEVICE_MAX)
+		return 0;
+
+	// Devices other than accelerometers and gyroscopes are left untouched
+	char dir[INPUT_IIO_PATH_MAX];
+	if (!input_iio_path(dir, sysfs, name))
+		return 0;
+	if (!input_iio_has_channel(dir, INPUTIIO_ACCEL_X) && !input_iio_has_channel(dir, INPUTIIO_ANGLVEL_X))
+		return 0;
+
+	input_iio_device_t* device =
+	    memory_allocate(HASH_INPUT, sizeof(input_iio_device_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	device->fd = -1;
+	memcpy(device->sysfs, dir, sizeof(dir));
+
+	// Scan elements can only be changed while the buffer is disabled
+	input_iio_write_attribute(dir, "buffer/enable", "0");
+	for (unsigned int ichannel = 0; ichannel < INPUTIIO_CHANNEL_COUNT; ++ichannel)
+		input_iio_channel_enable(dir, (input_iio_channel_id)ichannel, device->channel + ichannel);
+	device->accelerometer = device->channel[INPUTIIO_ACCEL_X].enabled && device->channel[INPUTIIO_ACCEL_Y].enabled &&
+	                        device->channel[INPUTIIO_ACCEL_Z].enabled;
+	device->gyroscope = device->channel[INPUTIIO_ANGLVEL_X].enabled && device->channel[INPUTIIO_ANGLVEL_Y].enabled &&
+	                    device->channel[INPUTIIO_ANGLVEL_Z].enabled;
+	if (!(device->accelerometer || device->gyroscope) || !input_iio_layout(device))
+		goto failed;
+
+	device->monotonic = device->channel[INPUTIIO_TIMESTAMP].enabled &&
+	                    input_iio_write_attribute(dir, "current_timestamp_clock", "monotonic\n");
+	input_iio_set_rate(dir);
+	input_iio_set_trigger(dir, name);
+
+	char length[32];
+	snprintf(length, sizeof(length), "%u", INPUT_IIO_BUFFER_LENGTH);
+	input_iio_write_attribute(dir, "buffer/length", length);
+	if (!input_iio_write_attribute(dir, "buffer/enable", "1")) {
+		log_warnf(HASH_INPUT, WARNING_SYSTEM_CALL_FAIL, STRING_CONST("Unable to enable buffer of IIO device %s"),
+		          dir);
+		goto failed;
+	}
+
+	char path[INPUT_IIO_PATH_MAX];
+	if (input_iio_path(path, devfs, name))
+		device->fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (device->fd < 0) {
+		log_warnf(HASH_INPUT, WARNING_SYSTEM_CALL_FAIL, STRING_CONST("Unable to open IIO device %s: %s"), path,
+		          strerror(errno));
+		input_iio_write_attribute(dir, "buffer/enable", "0");
+		goto failed;
+	}
+
+	input_iio_devices[input_iio_count++] = device;
+	return device;
+
+failed:
+	for (unsigned int ichannel = 0; ichannel < INPUTIIO_CHANNEL_COUNT; ++ichannel) {
+		if (device->channel[ichannel].enabled)
+			input_iio_channel_disable(dir, (input_iio_channel_id)ichannel);
+	}
+	memory_deallocate(device);
+	return 0;
+}
+
+static void
+input_iio_close(input_iio_device_t* device) {
+	close(device->fd);
+	input_iio_write_attribute(device->sysfs, "buffer/enable", "0");
+	for (size_t idevice = 0; idevice < input_iio_count; ++idevice) {
+		if (input_iio_devices[idevice] == device) {
+			input_iio_devices[idevice] = input_iio_devices[--input_iio_count];
+			break;
+		}
+	}
+	memory_deallocate(device);
+}
+
+static FOUNDATION_FORCEINLINE uint64_t
+input_iio_load(const uint8_t* src, unsigned int bytes, bool big_endian) {
+	uint64_t raw = 0;
+	if (big_endian) {
+		for (unsigned int ibyte = 0; ibyte < bytes; ++ibyte)
+			raw = (raw << 8) | src[ibyte];
+	} else {
+		for (unsigned int ibyte = bytes; ibyte > 0; --ibyte)
+			raw = (raw << 8) | src[ibyte - 1];
+	}
+	return raw;
+}
+
+static FOUNDATION_FORCEINLINE int64_t
+input_iio_extract(const input_iio_channel_t* channel, uint64_t raw) {
+	raw >>= channel->shift;
+	unsigned int unused = 64 - channel->bits;
+	if (channel->is_signed)
+		return ((int64_t)(raw << unused)) >> unused;
+	return (int64_t)((raw << unused) >> unused);
+}
+
+// Decode one channel over a batch of scans
+static void
+input_iio_decode(const input_iio_device_t* device, const input_iio_channel_t* channel, size_t count, real* value) {
+	const uint8_t* src = device->buffer + channel->offset;
+	for (size_t iscan = 0; iscan < count; ++iscan, src += device->scan_size) {
+		int64_t raw = input_iio_extract(channel, input_iio_load(src, channel->bytes, channel->big_endian));
+		value[iscan] = ((real)raw + channel->bias) * channel->scale;
+	}
+}
+
+static void
+input_iio_post(input_iio_device_t* device, size_t count, tick_t now) {
+	for (unsigned int ichannel = 0; ichannel < INPUTIIO_TIMESTAMP; ++ichannel) {
+		if (device->channel[ichannel].enabled)
+			input_iio_decode(device, device->channel + ichannel, count, device->value[ichannel]);
+	}
+	if (device->monotonic) {
+		const input_iio_channel_t* channel = device->channel + INPUTIIO_TIMESTAMP;
+		const uint8_t* src = device->buffer + channel->offset;
+		for (size_t iscan = 0; iscan < count; ++iscan, src += device->scan_size)
+			device->time[iscan] = input_iio_extract(channel, input_iio_load(src, channel->bytes, channel->big_endian));
+	}
+
+	for (size_t iscan = 0; iscan < count; ++iscan) {
+		tick_t timestamp = device->monotonic ? input_clock_from_monotonic(device->time[iscan], now) : now;
+		if (device->accelerometer)
+			input_event_post_acceleration_at(INPUTEVENT_ACCELERATION, timestamp, device->value[INPUTIIO_ACCEL_X][iscan],
+			                                 device->value[INPUTIIO_ACCEL_Y][iscan],
+			                                 device->value[INPUTIIO_ACCEL_Z][iscan]);
+		if (device->gyroscope)
+			input_event_post_acceleration_at(INPUTEVENT_ROTATION, timestamp, device->value[INPUTIIO_ANGLVEL_X][iscan],
+			                                 device->value[INPUTIIO_ANGLVEL_Y][iscan],
+			                                 device->value[INPUTIIO_ANGLVEL_Z][iscan]);
+	}
+}
+
+static bool
+input_iio_read(input_iio_device_t* device) {
+	size_t capacity = INPUT_IIO_READ_SCANS * device->scan_size;
+	while (true) {
+		ssize_t bytes = read(device->fd, device->buffer + device->fill, capacity - device->fill);
+		if (bytes < 0) {
+			if (errno == EINTR)
+				continue;
+			return (errno == EAGAIN);
+		}
+		if (!bytes)
+			return false;
+
+		device->fill += (size_t)bytes;
+		size_t count = device->fill / device->scan_size;
+		if (count)
+			input_iio_post(device, count, time_current());
+
+		// Keep a partial scan until the rest of it has been read
+		size_t used = count * device->scan_size;
+		if (used < device->fill)
+			memmove(device->buffer, device->buffer + used, device->fill - used);
+		device->fill -= used;
+	}
+}
+
+int
+input_iio_initialize(const input_config_t config) {
+	input_iio_count = 0;
+	input_iio_rate = config.sensor_rate;
+	if (config.sensors)
+		input_iio_scan(STRING_CONST("/sys/bus/iio/devices"), STRING_CONST("/dev"));
+	return 0;
+}
+
+void
+input_iio_finalize(void) {
+	while (input_iio_count)
+		input_iio_close(input_iio_devices[0]);
+}
+
+void
+input_iio_process(void) {
+	for (size_t idevice = 0; idevice < input_iio_count;) {
+		input_iio_device_t* device = input_iio_devices[idevice];
+		if (input_iio_read(device))
+			++idevice;
+		else
+			input_iio_close(device);
+	}
+}
+
+size_t
+input_iio_scan(const char* sysfs, size_t sysfs_length, const char* devfs, size_t devfs_length) {
+	char sysfs_path[INPUT_IIO_PATH_MAX];
+	char devfs_path[INPUT_IIO_PATH_MAX];
+	if ((sysfs_length >= sizeof(sysfs_path)) || (devfs_length >= sizeof(devfs_path)))
+		return 0;
+	memcpy(sysfs_path, sysfs, sysfs_length);
+	sysfs_path[sysfs_length] = 0;
+	memcpy(devfs_path, devfs, devfs_length);
+	devfs_path[devfs_length] = 0;
+
+	DIR* dir = opendir(sysfs_path);
+	if (!dir)
+		return 0;
+	size_t opened = 0;
+	struct dirent* entry;
+	while ((entry = readdir(dir))) {
+		if (strncmp(entry->d_name, "iio:device", 10))
+			continue;
+		char path[INPUT_IIO_PATH_MAX];
+		if (!input_iio_path(path, sysfs_path, entry->d_name))
+			continue;
+		bool open = false;
+		for (size_t idevice = 0; idevice < input_iio_count; ++idevice)
+			open |= (strcmp(input_iio_devices[idevice]->sysfs, path) == 0);
+		if (!open && input_iio_open(sysfs_path, devfs_path, entry->d_name))
+			++opened;
+	}
+	closedir(dir);
+	log_infof(HASH_INPUT, STRING_CONST("Opened %u IIO sensor devices"), (unsigned int)opened);
+	return opened;
+}
+
+size_t
+input_iio_device_count(void) {
+	return input_iio_count;
+}
+
+#else
+
+int
+input_iio_initialize(const input_config_t config) {
+	FOUNDATION_UNUSED(config);
+	return 0;
+}
+
+void
+input_iio_finalize(void) {
+}
+
+void
+input_iio_process(void) {
+}
+
+size_t
+input_iio_scan(const char* sysfs, size_t sysfs_length, const char* devfs, size_t devfs_length) {
+	FOUNDATION_UNUSED(sysfs, sysfs_length, devfs, devfs_length);
+	return 0;
+}
+
+size_t
+input_iio_device_count(void) {
+	return 0;
+}
+
+#endif
@@ -20,6 +20,7 @@
 
 #include <foundation/time.h>
 #include <foundation/log.h>
+#include <foundation/memory.h>
 #include <foundation/posix.h>
 
 #include <window/event.h>
@@ -27,144 +28,124 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/extensions/xf86vmode.h>
+#include <X11/extensions/XInput2.h>
 
-static unsigned long
+#include <dlfcn.h>
+
+/* XInput2 functions are resolved from libXi at runtime, so the library does not require libXi
+   to be present unless XInput2 is enabled. Raw motion is only delivered to the root window and
+   carries no position, the position is kept from core motion events. The set of relative
+   pointer devices is queried when enabled and again when the device hierarchy changes, raw
+   motion from absolute devices such as tablets and touch screens is ignored. */
+
+#define INPUT_XINPUT_DEVICE_MAX 256
+
+typedef Status (*input_xinput_query_version_fn)(Display*, int*, int*);
+typedef int (*input_xinput_select_events_fn)(Display*, Window, XIEventMask*, int);
+typedef XIDeviceInfo* (*input_xinput_query_device_fn)(Display*, int, int*);
+typedef void (*input_xinput_free_device_info_fn)(XIDeviceInfo*);
+
+typedef struct input_xinput_touch_t {
+	int device;
+	int detail;
+	int x;
+	int y;
+} input_xinput_touch_t;
+
+typedef struct input_x11_keysym_t {
+	uint32_t sym;
+	uint32_t key;
+} input_x11_keysym_t;
+
+// Keysyms outside the contiguous ranges, sorted by keysym value for binary search
+static const input_x11_keysym_t input_x11_keysyms[] = {
+	{XK_space, KEY_SPACE},
+	{XK_numbersign, KEY_HASH},
+	{XK_apostrophe, KEY_APOSTROPHE},
+	{XK_plus, KEY_PLUS},
+	{XK_comma, KEY_COMMA},
+	{XK_minus, KEY_MINUS},
+	{XK_period, KEY_PERIOD},
+	{XK_slash, KEY_SLASH},
+	{XK_colon, KEY_COLON},
+	{XK_semicolon, KEY_SEMICOLON},
+	{XK_less, KEY_LESS},
+	{XK_equal, KEY_EQUAL},
+	{XK_bracketleft, KEY_LEFTBRACKET},
+	{XK_backslash, KEY_BACKSLASH},
+	{XK_bracketright, KEY_RIGHTBRACKET},
+	{XK_grave, KEY_GRAVEACCENT},
+	{XK_ISO_Level3_Shift, KEY_RALT},
+	// {XK_dead_acute, KEY_GRAVEACCENT},
+	{XK_BackSpace, KEY_BACKSPACE},
+	{XK_Tab, KEY_TAB},
+	{XK_Return, KEY_RETURN},
+	{XK_Pause, KEY_PAUSE},
+	{XK_Scroll_Lock, KEY_SCROLLLOCK},
+	{XK_Escape, KEY_ESCAPE},
+	{XK_Home, KEY_HOME},
+	{XK_Left, KEY_LEFT},
+	{XK_Up, KEY_UP},
+	{XK_Right, KEY_RIGHT},
+	{XK_Down, KEY_DOWN},
+	{XK_Page_Up, KEY_PAGEUP},
+	{XK_Page_Down, KEY_PAGEDOWN},
+	{XK_End, KEY_END},
+	{XK_Print, KEY_PRINTSCREEN},
+	{XK_Insert, KEY_INSERT},
+	{XK_Menu, KEY_MENU},
+	{XK_Num_Lock, KEY_NP_NUMLOCK},
+	{XK_KP_Enter, KEY_RETURN},
+	{XK_KP_Home, KEY_NP_7},
+	{XK_KP_Left, KEY_NP_4},
+	{XK_KP_Up, KEY_NP_8},
+	{XK_KP_Right, KEY_NP_6},
+	{XK_KP_Down, KEY_NP_2},
+	{XK_KP_Page_Up, KEY_NP_9},
+	{XK_KP_Page_Down, KEY_NP_3},
+	{XK_KP_End, KEY_NP_1},
+	{XK_KP_Begin, KEY_NP_5},
+	{XK_KP_Insert, KEY_NP_0},
+	{XK_KP_Multiply, KEY_NP_MULTIPLY},
+	{XK_KP_Add, KEY_NP_PLUS},
+	{XK_KP_Separator, KEY_NP_DECIMAL},
+	{XK_KP_Subtract, KEY_NP_MINUS},
+	{XK_KP_Divide, KEY_NP_DIVIDE},
+	{XK_Shift_L, KEY_LSHIFT},
+	{XK_Shift_R, KEY_RSHIFT},
+	{XK_Control_L, KEY_LCTRL},
+	{XK_Control_R, KEY_RCTRL},
+	{XK_Caps_Lock, KEY_CAPSLOCK},
+	{XK_Alt_L, KEY_LALT},
+	{XK_Alt_R, KEY_RALT},
+	{XK_Super_L, KEY_LMETA},
+	{XK_Super_R, KEY_RMETA},
+	{XK_Delete, KEY_DELETE},
+};
+
+static unsigned int
 lookup_key(KeySym sym) {
 	if (sym >= XK_a && sym <= XK_z)
-		return KEY_A + (sym - XK_a);
+		return KEY_A + (unsigned int)(sym - XK_a);
 	if (sym >= XK_A && sym <= XK_Z)
-		return KEY_A + (sym - XK_A);
+		return KEY_A + (unsigned int)(sym - XK_A);
 	if (sym >= XK_0 && sym <= XK_9)
-		return KEY_0 + (sym - XK_0);
+		return KEY_0 + (unsigned int)(sym - XK_0);
 	if (sym >= XK_F1 && sym <= XK_F24)
-		return KEY_F1 + (sym - XK_F1);
+		return KEY_F1 + (unsigned int)(sym - XK_F1);
 	if (sym >= XK_KP_0 && sym <= XK_KP_9)
-		return KEY_NP_0 + (sym - XK_KP_0);
-	switch (sym) {
-		case XK_Escape:
-			return KEY_ESCAPE;
-		case XK_space:
-			return KEY_SPACE;
-		case XK_Return:
-			return KEY_RETURN;
-		case XK_KP_Enter:
-			return KEY_RETURN;
-		case XK_Up:
-			return KEY_UP;
-		case XK_Down:
-			return KEY_DOWN;
-		case XK_Left:
-			return KEY_LEFT;
-		case XK_Right:
-			return KEY_RIGHT;
-		case XK_BackSpace:
-			return KEY_BACKSPACE;
-		case XK_KP_Add:
-			return KEY_NP_PLUS;
-		case XK_KP_Subtract:
-			return KEY_NP_MINUS;
-		case XK_KP_Separator:
-			return KEY_NP_DECIMAL;
-		case XK_KP_Divide:
-			return KEY_NP_DIVIDE;
-		case XK_KP_Multiply:
-			return KEY_NP_MULTIPLY;
-		case XK_Num_Lock:
-			return KEY_NP_NUMLOCK;
-		case XK_KP_Insert:
-			return KEY_NP_0;
-		case XK_KP_End:
-			return KEY_NP_1;
-		case XK_KP_Down:
-			return KEY_NP_2;
-		case XK_KP_Page_Down:
-			return KEY_NP_3;
-		case XK_KP_Left:
-			return KEY_NP_4;
-		case XK_KP_Begin:
-			return KEY_NP_5;
-		case XK_KP_Right:
-			return KEY_NP_6;
-		case XK_KP_Home:
-			return KEY_NP_7;
-		case XK_KP_Up:
-			return KEY_NP_8;
-		case XK_KP_Page_Up:
-			return KEY_NP_9;
-		case XK_Tab:
-			return KEY_TAB;
-		case XK_Caps_Lock:
-			return KEY_CAPSLOCK;
-		case XK_Shift_L:
-			return KEY_LSHIFT;
-		case XK_Shift_R:
-			return KEY_RSHIFT;
-		case XK_Control_L:
-			return KEY_LCTRL;
-		case XK_Control_R:
-			return KEY_RCTRL;
-		case XK_Alt_L:
-			return KEY_LALT;
-		case XK_Alt_R:
-			return KEY_RALT;
-		case 0xFE03:
-			return KEY_RALT;
-		case XK_Super_L:
-			return KEY_LMETA;
-		case XK_Super_R:
-			return KEY_RMETA;
-		case XK_Menu:
-			return KEY_MENU;
-		case XK_less:
-			return KEY_LESS;
-		case XK_Insert:
-			return KEY_INSERT;
-		case XK_Delete:
-			return KEY_DELETE;
-		case XK_Home:
-			return KEY_HOME;
-		case XK_End:
-			return KEY_END;
-		case XK_Page_Up:
-			return KEY_PAGEUP;
-		case XK_Page_Down:
-			return KEY_PAGEDOWN;
-		case XK_Print:
-			return KEY_PRINTSCREEN;
-		case XK_Scroll_Lock:
-			return KEY_SCROLLLOCK;
-		case XK_Pause:
-			return KEY_PAUSE;
-		case XK_plus:
-			return KEY_PLUS;
-		case XK_grave:
-			return KEY_GRAVEACCENT;
-		// case XK_dead_acute: return KEY_GRAVEACCENT;
-		case XK_apostrophe:
-			return KEY_APOSTROPHE;
-		case XK_comma:
-			return KEY_COMMA;
-		case XK_minus:
-			return KEY_MINUS;
-		case XK_period:
-			return KEY_PERIOD;
-		case XK_slash:
-			return KEY_SLASH;
-		case XK_backslash:
-			return KEY_BACKSLASH;
-		case XK_bracketleft:
-			return KEY_LEFTBRACKET;
-		case XK_bracketright:
-			return KEY_RIGHTBRACKET;
-		case XK_colon:
-			return KEY_COLON;
-		case XK_semicolon:
-			return KEY_SEMICOLON;
-		case XK_numbersign:
-			return KEY_HASH;
-		case XK_equal:
-			return KEY_EQUAL;
+		return KEY_NP_0 + (unsigned int)(sym - XK_KP_0);
+	size_t low = 0;
+	size_t high = sizeof(input_x11_keysyms) / sizeof(input_x11_keysyms[0]);
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (input_x11_keysyms[mid].sym < sym)
+			low = mid + 1;
+		else
+			high = mid;
 	}
+	if ((low < sizeof(input_x11_keysyms) / sizeof(input_x11_keysyms[0])) && (input_x11_keysyms[low].sym == sym))
+		return input_x11_keysyms[low].key;
 	return KEY_UNKNOWN;
 }
 
@@ -172,22 +153,307 @@ static int mouse_x, mouse_y;
 static unsigned int mouse_buttons;
 static int mouse_down_x[8];
 static int mouse_down_y[8];
-static time_t mouse_down_time[8];
+static tick_t mouse_down_time[8];
+static input_clock_t server_clock;
+static uint32_t keycode_key[256];
+static Display* keycode_display;
+
+static void* xinput_library;
+static Display* xinput_display;
+static Window xinput_window;
+static int xinput_opcode;
+static input_xinput_query_version_fn xinput_query_version;
+static input_xinput_select_events_fn xinput_select_events;
+static input_xinput_query_device_fn xinput_query_device;
+static input_xinput_free_device_info_fn xinput_free_device_info;
+static bool xinput_focused;
+static bool xinput_inside;
+static bool xinput_motion_pending;
+static Time xinput_motion_time;
+static double xinput_motion_dx;
+static double xinput_motion_dy;
+static uint8_t xinput_relative[INPUT_XINPUT_DEVICE_MAX / 8];
+static input_xinput_touch_t xinput_touch[INPUT_TOUCH_MAX];
+static unsigned int xinput_touches;
 
 int
 input_module_initialize_native(void) {
 	mouse_x = -1;
 	mouse_y = -1;
 	mouse_buttons = 0;
+	memset(&server_clock, 0, sizeof(server_clock));
+	keycode_display = 0;
 	return 0;
 }
 
 void
 input_module_finalize_native(void) {
+	input_xinput_disable();
+	keycode_display = 0;
+}
+
+// Translate the first keysym of every keycode once, key events then index the table by keycode
+static void
+keycode_table_build(Display* display) {
+	for (size_t ikey = 0; ikey < sizeof(keycode_key) / sizeof(keycode_key[0]); ++ikey)
+		keycode_key[ikey] = KEY_UNKNOWN;
+	int min_keycode = 0, max_keycode = 0, per_keycode = 0;
+	XDisplayKeycodes(display, &min_keycode, &max_keycode);
+	if ((min_keycode < 0) || (max_keycode > 255) || (max_keycode < min_keycode))
+		return;
+	KeySym* syms = XGetKeyboardMapping(display, (KeyCode)min_keycode, max_keycode - min_keycode + 1, &per_keycode);
+	if (syms && (per_keycode > 0)) {
+		for (int keycode = min_keycode; keycode <= max_keycode; ++keycode)
+			keycode_key[keycode] = lookup_key(syms[(keycode - min_keycode) * per_keycode]);
+	}
+	if (syms)
+		XFree(syms);
+	keycode_display = display;
+}
+
+static void
+input_xinput_query_devices(void) {
+	memset(xinput_relative, 0, sizeof(xinput_relative));
+	int count = 0;
+	XIDeviceInfo* info = xinput_query_device(xinput_display, XIAllDevices, &count);
+	for (int idevice = 0; idevice < count; ++idevice) {
+		int device = info[idevice].deviceid;
+		if ((info[idevice].use != XISlavePointer) || (device < 0) || (device >= INPUT_XINPUT_DEVICE_MAX))
+			continue;
+		int relative = 0;
+		for (int iclass = 0; iclass < info[idevice].num_classes; ++iclass) {
+			const XIValuatorClassInfo* valuator = (const XIValuatorClassInfo*)info[idevice].classes[iclass];
+			if ((valuator->type == XIValuatorClass) && (valuator->number < 2) && (valuator->mode == XIModeRelative))
+				++relative;
+		}
+		if (relative == 2)
+			xinput_relative[device / 8] |= (uint8_t)(1 << (device % 8));
+	}
+	if (info)
+		xinput_free_device_info(info);
+}
+
+bool
+input_xinput_enable(void* display, unsigned long window) {
+	input_xinput_disable();
+	if (!display)
+		return false;
+
+	int opcode = 0, event = 0, error = 0;
+	if (!XQueryExtension(display, "XInputExtension", &opcode, &event, &error))
+		return false;
+
+	// Xlib keeps references into libXi for the extension once it is used on a display, so
+	// the library is loaded once and never unloaded
+	if (!xinput_library) {
+		xinput_library = dlopen("libXi.so.6", RTLD_NOW | RTLD_LOCAL | RTLD_NODELETE);
+		if (!xinput_library) {
+			log_warn(HASH_INPUT, WARNING_UNSUPPORTED, STRING_CONST("Unable to load libXi, XInput2 not enabled"));
+			return false;
+		}
+		xinput_query_version = (input_xinput_query_version_fn)dlsym(xinput_library, "XIQueryVersion");
+		xinput_select_events = (input_xinput_select_events_fn)dlsym(xinput_library, "XISelectEvents");
+		xinput_query_device = (input_xinput_query_device_fn)dlsym(xinput_library, "XIQueryDevice");
+		xinput_free_device_info = (input_xinput_free_device_info_fn)dlsym(xinput_library, "XIFreeDeviceInfo");
+	}
+	int major = 2, minor = 2;
+	if (!xinput_query_version || !xinput_select_events || !xinput_query_device || !xinput_free_device_info ||
+	    (xinput_query_version(display, &major, &minor) != Success) || (major < 2) || ((major == 2) && (minor < 2))) {
+		log_warn(HASH_INPUT, WARNING_UNSUPPORTED, STRING_CONST("XInput 2.2 not available, XInput2 not enabled"));
+		return false;
+	}
+
+	unsigned char window_mask[XIMaskLen(XI_LASTEVENT)];
+	unsigned char raw_mask[XIMaskLen(XI_LASTEVENT)];
+	unsigned char hierarchy_mask[XIMaskLen(XI_LASTEVENT)];
+	memset(window_mask, 0, sizeof(window_mask));
+	memset(raw_mask, 0, sizeof(raw_mask));
+	memset(hierarchy_mask, 0, sizeof(hierarchy_mask));
+	XISetMask(window_mask, XI_TouchBegin);
+	XISetMask(window_mask, XI_TouchUpdate);
+	XISetMask(window_mask, XI_TouchEnd);
+	XISetMask(window_mask, XI_Enter);
+	XISetMask(window_mask, XI_Leave);
+	XISetMask(window_mask, XI_FocusIn);
+	XISetMask(window_mask, XI_FocusOut);
+	XISetMask(raw_mask, XI_RawMotion);
+	XISetMask(hierarchy_mask, XI_HierarchyChanged);
+
+	XIEventMask window_masks[1] = {{XIAllMasterDevices, sizeof(window_mask), window_mask}};
+	XIEventMask root_masks[2] = {{XIAllMasterDevices, sizeof(raw_mask), raw_mask},
+	                             {XIAllDevices, sizeof(hierarchy_mask), hierarchy_mask}};
+	xinput_select_events(display, (Window)window, window_masks, 1);
+	xinput_select_events(display, DefaultRootWindow((Display*)display), root_masks, 2);
+	XFlush(display);
+
+	Window focus = 0;
+	int revert = 0;
+	XGetInputFocus(display, &focus, &revert);
+
+	xinput_display = display;
+	xinput_window = (Window)window;
+	xinput_opcode = opcode;
+	xinput_touches = 0;
+	xinput_focused = (focus == (Window)window);
+	xinput_inside = false;
+	xinput_motion_pending = false;
+	xinput_motion_dx = 0;
+	xinput_motion_dy = 0;
+	input_xinput_query_devices();
+	return true;
 }
 
 void
-input_event_process(void) {
+input_xinput_disable(void) {
+	if (xinput_display) {
+		// Clear the selections, raw motion on the root window would otherwise keep arriving
+		unsigned char mask[XIMaskLen(XI_LASTEVENT)];
+		memset(mask, 0, sizeof(mask));
+		XIEventMask window_masks[1] = {{XIAllMasterDevices, sizeof(mask), mask}};
+		XIEventMask root_masks[2] = {{XIAllMasterDevices, sizeof(mask), mask}, {XIAllDevices, sizeof(mask), mask}};
+		xinput_select_events(xinput_display, xinput_window, window_masks, 1);
+		xinput_select_events(xinput_display, DefaultRootWindow(xinput_display), root_masks, 2);
+		XFlush(xinput_display);
+	}
+	xinput_display = 0;
+	xinput_window = 0;
+	xinput_opcode = 0;
+	xinput_touches = 0;
+	xinput_focused = false;
+	xinput_inside = false;
+	xinput_motion_pending = false;
+	memset(xinput_relative, 0, sizeof(xinput_relative));
+}
+
+static void
+input_xinput_motion_flush(void) {
+	tick_t timestamp = input_clock_from_milliseconds(&server_clock, (uint32_t)xinput_motion_time, time_current());
+	input_event_post_mouse_at(INPUTEVENT_MOUSEMOVE, timestamp, mouse_x, mouse_y, (real)xinput_motion_dx,
+	                          (real)xinput_motion_dy, 0, 0, mouse_buttons);
+	xinput_motion_pending = false;
+	xinput_motion_dx = 0;
+	xinput_motion_dy = 0;
+}
+
+static void
+input_xinput_raw_motion(const XIRawEvent* raw) {
+	// Raw motion is selected on the root window, only use it while the window has focus or holds the pointer
+	if (!input_xinput_relative_device(raw->sourceid) || (!xinput_focused && !xinput_inside))
+		return;
+	// Values are packed for the valuators set in the mask, x and y are valuators 0 and 1
+	double delta[2] = {0, 0};
+	const double* value = raw->raw_values;
+	for (int ivaluator = 0; (ivaluator < 2) && (ivaluator < raw->valuators.mask_len * 8); ++ivaluator) {
+		if (XIMaskIsSet(raw->valuators.mask, ivaluator))
+			delta[ivaluator] = *value++;
+	}
+	if ((delta[0] == 0) && (delta[1] == 0))
+		return;
+	// The delta is posted with the core motion of the same device event, which follows the raw
+	// event and carries the position. Raw motion without core motion, like when the pointer is
+	// stopped at the edge of the screen, is posted when the next raw motion arrives
+	if (xinput_motion_pending && (xinput_motion_time != raw->time))
+		input_xinput_motion_flush();
+	xinput_motion_pending = true;
+	xinput_motion_time = raw->time;
+	xinput_motion_dx += delta[0];
+	xinput_motion_dy += delta[1];
+}
+
+static void
+input_xinput_touch_event(const XIDeviceEvent* event) {
+	unsigned int touch = 0;
+	for (; touch < INPUT_TOUCH_MAX; ++touch) {
+		if ((xinput_touches & (1U << touch)) && (xinput_touch[touch].device == event->sourceid) &&
+		    (xinput_touch[touch].detail == event->detail))
+			break;
+	}
+
+	int x = (int)event->event_x;
+	int y = (int)event->event_y;
+	tick_t timestamp = input_clock_from_milliseconds(&server_clock, (uint32_t)event->time, time_current());
+	if (event->evtype == XI_TouchBegin) {
+		if (touch < INPUT_TOUCH_MAX)
+			return;
+		for (touch = 0; (touch < INPUT_TOUCH_MAX) && (xinput_touches & (1U << touch)); ++touch) {
+		}
+		if (touch == INPUT_TOUCH_MAX)
+			return;
+		input_xinput_touch_t* state = xinput_touch + touch;
+		state->device = event->sourceid;
+		state->detail = event->detail;
+		state->x = x;
+		state->y = y;
+		xinput_touches |= (1U << touch);
+		input_event_post_touch_at(INPUTEVENT_TOUCHBEGIN, timestamp, x, y, 0, 0, 0, touch, xinput_touches);
+		return;
+	}
+	if (touch == INPUT_TOUCH_MAX)
+		return;
+
+	input_xinput_touch_t* state = xinput_touch + touch;
+	real dx = (real)(x - state->x);
+	real dy = (real)(y - state->y);
+	state->x = x;
+	state->y = y;
+	input_event_id id = INPUTEVENT_TOUCHMOVE;
+	if (event->evtype == XI_TouchEnd) {
+		xinput_touches &= ~(1U << touch);
+		id = INPUTEVENT_TOUCHEND;
+	}
+	input_event_post_touch_at(id, timestamp, x, y, dx, dy, 0, touch, xinput_touches);
+}
+
+bool
+input_xinput_handle_event(void* cookie) {
+	const XGenericEventCookie* generic = cookie;
+	if (!xinput_display || (generic->type != GenericEvent) || (generic->extension != xinput_opcode) ||
+	    !generic->data)
+		return false;
+	switch (generic->evtype) {
+		case XI_RawMotion:
+			input_xinput_raw_motion(generic->data);
+			return true;
+		case XI_TouchBegin:
+		case XI_TouchUpdate:
+		case XI_TouchEnd:
+			input_xinput_touch_event(generic->data);
+			return true;
+		case XI_HierarchyChanged:
+			input_xinput_query_devices();
+			return true;
+		case XI_Enter:
+		case XI_Leave:
+			xinput_inside = (generic->evtype == XI_Enter);
+			return true;
+		case XI_FocusIn:
+		case XI_FocusOut:
+			xinput_focused = (generic->evtype == XI_FocusIn);
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+int
+input_xinput_touch_device(unsigned int touch) {
+	if ((touch >= INPUT_TOUCH_MAX) || !(xinput_touches & (1U << touch)))
+		return -1;
+	return xinput_touch[touch].device;
+}
+
+bool
+input_xinput_relative_device(int device) {
+	if ((device < 0) || (device >= INPUT_XINPUT_DEVICE_MAX))
+		return false;
+	return (xinput_relative[device / 8] & (1 << (device % 8))) != 0;
+}
+
+void
+input_event_process_native(void) {
+	input_evdev_process();
+	input_iio_process();
 }
 
 void
@@ -202,7 +468,8 @@ input_event_handle_window(event_t* event) {
 	}* data = (void*)event->payload;
 
 	unsigned int button = 0;
-	KeySym sym;
+	unsigned int key;
+	tick_t timestamp;
 
 	XPointerMovedEvent* moveevent = (XPointerMovedEvent*)&data->xevent;
 	XButtonEvent* buttonevent = (XButtonEvent*)&data->xevent;
@@ -210,15 +477,35 @@ input_event_handle_window(event_t* event) {
 	XMappingEvent* mapevent = (XMappingEvent*)&data->xevent;
 
 	switch (data->xevent.type) {
+		case GenericEvent:
+			if (xinput_display && (data->xevent.xcookie.extension == xinput_opcode) &&
+			    XGetEventData(xinput_display, &data->xevent.xcookie)) {
+				input_xinput_handle_event(&data->xevent.xcookie);
+				XFreeEventData(xinput_display, &data->xevent.xcookie);
+			}
+			break;
+
 		case MotionNotify:
 			if (mouse_x < 0) {
 				mouse_x = moveevent->x;
 				mouse_y = moveevent->y;
 			}
 
-			input_event_post_mouse(INPUTEVENT_MOUSEMOVE, moveevent->x, moveevent->y,
-			                       (real)((int)moveevent->x - mouse_x), (real)((int)moveevent->y - mouse_y), 0, 0,
-			                       mouse_buttons);
+			// With XInput2 the deltas are the raw motion received since the previous core motion. Without
+			// raw motion, from absolute devices or while the window has neither focus nor the pointer,
+			// the deltas are the change in position as without XInput2
+			timestamp = input_clock_from_milliseconds(&server_clock, (uint32_t)moveevent->time, time_current());
+			if (xinput_display && xinput_motion_pending) {
+				input_event_post_mouse_at(INPUTEVENT_MOUSEMOVE, timestamp, moveevent->x, moveevent->y,
+				                          (real)xinput_motion_dx, (real)xinput_motion_dy, 0, 0, mouse_buttons);
+				xinput_motion_pending = false;
+				xinput_motion_dx = 0;
+				xinput_motion_dy = 0;
+			} else {
+				input_event_post_mouse_at(INPUTEVENT_MOUSEMOVE, timestamp, moveevent->x, moveevent->y,
+				                          (real)((int)moveevent->x - mouse_x), (real)((int)moveevent->y - mouse_y), 0,
+				                          0, mouse_buttons);
+			}
 
 			mouse_x = moveevent->x;
 			mouse_y = moveevent->y;
@@ -241,19 +528,21 @@ input_event_handle_window(event_t* event) {
 					break;
 			}
 
+			timestamp = input_clock_from_milliseconds(&server_clock, (uint32_t)buttonevent->time, time_current());
 			if (data->xevent.type == ButtonPress) {
 				mouse_buttons |= button;
 				mouse_down_x[button] = (int)moveevent->x;
 				mouse_down_y[button] = (int)moveevent->y;
-				mouse_down_time[button] = time_current();
-				input_event_post_mouse(INPUTEVENT_MOUSEDOWN, mouse_down_x[button], mouse_down_y[button], 0, 0, 0,
-				                       button, mouse_buttons);
+				mouse_down_time[button] = timestamp;
+				input_event_post_mouse_at(INPUTEVENT_MOUSEDOWN, timestamp, mouse_down_x[button], mouse_down_y[button],
+				                          0, 0, 0, button, mouse_buttons);
 			} else {
 				int dx = moveevent->x - mouse_down_x[button];
 				int dy = moveevent->y - mouse_down_y[button];
+				real held = (real)time_ticks_to_seconds(time_diff(mouse_down_time[button], timestamp));
 				mouse_buttons &= ~button;
-				input_event_post_mouse(INPUTEVENT_MOUSEUP, moveevent->x, moveevent->y, (real)dx, (real)dy,
-				                       time_elapsed(mouse_down_time[button]), button, mouse_buttons);
+				input_event_post_mouse_at(INPUTEVENT_MOUSEUP, timestamp, moveevent->x, moveevent->y, (real)dx,
+				                          (real)dy, held, button, mouse_buttons);
 			}
 
 			mouse_x = moveevent->x;
@@ -264,48 +553,89 @@ input_event_handle_window(event_t* event) {
 		case MappingNotify:
 			if ((mapevent->request == MappingModifier) || (mapevent->request == MappingKeyboard)) {
 				XRefreshKeyboardMapping((void*)mapevent);
+				keycode_display = 0;
 			}
 			break;
 
 		case KeyRelease:
 		case KeyPress:
+			timestamp = input_clock_from_milliseconds(&server_clock, (uint32_t)keyevent->time, time_current());
 			if (data->xevent.type == KeyPress) {
-				static const int bufsize = 128;
-				static char buf[128];
-				wchar_t* str = 0;
-				size_t len = 0;
-				if (data->window->xic) {
+				// Text is looked up on the stack, only IME commits too long for it use a temporary buffer
+				char text[256];
+				int length = 0;
+				if (data->window && data->window->xic) {
 					Status status;
-					int num = Xutf8LookupString((XIC)data->window->xic, keyevent, buf, bufsize, 0, &status);
-					if ((status == XLookupChars) && (num > 0)) {
-						// Convert to UTF-16
-						str = wstring_allocate_from_string(buf, (size_t)num);
+					XIC xic = (XIC)data->window->xic;
+					length = Xutf8LookupString(xic, keyevent, text, (int)sizeof(text), 0, &status);
+					if ((status == XBufferOverflow) && (length > 0)) {
+						char* commit = memory_allocate(HASH_INPUT, (size_t)length, 0, MEMORY_TEMPORARY);
+						length = Xutf8LookupString(xic, keyevent, commit, length, 0, &status);
+						if (((status == XLookupChars) || (status == XLookupBoth)) && (length > 0))
+							input_event_post_text_at(timestamp, commit, (size_t)length);
+						memory_deallocate(commit);
+						length = 0;
+					} else if ((status != XLookupChars) && (status != XLookupBoth)) {
+						length = 0;
 					}
 				} else {
-					// Fallback to Latin-1 processing
-					static bool init_compose = true;
+					// Fallback to Latin-1 processing, converted to UTF-8
 					static XComposeStatus compose;
-					if (init_compose) {
-						memset(&compose, 0, sizeof(compose));
-						init_compose = false;
+					char latin1[128];
+					int num = XLookupString(keyevent, latin1, (int)sizeof(latin1), 0, &compose);
+					for (int ichar = 0; ichar < num; ++ichar) {
+						unsigned char c = (unsigned char)latin1[ichar];
+						if (c < 0x80) {
+							text[length++] = (char)c;
+						} else {
+							text[length++] = (char)(0xC0 | (c >> 6));
+							text[length++] = (char)(0x80 | (c & 0x3F));
+						}
 					}
-					int num = XLookupString(keyevent, buf, bufsize, 0, &compose);
-					if (num > 0)
-						str = wstring_allocate_from_string(buf, (size_t)num);
 				}
-				if (str)
-					len = wstring_length(str);
-				for (size_t i = 0; i < len; ++i)
-					input_event_post_key(INPUTEVENT_CHAR, (unsigned int)str[i], 0, 0);
+				if (length > 0)
+					input_event_post_text_at(timestamp, text, (size_t)length);
 			}
 
-			sym = XLookupKeysym(keyevent, 0);
+			if (keyevent->display != keycode_display)
+				keycode_table_build(keyevent->display);
+			key = keycode_key[keyevent->keycode & 0xff];
 			if (data->xevent.type == KeyPress)
-				input_event_post_key(INPUTEVENT_KEYDOWN, (unsigned int)lookup_key(sym), keyevent->keycode, 0);
+				input_event_post_key_at(INPUTEVENT_KEYDOWN, timestamp, key, keyevent->keycode, 0);
 			else
-				input_event_post_key(INPUTEVENT_KEYUP, (unsigned int)lookup_key(sym), keyevent->keycode, 0);
+				input_event_post_key_at(INPUTEVENT_KEYUP, timestamp, key, keyevent->keycode, 0);
 			break;
 	}
 }
 
+#else
+
+bool
+input_xinput_enable(void* display, unsigned long window) {
+	FOUNDATION_UNUSED(display, window);
+	return false;
+}
+
+void
+input_xinput_disable(void) {
+}
+
+bool
+input_xinput_handle_event(void* cookie) {
+	FOUNDATION_UNUSED(cookie);
+	return false;
+}
+
+int
+input_xinput_touch_device(unsigned int touch) {
+	FOUNDATION_UNUSED(touch);
+	return -1;
+}
+
+bool
+input_xinput_relative_device(int device) {
+	FOUNDATION_UNUSED(device);
+	return false;
+}
+
 #endif
@@ -468,7 +468,7 @@ input_event_process_main_queue(void) {
 }
 
 void
-input_event_process(void) {
+input_event_process_native(void) {
 	dispatch_sync(dispatch_get_main_queue(), ^{
 	  input_event_process_main_queue();
 	});
@@ -157,7 +157,7 @@ input_module_finalize_native(void) {
 }
 
 void
-input_event_process(void) {
+input_event_process_native(void) {
 }
 
 void
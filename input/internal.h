@@ -15,16 +15,242 @@
 
 #pragma once
 
+#define INPUT_MOUSE_BUTTON_COUNT 8
+#define INPUT_CODE_COUNT (INPUT_KEY_COUNT + INPUT_MOUSE_BUTTON_COUNT)
+
+typedef struct input_ring_t input_ring_t;
+typedef struct input_clock_t input_clock_t;
+
+/* Mapping of a wrapping millisecond source clock to the tick clock, see clock.c */
+struct input_clock_t {
+	uint32_t last;
+	bool valid;
+	int64_t extended;
+	tick_t offset;
+};
+
+/* Compute edges for a word of bits from the current and previous value and the bits that
+   changed in between. Bits that changed but ended up where they started made a round trip
+   and are reported as both pressed and released */
+static FOUNDATION_FORCEINLINE void
+input_bitset_edges(uint64_t current, uint64_t previous, uint64_t changed, uint64_t* pressed, uint64_t* released) {
+	uint64_t round_trip = changed & ~(current ^ previous);
+	*pressed = (current & ~previous) | round_trip;
+	*released = (previous & ~current) | round_trip;
+}
+
 INPUT_EXTERN event_stream_t* input_event_stream_current;
 
+INPUT_API void
+input_clock_initialize(void);
+
+/* Convert a timestamp in nanoseconds of the POSIX monotonic clock to ticks, clamped to now */
+INPUT_API tick_t
+input_clock_from_monotonic(int64_t ns, tick_t now);
+
+/* Convert a timestamp of a wrapping millisecond clock to ticks, clamped to now */
+INPUT_API tick_t
+input_clock_from_milliseconds(input_clock_t* clock, uint32_t ms, tick_t now);
+
 INPUT_API int
 input_module_initialize_native(void);
 
 INPUT_API void
 input_module_finalize_native(void);
 
+INPUT_API void
+input_event_process_native(void);
+
 INPUT_API int
-input_event_initialize(void);
+input_event_initialize(const input_config_t config);
 
 INPUT_API void
 input_event_finalize(void);
+
+INPUT_API void
+input_event_lock(void);
+
+INPUT_API void
+input_event_unlock(void);
+
+INPUT_API void
+input_event_pump(void);
+
+INPUT_API void
+input_event_post_payload(input_event_id id, tick_t timestamp, const input_event_payload_t* payload, size_t size);
+
+INPUT_API void
+input_event_post_payload_batch(input_event_id id, tick_t timestamp, const void* payload, size_t size, size_t count);
+
+INPUT_API size_t
+input_event_queue_depth(void);
+
+INPUT_API void
+input_event_publish(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size);
+
+INPUT_API input_ring_t*
+input_ring_allocate(size_t capacity);
+
+INPUT_API void
+input_ring_deallocate(input_ring_t* ring);
+
+INPUT_API bool
+input_ring_post(input_ring_t* ring, unsigned int id, tick_t timestamp, const input_event_payload_t* payload,
+                size_t size);
+
+INPUT_API size_t
+input_ring_post_batch(input_ring_t* ring, unsigned int id, tick_t timestamp, const void* payload, size_t size,
+                      size_t count);
+
+INPUT_API size_t
+input_ring_capacity(input_ring_t* ring);
+
+INPUT_API size_t
+input_ring_size(input_ring_t* ring);
+
+INPUT_API const input_event_t*
+input_ring_peek(input_ring_t* ring);
+
+INPUT_API void
+input_ring_pop(input_ring_t* ring);
+
+INPUT_API int
+input_broadcast_initialize(size_t capacity);
+
+INPUT_API void
+input_broadcast_finalize(void);
+
+INPUT_API bool
+input_broadcast_enabled(void);
+
+INPUT_API size_t
+input_broadcast_room(size_t required);
+
+INPUT_API bool
+input_broadcast_write(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size);
+
+INPUT_API void
+input_state_initialize(void);
+
+INPUT_API void
+input_state_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload);
+
+INPUT_API void
+input_state_snapshot(void);
+
+INPUT_API unsigned int
+input_state_modifiers(void);
+
+INPUT_API unsigned int
+input_mouse_code(unsigned int button);
+
+INPUT_API int
+input_action_initialize(const input_config_t config);
+
+INPUT_API void
+input_action_finalize(void);
+
+INPUT_API void
+input_action_apply(unsigned int id, const input_event_payload_t* payload);
+
+INPUT_API void
+input_action_snapshot(void);
+
+INPUT_API void
+input_sequence_initialize(void);
+
+INPUT_API void
+input_sequence_finalize(void);
+
+INPUT_API void
+input_sequence_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload);
+
+INPUT_API void
+input_sequence_snapshot(void);
+
+INPUT_API void
+input_gesture_initialize(void);
+
+INPUT_API void
+input_gesture_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload);
+
+INPUT_API void
+input_gesture_update(tick_t timestamp);
+
+INPUT_API void
+input_record_initialize(const input_config_t config);
+
+INPUT_API void
+input_record_finalize(void);
+
+INPUT_API void
+input_record_post(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size);
+
+INPUT_API void
+input_record_post_batch(unsigned int id, tick_t timestamp, const void* payload, size_t size, size_t count);
+
+INPUT_API void
+input_pad_initialize(void);
+
+/* Connect a pad and post the connect event
+\return Pad index, -1 if all pad slots are in use */
+INPUT_API int
+input_pad_connect(tick_t timestamp);
+
+INPUT_API void
+input_pad_disconnect(unsigned int pad, tick_t timestamp);
+
+/* Overwrite the live state of a pad and post events for the button transitions. Must not be
+   called with the event lock held */
+INPUT_API void
+input_pad_update(unsigned int pad, tick_t timestamp, unsigned int buttons, const real* axis);
+
+INPUT_API void
+input_pad_snapshot(void);
+
+INPUT_API void
+input_velocity_initialize(void);
+
+/* Add the position of a published event to its velocity tracker. For touch events with a
+   velocity estimate the payload is copied to tracked with the estimated speed as velocity
+   and true is returned */
+INPUT_API bool
+input_velocity_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload,
+                     input_event_payload_t* tracked);
+
+INPUT_API void
+input_condition_initialize(void);
+
+INPUT_API void
+input_condition_apply(unsigned int id, const input_event_payload_t* payload);
+
+/* Gather and condition all analog channels, after the input state and pad snapshots */
+INPUT_API void
+input_condition_snapshot(void);
+
+INPUT_API int
+input_evdev_initialize(const input_config_t config);
+
+INPUT_API void
+input_evdev_finalize(void);
+
+INPUT_API void
+input_evdev_process(void);
+
+INPUT_API int
+input_iio_initialize(const input_config_t config);
+
+INPUT_API void
+input_iio_finalize(void);
+
+INPUT_API void
+input_iio_process(void);
+
+INPUT_API void
+input_statistics_initialize(void);
+
+INPUT_API void
+input_statistics_post(unsigned int id, size_t count);
+
+INPUT_API void
+input_statistics_publish(tick_t timestamp, tick_t now);
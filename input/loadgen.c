@@ -0,0 +1,160 @@
+/* loadgen.c  -  Input load generator  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/math.h>
+#include <foundation/memory.h>
+
+/* Generators count samples in simulated time, carrying the fraction of a sample left over
+   by each step to the next, so stepping in any interval posts the same total number of
+   samples. Jitter comes from a xorshift generator seeded by the caller. */
+
+#define INPUT_LOADGEN_KEY_MAX 26
+#define INPUT_LOADGEN_GRAVITY REAL_C(9.81)
+
+struct input_loadgen_t {
+	input_loadgen_workload workload;
+	unsigned int rate;
+	unsigned int channels;
+	uint32_t random;
+	uint64_t carry;
+	uint64_t sample;
+	uint64_t posted;
+	int x;
+	int y;
+	unsigned int touches;
+};
+
+static uint32_t
+input_loadgen_random(input_loadgen_t* generator) {
+	uint32_t value = generator->random;
+	value ^= value << 13;
+	value ^= value >> 17;
+	value ^= value << 5;
+	generator->random = value;
+	return value;
+}
+
+static int
+input_loadgen_jitter(input_loadgen_t* generator) {
+	return (int)(input_loadgen_random(generator) % 3) - 1;
+}
+
+static size_t
+input_loadgen_mouse(input_loadgen_t* generator) {
+	// Figure eight through the center of a 1920x1080 screen, one loop per second
+	real angle = (REAL_TWOPI * (real)(generator->sample % generator->rate)) / (real)generator->rate;
+	int x = 960 + (int)(REAL_C(800.0) * math_cos(angle)) + input_loadgen_jitter(generator);
+	int y = 540 + (int)(REAL_C(400.0) * math_sin(angle * REAL_TWO)) + input_loadgen_jitter(generator);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, x, y, (real)(x - generator->x), (real)(y - generator->y), 0, 0, 0);
+	generator->x = x;
+	generator->y = y;
+	return 1;
+}
+
+static size_t
+input_loadgen_touch(input_loadgen_t* generator) {
+	// Strokes last a quarter second, the first sample begins all touches and the last ends them
+	uint64_t period = generator->rate / 4;
+	if (period < 2)
+		period = 2;
+	uint64_t step = generator->sample % period;
+	unsigned int spacing = 1080 / (generator->channels + 1);
+	for (unsigned int itouch = 0; itouch < generator->channels; ++itouch) {
+		int x = 100 + (int)(step * 4) + input_loadgen_jitter(generator);
+		int y = (int)(spacing * (itouch + 1)) + input_loadgen_jitter(generator);
+		if (!step) {
+			generator->touches |= (1U << itouch);
+			input_event_post_touch(INPUTEVENT_TOUCHBEGIN, x, y, 0, 0, 0, itouch, generator->touches);
+		} else if (step + 1 < period) {
+			input_event_post_touch(INPUTEVENT_TOUCHMOVE, x, y, REAL_C(4.0), 0, 0, itouch, generator->touches);
+		} else {
+			generator->touches &= ~(1U << itouch);
+			input_event_post_touch(INPUTEVENT_TOUCHEND, x, y, 0, 0, 0, itouch, generator->touches);
+		}
+	}
+	return generator->channels;
+}
+
+static size_t
+input_loadgen_keys(input_loadgen_t* generator) {
+	for (unsigned int ikey = 0; ikey < generator->channels; ++ikey)
+		input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A + ikey, ikey, 0);
+	for (unsigned int ikey = generator->channels; ikey > 0; --ikey)
+		input_event_post_key(INPUTEVENT_KEYUP, KEY_A + (ikey - 1), ikey - 1, 0);
+	return generator->channels * 2;
+}
+
+static size_t
+input_loadgen_acceleration(input_loadgen_t* generator) {
+	// Gravity rotating about the y axis at half a radian per second, with sensor noise
+	real angle = (REAL_HALF * (real)generator->sample) / (real)generator->rate;
+	real noise = (real)input_loadgen_jitter(generator) * REAL_C(0.05);
+	input_event_post_acceleration(INPUTEVENT_ACCELERATION, INPUT_LOADGEN_GRAVITY * math_sin(angle), noise,
+	                              -INPUT_LOADGEN_GRAVITY * math_cos(angle));
+	return 1;
+}
+
+input_loadgen_t*
+input_loadgen_allocate(input_loadgen_workload workload, unsigned int rate, unsigned int channels, uint32_t seed) {
+	input_loadgen_t* generator =
+	    memory_allocate(HASH_INPUT, sizeof(input_loadgen_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	generator->workload = workload;
+	generator->rate = rate ? rate : 1;
+	if (workload == INPUTLOADGEN_TOUCH_STORM)
+		generator->channels = (channels < INPUT_TOUCH_MAX) ? channels : INPUT_TOUCH_MAX;
+	else if (workload == INPUTLOADGEN_KEY_ROLLOVER)
+		generator->channels = (channels < INPUT_LOADGEN_KEY_MAX) ? channels : INPUT_LOADGEN_KEY_MAX;
+	generator->random = seed ? seed : 0x9e3779b9U;
+	return generator;
+}
+
+void
+input_loadgen_deallocate(input_loadgen_t* generator) {
+	memory_deallocate(generator);
+}
+
+size_t
+input_loadgen_step(input_loadgen_t* generator, unsigned int milliseconds) {
+	size_t posted = 0;
+	generator->carry += (uint64_t)generator->rate * milliseconds;
+	for (; generator->carry >= 1000; generator->carry -= 1000, ++generator->sample) {
+		switch (generator->workload) {
+			case INPUTLOADGEN_MOUSE_MOTION:
+				posted += input_loadgen_mouse(generator);
+				break;
+			case INPUTLOADGEN_TOUCH_STORM:
+				posted += input_loadgen_touch(generator);
+				break;
+			case INPUTLOADGEN_KEY_ROLLOVER:
+				posted += input_loadgen_keys(generator);
+				break;
+			case INPUTLOADGEN_ACCELERATION:
+			default:
+				posted += input_loadgen_acceleration(generator);
+				break;
+		}
+	}
+	generator->posted += posted;
+	return posted;
+}
+
+uint64_t
+input_loadgen_posted(const input_loadgen_t* generator) {
+	return generator->posted;
+}
@@ -0,0 +1,53 @@
+/* loadgen.h  -  Input load generator  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file loadgen.h
+    Synthetic input load generator. A generator posts a parametric workload through the
+    public post functions in steps of simulated time, independent of wall clock time, so a
+    given workload, rate and seed always posts the same events in the same order. Stepping
+    generators and draining the event stream in turn simulates frames of a game loop. */
+
+#include <input/types.h>
+
+/*! Allocate a generator
+\param workload Workload
+\param rate Samples per second. Mouse motion posts one move per sample, a touch storm moves
+            every touch once per sample, a key rollover presses and releases all keys once
+            per sample and acceleration posts one acceleration event per sample
+\param channels Number of touches or keys, ignored for mouse motion and acceleration
+\param seed Seed for the jitter added to positions and samples
+\return New generator */
+INPUT_API input_loadgen_t*
+input_loadgen_allocate(input_loadgen_workload workload, unsigned int rate, unsigned int channels, uint32_t seed);
+
+/*! Deallocate a generator
+\param generator Generator */
+INPUT_API void
+input_loadgen_deallocate(input_loadgen_t* generator);
+
+/*! Post all events for the next interval of simulated time
+\param generator Generator
+\param milliseconds Interval in milliseconds of simulated time
+\return Number of events posted */
+INPUT_API size_t
+input_loadgen_step(input_loadgen_t* generator, unsigned int milliseconds);
+
+/*! Get the number of events posted by a generator since it was allocated
+\param generator Generator
+\return Number of events */
+INPUT_API uint64_t
+input_loadgen_posted(const input_loadgen_t* generator);
@@ -0,0 +1,153 @@
+/* pad.c  -  Gamepad input  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+/* Backends report the complete state of a pad once per device frame. The live state is
+   overwritten in place with the event lock held, and the transitions are posted as button
+   events after the lock is released. Like the key state, each pad keeps a changed mask so
+   a button going down and up between two snapshots is reported as both pressed and released. */
+
+typedef struct input_pad_live_t input_pad_live_t;
+
+struct input_pad_live_t {
+	bool connected;
+	tick_t timestamp;
+	unsigned int buttons;
+	unsigned int changed;
+	real axis[PADAXIS_COUNT];
+};
+
+static input_pad_live_t input_pad_live[INPUT_PAD_MAX];
+static input_pad_state_t input_pad_frame[INPUT_PAD_MAX];
+
+void
+input_pad_initialize(void) {
+	memset(input_pad_live, 0, sizeof(input_pad_live));
+	memset(input_pad_frame, 0, sizeof(input_pad_frame));
+}
+
+static void
+input_pad_post(input_event_id id, tick_t timestamp, unsigned int pad, unsigned int button, unsigned int buttons) {
+	input_event_payload_t payload;
+	payload.pad.pad = pad;
+	payload.pad.button = button;
+	payload.pad.buttons = buttons;
+	input_event_post_payload(id, timestamp, &payload, sizeof(input_pad_event_t));
+}
+
+int
+input_pad_connect(tick_t timestamp) {
+	int pad = -1;
+	input_event_lock();
+	for (unsigned int ipad = 0; ipad < INPUT_PAD_MAX; ++ipad) {
+		if (!input_pad_live[ipad].connected) {
+			memset(input_pad_live + ipad, 0, sizeof(input_pad_live_t));
+			input_pad_live[ipad].connected = true;
+			input_pad_live[ipad].timestamp = timestamp;
+			pad = (int)ipad;
+			break;
+		}
+	}
+	input_event_unlock();
+	if (pad >= 0)
+		input_pad_post(INPUTEVENT_PADCONNECT, timestamp, (unsigned int)pad, 0, 0);
+	return pad;
+}
+
+void
+input_pad_disconnect(unsigned int pad, tick_t timestamp) {
+	real axis[PADAXIS_COUNT];
+	memset(axis, 0, sizeof(axis));
+	input_pad_update(pad, timestamp, 0, axis);
+	input_event_lock();
+	input_pad_live[pad].connected = false;
+	input_event_unlock();
+	input_pad_post(INPUTEVENT_PADDISCONNECT, timestamp, pad, 0, 0);
+}
+
+void
+input_pad_update(unsigned int pad, tick_t timestamp, unsigned int buttons, const real* axis) {
+	input_pad_live_t* live = input_pad_live + pad;
+	input_event_lock();
+	unsigned int previous = live->buttons;
+	unsigned int changed = previous ^ buttons;
+	live->buttons = buttons;
+	live->changed |= changed;
+	live->timestamp = timestamp;
+	memcpy(live->axis, axis, sizeof(live->axis));
+	input_event_unlock();
+
+	for (unsigned int ibit = 0; changed; ++ibit, changed >>= 1) {
+		if (!(changed & 1))
+			continue;
+		unsigned int button = 1U << ibit;
+		if (buttons & button) {
+			previous |= button;
+			input_pad_post(INPUTEVENT_PADBUTTONDOWN, timestamp, pad, button, previous);
+		} else {
+			previous &= ~button;
+			input_pad_post(INPUTEVENT_PADBUTTONUP, timestamp, pad, button, previous);
+		}
+	}
+}
+
+void
+input_pad_snapshot(void) {
+	uint64_t pressed, released;
+	for (unsigned int ipad = 0; ipad < INPUT_PAD_MAX; ++ipad) {
+		input_pad_live_t* live = input_pad_live + ipad;
+		input_pad_state_t* frame = input_pad_frame + ipad;
+		if (!live->connected && !frame->connected)
+			continue;
+		input_bitset_edges(live->buttons, frame->buttons, live->changed, &pressed, &released);
+		frame->connected = live->connected;
+		frame->timestamp = live->timestamp;
+		frame->buttons = live->buttons;
+		frame->pressed = (unsigned int)pressed;
+		frame->released = (unsigned int)released;
+		memcpy(frame->axis, live->axis, sizeof(frame->axis));
+		live->changed = 0;
+	}
+}
+
+const input_pad_state_t*
+input_pad_state(unsigned int pad) {
+	return (pad < INPUT_PAD_MAX) ? input_pad_frame + pad : 0;
+}
+
+bool
+input_pad_button_down(unsigned int pad, unsigned int buttons) {
+	return (pad < INPUT_PAD_MAX) && ((input_pad_frame[pad].buttons & buttons) != 0);
+}
+
+bool
+input_pad_button_pressed(unsigned int pad, unsigned int buttons) {
+	return (pad < INPUT_PAD_MAX) && ((input_pad_frame[pad].pressed & buttons) != 0);
+}
+
+bool
+input_pad_button_released(unsigned int pad, unsigned int buttons) {
+	return (pad < INPUT_PAD_MAX) && ((input_pad_frame[pad].released & buttons) != 0);
+}
+
+real
+input_pad_axis(unsigned int pad, input_pad_axis_id axis) {
+	if ((pad >= INPUT_PAD_MAX) || ((unsigned int)axis >= PADAXIS_COUNT))
+		return 0;
+	return input_pad_frame[pad].axis[axis];
+}
@@ -0,0 +1,60 @@
+/* pad.h  -  Gamepad input  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file pad.h
+    Gamepad and joystick input. Pads are enabled with the gamepads flag in the input config
+    and occupy the first free of INPUT_PAD_MAX slots when connected. Axis values are only kept
+    in the pad state and never posted as events, so high rate pads do not flood the event
+    stream. Connection and button transitions are posted as INPUTEVENT_PAD* events with an
+    input_pad_event_t payload. Like the input state in state.h, pad state is a snapshot taken
+    in each call to input_event_process. */
+
+#include <input/types.h>
+
+/*! Get the latest state snapshot of a pad
+\param pad Pad index
+\return Pad state, null if index is out of range */
+INPUT_API const input_pad_state_t*
+input_pad_state(unsigned int pad);
+
+/*! Query if any of the given pad buttons is held down
+\param pad Pad index
+\param buttons Button mask, see input_pad_button_id
+\return true if any button is down, false if not */
+INPUT_API bool
+input_pad_button_down(unsigned int pad, unsigned int buttons);
+
+/*! Query if any of the given pad buttons was pressed since the previous snapshot
+\param pad Pad index
+\param buttons Button mask, see input_pad_button_id
+\return true if any button was pressed, false if not */
+INPUT_API bool
+input_pad_button_pressed(unsigned int pad, unsigned int buttons);
+
+/*! Query if any of the given pad buttons was released since the previous snapshot
+\param pad Pad index
+\param buttons Button mask, see input_pad_button_id
+\return true if any button was released, false if not */
+INPUT_API bool
+input_pad_button_released(unsigned int pad, unsigned int buttons);
+
+/*! Get a pad axis value
+\param pad Pad index
+\param axis Axis
+\return Axis value, zero if pad is not connected */
+INPUT_API real
+input_pad_axis(unsigned int pad, input_pad_axis_id axis);
@@ -0,0 +1,762 @@
+/* record.c  -  Input session recording  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/atomic.h>
+#include <foundation/thread.h>
+#include <foundation/memory.h>
+#include <foundation/string.h>
+#include <foundation/time.h>
+#include <foundation/log.h>
+#include <foundation/math.h>
+
+#if FOUNDATION_PLATFORM_WINDOWS
+#include <foundation/windows.h>
+#elif FOUNDATION_PLATFORM_POSIX
+#include <foundation/posix.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Posting threads copy events to the recording ring, the same MPSC ring used as event
+   transport, and the recording thread is its single consumer. The ring is kept until the
+   module is finalized so a poster racing input_record_stop never writes to freed memory.
+
+   The file starts with a header followed by one record per event. A record is a varint of
+   the event id shifted up one bit with the low bit set if the event has a payload, a varint
+   of the timestamp delta to the previous record and the payload. Key payloads are varints,
+   mouse and touch coordinates are zigzag varint deltas to the previous mouse or touch
+   position and real values are stored as float32. Other payloads are stored as a varint
+   size and raw bytes. Event ids are never zero, so the zero filled tail of a mapping that
+   was never truncated to size ends the recording. */
+
+#define INPUT_RECORD_MAGIC 0x43455249U
+#define INPUT_RECORD_VERSION 1
+#define INPUT_RECORD_HEADER_SIZE 24
+#define INPUT_RECORD_MAP_SIZE (1024 * 1024)
+#define INPUT_RECORD_MAX_SIZE 128
+#define INPUT_RECORD_RING_SIZE 4096
+
+typedef enum input_record_kind {
+	INPUTRECORD_RAW = 0,
+	INPUTRECORD_KEY,
+	INPUTRECORD_MOUSE,
+	INPUTRECORD_TOUCH,
+	INPUTRECORD_ACCELERATION
+} input_record_kind;
+
+typedef struct input_record_map_t input_record_map_t;
+typedef struct input_record_delta_t input_record_delta_t;
+
+struct input_record_map_t {
+	uint8_t* data;
+	size_t size;
+#if FOUNDATION_PLATFORM_WINDOWS
+	HANDLE file;
+	HANDLE mapping;
+#elif FOUNDATION_PLATFORM_POSIX
+	int fd;
+#endif
+};
+
+struct input_record_delta_t {
+	tick_t timestamp;
+	int mouse_x;
+	int mouse_y;
+	int touch_x;
+	int touch_y;
+};
+
+struct input_replay_t {
+	input_record_map_t map;
+	const uint8_t* read;
+	const uint8_t* end;
+	input_record_delta_t delta;
+	tick_t ticks_per_second;
+	tick_t first;
+	tick_t start;
+	bool started;
+	bool pending;
+	bool finished;
+	input_event_t next;
+};
+
+static size_t input_record_ring_size;
+static input_ring_t* input_record_ring;
+static atomicptr_t input_record_target;
+static atomic32_t input_record_running;
+static atomic64_t input_record_dropped;
+static thread_t input_record_writer;
+static input_record_map_t input_record_file;
+static size_t input_record_used;
+static bool input_record_failed;
+static uint64_t input_record_count;
+static input_record_delta_t input_record_delta;
+
+#if FOUNDATION_PLATFORM_WINDOWS
+
+static bool
+input_record_map_create(input_record_map_t* map, const char* path) {
+	map->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, 0, CREATE_ALWAYS,
+	                        FILE_ATTRIBUTE_NORMAL, 0);
+	if (map->file == INVALID_HANDLE_VALUE)
+		return false;
+	map->mapping = 0;
+	map->data = 0;
+	map->size = 0;
+	return true;
+}
+
+static bool
+input_record_map_resize(input_record_map_t* map, size_t size) {
+	if (map->data)
+		UnmapViewOfFile(map->data);
+	if (map->mapping)
+		CloseHandle(map->mapping);
+	map->data = 0;
+	map->mapping = CreateFileMappingA(map->file, 0, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, 0);
+	if (!map->mapping)
+		return false;
+	map->data = MapViewOfFile(map->mapping, FILE_MAP_WRITE, 0, 0, size);
+	map->size = map->data ? size : 0;
+	return map->data != 0;
+}
+
+static void
+input_record_map_close(input_record_map_t* map, size_t used) {
+	if (map->data)
+		UnmapViewOfFile(map->data);
+	if (map->mapping)
+		CloseHandle(map->mapping);
+	if (map->file != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER offset;
+		offset.QuadPart = (LONGLONG)used;
+		if (SetFilePointerEx(map->file, offset, 0, FILE_BEGIN))
+			SetEndOfFile(map->file);
+		CloseHandle(map->file);
+	}
+	memset(map, 0, sizeof(input_record_map_t));
+	map->file = INVALID_HANDLE_VALUE;
+}
+
+static bool
+input_record_map_open(input_record_map_t* map, const char* path) {
+	LARGE_INTEGER size;
+	map->mapping = 0;
+	map->data = 0;
+	map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (map->file == INVALID_HANDLE_VALUE)
+		return false;
+	if (GetFileSizeEx(map->file, &size) && size.QuadPart) {
+		map->mapping = CreateFileMappingA(map->file, 0, PAGE_READONLY, 0, 0, 0);
+		if (map->mapping)
+			map->data = MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (!map->data) {
+		input_record_map_close(map, 0);
+		return false;
+	}
+	map->size = (size_t)size.QuadPart;
+	return true;
+}
+
+static void
+input_record_map_release(input_record_map_t* map) {
+	UnmapViewOfFile(map->data);
+	CloseHandle(map->mapping);
+	CloseHandle(map->file);
+	memset(map, 0, sizeof(input_record_map_t));
+}
+
+#elif FOUNDATION_PLATFORM_POSIX
+
+static bool
+input_record_map_create(input_record_map_t* map, const char* path) {
+	map->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	map->data = 0;
+	map->size = 0;
+	return map->fd >= 0;
+}
+
+static bool
+input_record_map_resize(input_record_map_t* map, size_t size) {
+	if (map->data)
+		munmap(map->data, map->size);
+	map->data = 0;
+	map->size = 0;
+	if (ftruncate(map->fd, (off_t)size) < 0)
+		return false;
+	void* data = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, map->fd, 0);
+	if (data == MAP_FAILED)
+		return false;
+	map->data = data;
+	map->size = size;
+	return true;
+}
+
+static void
+input_record_map_close(input_record_map_t* map, size_t used) {
+	if (map->data)
+		munmap(map->data, map->size);
+	if (map->fd >= 0) {
+		if (ftruncate(map->fd, (off_t)used) < 0)
+			log_warn(HASH_INPUT, WARNING_SYSTEM_CALL_FAIL, STRING_CONST("Unable to truncate input recording"));
+		close(map->fd);
+	}
+	map->data = 0;
+	map->size = 0;
+	map->fd = -1;
+}
+
+static bool
+input_record_map_open(input_record_map_t* map, const char* path) {
+	struct stat st;
+	map->data = 0;
+	map->fd = open(path, O_RDONLY);
+	if (map->fd < 0)
+		return false;
+	if (!fstat(map->fd, &st) && (st.st_size > 0)) {
+		void* data = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+		if (data != MAP_FAILED) {
+			map->data = data;
+			map->size = (size_t)st.st_size;
+		}
+	}
+	if (!map->data) {
+		close(map->fd);
+		map->fd = -1;
+		return false;
+	}
+	return true;
+}
+
+static void
+input_record_map_release(input_record_map_t* map) {
+	munmap(map->data, map->size);
+	close(map->fd);
+	map->data = 0;
+	map->size = 0;
+	map->fd = -1;
+}
+
+#else
+
+static bool
+input_record_map_create(input_record_map_t* map, const char* path) {
+	FOUNDATION_UNUSED(map, path);
+	return false;
+}
+
+static bool
+input_record_map_resize(input_record_map_t* map, size_t size) {
+	FOUNDATION_UNUSED(map, size);
+	return false;
+}
+
+static void
+input_record_map_close(input_record_map_t* map, size_t used) {
+	FOUNDATION_UNUSED(map, used);
+}
+
+static bool
+input_record_map_open(input_record_map_t* map, const char* path) {
+	FOUNDATION_UNUSED(map, path);
+	return false;
+}
+
+static void
+input_record_map_release(input_record_map_t* map) {
+	FOUNDATION_UNUSED(map);
+}
+
+#endif
+
+static input_record_kind
+input_record_kind_of(unsigned int id) {
+	switch (id) {
+		case INPUTEVENT_KEYDOWN:
+		case INPUTEVENT_KEYUP:
+		case INPUTEVENT_CHAR:
+			return INPUTRECORD_KEY;
+		case INPUTEVENT_MOUSEDOWN:
+		case INPUTEVENT_MOUSEUP:
+		case INPUTEVENT_MOUSEMOVE:
+			return INPUTRECORD_MOUSE;
+		case INPUTEVENT_TOUCHBEGIN:
+		case INPUTEVENT_TOUCHEND:
+		case INPUTEVENT_TOUCHCANCEL:
+		case INPUTEVENT_TOUCHMOVE:
+		case INPUTEVENT_TOUCHSWIPE:
+			return INPUTRECORD_TOUCH;
+		case INPUTEVENT_ACCELERATION:
+		case INPUTEVENT_ROTATION:
+			return INPUTRECORD_ACCELERATION;
+		default:
+			break;
+	}
+	return INPUTRECORD_RAW;
+}
+
+static uint8_t*
+input_record_write_varint(uint8_t* dest, uint64_t value) {
+	while (value >= 0x80) {
+		*dest++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	*dest++ = (uint8_t)value;
+	return dest;
+}
+
+static uint8_t*
+input_record_write_delta(uint8_t* dest, int value, int* previous) {
+	int64_t delta = (int64_t)value - (int64_t)*previous;
+	*previous = value;
+	return input_record_write_varint(dest, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+}
+
+static uint8_t*
+input_record_write_real(uint8_t* dest, real value) {
+	float32_t packed = (float32_t)value;
+	memcpy(dest, &packed, sizeof(packed));
+	return dest + sizeof(packed);
+}
+
+static uint64_t
+input_record_read_varint(const uint8_t** source, const uint8_t* end, bool* valid) {
+	uint64_t value = 0;
+	for (unsigned int shift = 0; shift < 64; shift += 7) {
+		if (*source >= end)
+			break;
+		uint8_t byte = *(*source)++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return value;
+	}
+	*valid = false;
+	return 0;
+}
+
+static int
+input_record_read_delta(const uint8_t** source, const uint8_t* end, bool* valid, int* previous) {
+	uint64_t zigzag = input_record_read_varint(source, end, valid);
+	int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+	*previous = (int)((int64_t)*previous + delta);
+	return *previous;
+}
+
+static real
+input_record_read_real(const uint8_t** source, const uint8_t* end, bool* valid) {
+	float32_t packed = 0;
+	if (*source + sizeof(packed) > end) {
+		*valid = false;
+		return 0;
+	}
+	memcpy(&packed, *source, sizeof(packed));
+	*source += sizeof(packed);
+	return (real)packed;
+}
+
+static uint8_t*
+input_record_encode(uint8_t* dest, const input_event_t* record, input_record_delta_t* delta) {
+	const input_event_payload_t* payload = &record->payload;
+	dest = input_record_write_varint(dest, ((uint64_t)record->id << 1) | (record->size ? 1 : 0));
+	// Producers racing on the ring can publish slightly out of timestamp order
+	tick_t elapsed = (record->timestamp > delta->timestamp) ? record->timestamp - delta->timestamp : 0;
+	delta->timestamp += elapsed;
+	dest = input_record_write_varint(dest, (uint64_t)elapsed);
+	if (!record->size)
+		return dest;
+
+	switch (input_record_kind_of(record->id)) {
+		case INPUTRECORD_KEY:
+			dest = input_record_write_varint(dest, payload->key.key);
+			dest = input_record_write_varint(dest, payload->key.scancode);
+			dest = input_record_write_varint(dest, payload->key.flags);
+			break;
+		case INPUTRECORD_MOUSE:
+			dest = input_record_write_delta(dest, payload->mouse.x, &delta->mouse_x);
+			dest = input_record_write_delta(dest, payload->mouse.y, &delta->mouse_y);
+			dest = input_record_write_real(dest, payload->mouse.dx);
+			dest = input_record_write_real(dest, payload->mouse.dy);
+			dest = input_record_write_real(dest, payload->mouse.dz);
+			dest = input_record_write_varint(dest, payload->mouse.button);
+			dest = input_record_write_varint(dest, payload->mouse.buttons);
+			break;
+		case INPUTRECORD_TOUCH:
+			dest = input_record_write_delta(dest, payload->touch.x, &delta->touch_x);
+			dest = input_record_write_delta(dest, payload->touch.y, &delta->touch_y);
+			dest = input_record_write_real(dest, payload->touch.dx);
+			dest = input_record_write_real(dest, payload->touch.dy);
+			dest = input_record_write_real(dest, payload->touch.velocity);
+			dest = input_record_write_varint(dest, payload->touch.touch);
+			dest = input_record_write_varint(dest, payload->touch.touches);
+			break;
+		case INPUTRECORD_ACCELERATION:
+			dest = input_record_write_real(dest, payload->acceleration.x);
+			dest = input_record_write_real(dest, payload->acceleration.y);
+			dest = input_record_write_real(dest, payload->acceleration.z);
+			break;
+		case INPUTRECORD_RAW:
+		default:
+			dest = input_record_write_varint(dest, record->size);
+			memcpy(dest, payload, record->size);
+			dest += record->size;
+			break;
+	}
+	return dest;
+}
+
+static bool
+input_record_decode(const uint8_t** source, const uint8_t* end, input_event_t* record,
+                    input_record_delta_t* delta) {
+	bool valid = true;
+	input_event_payload_t* payload = &record->payload;
+	uint64_t header = input_record_read_varint(source, end, &valid);
+	if (!valid || (header < 2))
+		return false;
+	record->id = (unsigned int)(header >> 1);
+	delta->timestamp += (tick_t)input_record_read_varint(source, end, &valid);
+	record->timestamp = delta->timestamp;
+	record->size = 0;
+	if (!(header & 1))
+		return valid;
+
+	switch (input_record_kind_of(record->id)) {
+		case INPUTRECORD_KEY:
+			payload->key.key = (unsigned int)input_record_read_varint(source, end, &valid);
+			payload->key.scancode = (unsigned int)input_record_read_varint(source, end, &valid);
+			payload->key.flags = (unsigned int)input_record_read_varint(source, end, &valid);
+			record->size = sizeof(input_key_event_t);
+			break;
+		case INPUTRECORD_MOUSE:
+			payload->mouse.x = input_record_read_delta(source, end, &valid, &delta->mouse_x);
+			payload->mouse.y = input_record_read_delta(source, end, &valid, &delta->mouse_y);
+			payload->mouse.dx = input_record_read_real(source, end, &valid);
+			payload->mouse.dy = input_record_read_real(source, end, &valid);
+			payload->mouse.dz = input_record_read_real(source, end, &valid);
+			payload->mouse.button = (unsigned int)input_record_read_varint(source, end, &valid);
+			payload->mouse.buttons = (unsigned int)input_record_read_varint(source, end, &valid);
+			record->size = sizeof(input_mouse_event_t);
+			break;
+		case INPUTRECORD_TOUCH:
+			payload->touch.x = input_record_read_delta(source, end, &valid, &delta->touch_x);
+			payload->touch.y = input_record_read_delta(source, end, &valid, &delta->touch_y);
+			payload->touch.dx = input_record_read_real(source, end, &valid);
+			payload->touch.dy = input_record_read_real(source, end, &valid);
+			payload->touch.velocity = input_record_read_real(source, end, &valid);
+			payload->touch.touch = (unsigned int)input_record_read_varint(source, end, &valid);
+			payload->touch.touches = (unsigned int)input_record_read_varint(source, end, &valid);
+			record->size = sizeof(input_touch_event_t);
+			break;
+		case INPUTRECORD_ACCELERATION:
+			payload->acceleration.x = input_record_read_real(source, end, &valid);
+			payload->acceleration.y = input_record_read_real(source, end, &valid);
+			payload->acceleration.z = input_record_read_real(source, end, &valid);
+			record->size = sizeof(input_acceleration_event_t);
+			break;
+		case INPUTRECORD_RAW:
+		default: {
+			uint64_t size = input_record_read_varint(source, end, &valid);
+			if (!valid || (size > sizeof(input_event_payload_t)) || (*source + size > end))
+				return false;
+			memcpy(payload, *source, (size_t)size);
+			*source += size;
+			record->size = (unsigned int)size;
+			break;
+		}
+	}
+	return valid;
+}
+
+static size_t
+input_record_drain(void) {
+	size_t count = 0;
+	const input_event_t* record;
+	while ((record = input_ring_peek(input_record_ring))) {
+		if (!input_record_failed && (input_record_used + INPUT_RECORD_MAX_SIZE > input_record_file.size)) {
+			if (!input_record_map_resize(&input_record_file, input_record_file.size * 2)) {
+				log_error(HASH_INPUT, ERROR_OUT_OF_MEMORY, STRING_CONST("Unable to grow input recording"));
+				input_record_failed = true;
+			}
+		}
+		if (!input_record_failed) {
+			uint8_t* dest = input_record_file.data + input_record_used;
+			input_record_used = (size_t)(input_record_encode(dest, record, &input_record_delta) -
+			                             input_record_file.data);
+			++input_record_count;
+		} else {
+			atomic_incr64(&input_record_dropped, memory_order_relaxed);
+		}
+		input_ring_pop(input_record_ring);
+		++count;
+	}
+	return count;
+}
+
+static void*
+input_record_thread(void* arg) {
+	FOUNDATION_UNUSED(arg);
+	while (atomic_load32(&input_record_running, memory_order_acquire)) {
+		if (!input_record_drain())
+			thread_sleep(1);
+	}
+	input_record_drain();
+	return 0;
+}
+
+void
+input_record_initialize(const input_config_t config) {
+	input_record_ring_size = config.record_ring_size ? config.record_ring_size : INPUT_RECORD_RING_SIZE;
+	input_record_ring = 0;
+	atomic_storeptr(&input_record_target, 0, memory_order_release);
+	atomic_store32(&input_record_running, 0, memory_order_release);
+}
+
+void
+input_record_finalize(void) {
+	if (input_record_active())
+		input_record_stop();
+	if (input_record_ring)
+		input_ring_deallocate(input_record_ring);
+	input_record_ring = 0;
+}
+
+void
+input_record_post(unsigned int id, tick_t timestamp, const input_event_payload_t* payload, size_t size) {
+	input_ring_t* ring = atomic_loadptr(&input_record_target, memory_order_acquire);
+	if (ring && !input_ring_post(ring, id, timestamp, payload, size))
+		atomic_incr64(&input_record_dropped, memory_order_relaxed);
+}
+
+void
+input_record_post_batch(unsigned int id, tick_t timestamp, const void* payload, size_t size, size_t count) {
+	input_ring_t* ring = atomic_loadptr(&input_record_target, memory_order_acquire);
+	if (!ring)
+		return;
+	size_t posted = input_ring_post_batch(ring, id, timestamp, payload, size, count);
+	if (posted < count)
+		atomic_add64(&input_record_dropped, (int64_t)(count - posted), memory_order_relaxed);
+}
+
+bool
+input_record_start(const char* path, size_t length) {
+	char buffer[BUILD_MAX_PATHLEN];
+	if (input_record_active())
+		return false;
+
+	string_t filename = string_copy(buffer, sizeof(buffer), path, length);
+	if (!input_record_map_create(&input_record_file, filename.str))
+		return false;
+	if (!input_record_map_resize(&input_record_file, INPUT_RECORD_MAP_SIZE)) {
+		input_record_map_close(&input_record_file, 0);
+		return false;
+	}
+
+	if (!input_record_ring)
+		input_record_ring = input_ring_allocate(input_record_ring_size);
+	// Drop anything posted by threads that raced the previous stop
+	while (input_ring_peek(input_record_ring))
+		input_ring_pop(input_record_ring);
+
+	tick_t start = time_current();
+	uint32_t magic = INPUT_RECORD_MAGIC;
+	uint32_t version = INPUT_RECORD_VERSION;
+	uint64_t ticks_per_second = (uint64_t)time_ticks_per_second();
+	memcpy(input_record_file.data, &magic, sizeof(magic));
+	memcpy(input_record_file.data + 4, &version, sizeof(version));
+	memcpy(input_record_file.data + 8, &ticks_per_second, sizeof(ticks_per_second));
+	memcpy(input_record_file.data + 16, &start, sizeof(start));
+	input_record_used = INPUT_RECORD_HEADER_SIZE;
+	input_record_failed = false;
+	input_record_count = 0;
+	memset(&input_record_delta, 0, sizeof(input_record_delta));
+	input_record_delta.timestamp = start;
+	atomic_store64(&input_record_dropped, 0, memory_order_relaxed);
+
+	atomic_store32(&input_record_running, 1, memory_order_release);
+	thread_initialize(&input_record_writer, input_record_thread, 0, STRING_CONST("input_record"),
+	                  THREAD_PRIORITY_BELOWNORMAL, 0);
+	if (!thread_start(&input_record_writer)) {
+		atomic_store32(&input_record_running, 0, memory_order_release);
+		thread_finalize(&input_record_writer);
+		input_record_map_close(&input_record_file, 0);
+		return false;
+	}
+	atomic_storeptr(&input_record_target, input_record_ring, memory_order_release);
+	return true;
+}
+
+uint64_t
+input_record_stop(void) {
+	if (!input_record_active())
+		return 0;
+	atomic_storeptr(&input_record_target, 0, memory_order_release);
+	atomic_store32(&input_record_running, 0, memory_order_release);
+	thread_finalize(&input_record_writer);
+	input_record_map_close(&input_record_file, input_record_used);
+
+	uint64_t dropped = (uint64_t)atomic_load64(&input_record_dropped, memory_order_acquire);
+	if (dropped)
+		log_warnf(HASH_INPUT, WARNING_PERFORMANCE, STRING_CONST("Input recording dropped %" PRIu64 " events"),
+		          dropped);
+	return input_record_count;
+}
+
+bool
+input_record_active(void) {
+	return atomic_load32(&input_record_running, memory_order_acquire) != 0;
+}
+
+input_replay_t*
+input_replay_allocate(const char* path, size_t length) {
+	char buffer[BUILD_MAX_PATHLEN];
+	input_replay_t* replay =
+	    memory_allocate(HASH_INPUT, sizeof(input_replay_t), 0, MEMORY_PERSISTENT | MEMORY_ZERO_INITIALIZED);
+	string_t filename = string_copy(buffer, sizeof(buffer), path, length);
+	if (!input_record_map_open(&replay->map, filename.str)) {
+		memory_deallocate(replay);
+		return 0;
+	}
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t ticks_per_second = 0;
+	tick_t start = 0;
+	if (replay->map.size >= INPUT_RECORD_HEADER_SIZE) {
+		memcpy(&magic, replay->map.data, sizeof(magic));
+		memcpy(&version, replay->map.data + 4, sizeof(version));
+		memcpy(&ticks_per_second, replay->map.data + 8, sizeof(ticks_per_second));
+		memcpy(&start, replay->map.data + 16, sizeof(start));
+	}
+	if ((magic != INPUT_RECORD_MAGIC) || (version != INPUT_RECORD_VERSION) || !ticks_per_second) {
+		input_replay_deallocate(replay);
+		return 0;
+	}
+
+	replay->read = replay->map.data + INPUT_RECORD_HEADER_SIZE;
+	replay->end = replay->map.data + replay->map.size;
+	replay->delta.timestamp = start;
+	replay->ticks_per_second = (tick_t)ticks_per_second;
+	return replay;
+}
+
+void
+input_replay_deallocate(input_replay_t* replay) {
+	if (!replay)
+		return;
+	if (replay->map.data)
+		input_record_map_release(&replay->map);
+	memory_deallocate(replay);
+}
+
+static bool
+input_replay_peek(input_replay_t* replay) {
+	if (replay->pending)
+		return true;
+	if (replay->finished)
+		return false;
+	if (!input_record_decode(&replay->read, replay->end, &replay->next, &replay->delta)) {
+		replay->finished = true;
+		return false;
+	}
+	if (!replay->started)
+		replay->first = replay->next.timestamp;
+	replay->started = true;
+	replay->pending = true;
+	return true;
+}
+
+static void
+input_replay_post(const input_event_t* record, tick_t timestamp) {
+	const input_event_payload_t* payload = &record->payload;
+	input_event_id id = (input_event_id)record->id;
+	switch (record->size ? input_record_kind_of(record->id) : INPUTRECORD_RAW) {
+		case INPUTRECORD_KEY:
+			input_event_post_key_at(id, timestamp, payload->key.key, payload->key.scancode, payload->key.flags);
+			break;
+		case INPUTRECORD_MOUSE:
+			input_event_post_mouse_at(id, timestamp, payload->mouse.x, payload->mouse.y, payload->mouse.dx,
+			                          payload->mouse.dy, payload->mouse.dz, payload->mouse.button,
+			                          payload->mouse.buttons);
+			break;
+		case INPUTRECORD_TOUCH:
+			input_event_post_touch_at(id, timestamp, payload->touch.x, payload->touch.y, payload->touch.dx,
+			                          payload->touch.dy, payload->touch.velocity, payload->touch.touch,
+			                          payload->touch.touches);
+			break;
+		case INPUTRECORD_ACCELERATION:
+			input_event_post_acceleration_at(id, timestamp, payload->acceleration.x, payload->acceleration.y,
+			                                 payload->acceleration.z);
+			break;
+		case INPUTRECORD_RAW:
+		default:
+			input_event_post_payload(id, timestamp, record->size ? payload : 0, record->size);
+			break;
+	}
+}
+
+static tick_t
+input_replay_last(const input_replay_t* replay) {
+	const uint8_t* read = replay->read;
+	input_record_delta_t delta = replay->delta;
+	input_event_t record;
+	tick_t last = replay->next.timestamp;
+	while (input_record_decode(&read, replay->end, &record, &delta))
+		last = record.timestamp;
+	return last;
+}
+
+size_t
+input_replay_update(input_replay_t* replay, real speed) {
+	size_t posted = 0;
+	tick_t now = time_current();
+	if (!replay->start)
+		replay->start = now;
+	if (!input_replay_peek(replay))
+		return 0;
+	// Recorded ticks to local ticks at the replay speed. Posting all remaining events at once
+	// keeps the recorded spacing with the last event at the current time
+	real scale = (real)time_ticks_per_second() / (real)replay->ticks_per_second;
+	real elapsed = (real)(now - replay->start) / scale;
+	tick_t base = replay->start;
+	tick_t origin = replay->first;
+	if (speed > 0) {
+		scale /= speed;
+		elapsed *= speed;
+	} else {
+		base = now;
+		origin = input_replay_last(replay);
+	}
+	do {
+		real offset = (real)(replay->next.timestamp - origin);
+		if ((speed > 0) && (offset > elapsed))
+			break;
+		tick_t timestamp = base + (tick_t)math_round(offset * scale);
+		input_replay_post(&replay->next, (timestamp < now) ? timestamp : now);
+		replay->pending = false;
+		++posted;
+	} while (input_replay_peek(replay));
+	return posted;
+}
+
+bool
+input_replay_finished(const input_replay_t* replay) {
+	return replay->finished;
+}
@@ -0,0 +1,75 @@
+/* record.h  -  Input session recording  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file record.h
+    Input session recording and replay. While recording, every posted event is copied to a
+    recording ring, and a background thread appends the events to a memory mapped file in a
+    compact encoding with varint timestamp deltas and coordinate deltas. Posting threads only
+    pay for the ring write. Events derived from posted events, like gestures, are not recorded
+    and are derived again on replay. A replay posts the recorded events through the regular
+    post functions, either at the recorded pace scaled by a speed factor or all at once, with
+    the recorded timestamps mapped to the replay clock so derived gestures and velocities
+    match the recorded session. */
+
+#include <input/types.h>
+
+/*! Start recording posted events to a file, replacing any existing file. Recording requires
+platform support for memory mapped files.
+\param path File path
+\param length Length of path
+\return true if recording started, false if already recording or the file could not be mapped */
+INPUT_API bool
+input_record_start(const char* path, size_t length);
+
+/*! Stop recording. Events already in the recording ring are written before the file is closed.
+\return Number of events recorded */
+INPUT_API uint64_t
+input_record_stop(void);
+
+/*! Query if recording is active
+\return true if recording, false if not */
+INPUT_API bool
+input_record_active(void);
+
+/*! Open a recorded file for replay
+\param path File path
+\param length Length of path
+\return Replay, null if the file could not be mapped or is not a recording */
+INPUT_API input_replay_t*
+input_replay_allocate(const char* path, size_t length);
+
+/*! Close a replay
+\param replay Replay */
+INPUT_API void
+input_replay_deallocate(input_replay_t* replay);
+
+/*! Post recorded events that are due. Time starts at the first call for the replay, and an
+event is due once the elapsed time multiplied by the speed factor has reached the time of
+the event relative to the first recorded event. Events are timestamped with the start time
+plus the recorded time divided by the speed factor. Events posted all at once keep the
+recorded spacing, ending at the current time.
+\param replay Replay
+\param speed Speed factor, one for the recorded pace, zero to post all remaining events
+\return Number of events posted */
+INPUT_API size_t
+input_replay_update(input_replay_t* replay, real speed);
+
+/*! Query if all recorded events have been posted
+\param replay Replay
+\return true if replay is finished, false if not */
+INPUT_API bool
+input_replay_finished(const input_replay_t* replay);
@@ -0,0 +1,163 @@
+/* ring.c  -  Lock-free event ring  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/atomic.h>
+#include <foundation/memory.h>
+
+/* Multi-producer, single-consumer bounded ring. Producers claim tickets by a compare and
+   swap of the tail, write the slots and publish each slot by storing the ticket + 1 as the
+   slot sequence. The consumer owns the head and hands the slot back to producers of the
+   next lap by storing head + capacity as the sequence before advancing the head. Each slot
+   occupies its own cache line so producers writing neighbouring tickets do not share lines.
+
+   A producer only claims tickets below head + capacity, which are slots the consumer has
+   already handed back, so a producer never waits for the consumer or for other producers
+   and a full ring fails the post at once. Posting is lock-free but not wait-free, a
+   producer losing the race for the tail retries the claim with the new tail. */
+
+#define INPUT_RING_CACHE_LINE 64
+#define INPUT_RING_MIN_CAPACITY 64
+
+FOUNDATION_ALIGNED_STRUCT(input_ring_slot_t, INPUT_RING_CACHE_LINE) {
+	atomic64_t sequence;
+	input_event_t record;
+};
+
+typedef struct input_ring_slot_t input_ring_slot_t;
+
+FOUNDATION_ALIGNED_STRUCT(input_ring_t, INPUT_RING_CACHE_LINE) {
+	atomic64_t tail;
+	uint8_t tail_padding[INPUT_RING_CACHE_LINE - sizeof(atomic64_t)];
+	atomic64_t head;
+	uint8_t head_padding[INPUT_RING_CACHE_LINE - sizeof(atomic64_t)];
+	int64_t capacity;
+	int64_t mask;
+	input_ring_slot_t* slots;
+};
+
+input_ring_t*
+input_ring_allocate(size_t capacity) {
+	size_t size = INPUT_RING_MIN_CAPACITY;
+	while (size < capacity)
+		size <<= 1;
+
+	input_ring_t* ring = memory_allocate(HASH_INPUT, sizeof(input_ring_t) + (sizeof(input_ring_slot_t) * size),
+	                                     INPUT_RING_CACHE_LINE, MEMORY_PERSISTENT);
+	ring->capacity = (int64_t)size;
+	ring->mask = ring->capacity - 1;
+	ring->slots = (input_ring_slot_t*)(ring + 1);
+	for (int64_t islot = 0; islot < ring->capacity; ++islot)
+		atomic_store64(&ring->slots[islot].sequence, islot, memory_order_relaxed);
+	atomic_store64(&ring->head, 0, memory_order_relaxed);
+	atomic_store64(&ring->tail, 0, memory_order_release);
+	return ring;
+}
+
+void
+input_ring_deallocate(input_ring_t* ring) {
+	memory_deallocate(ring);
+}
+
+/* Claim up to count tickets, returns the number of tickets claimed starting at ticket */
+static int64_t
+input_ring_claim(input_ring_t* ring, int64_t count, int64_t* ticket) {
+	int64_t tail = atomic_load64(&ring->tail, memory_order_relaxed);
+	while (true) {
+		// The head is stored after the sequence of the popped slot, so every slot below
+		// head + capacity has been handed back once the head has been observed
+		int64_t head = atomic_load64(&ring->head, memory_order_acquire);
+		int64_t room = head + ring->capacity - tail;
+		if (room <= 0)
+			return 0;
+		int64_t claim = (count < room) ? count : room;
+		if (atomic_cas64(&ring->tail, tail + claim, tail, memory_order_relaxed, memory_order_relaxed)) {
+			*ticket = tail;
+			return claim;
+		}
+		tail = atomic_load64(&ring->tail, memory_order_relaxed);
+	}
+}
+
+static void
+input_ring_store(input_ring_t* ring, int64_t ticket, unsigned int id, tick_t timestamp, const void* payload,
+                 size_t size) {
+	input_ring_slot_t* slot = ring->slots + (ticket & ring->mask);
+	slot->record.id = id;
+	slot->record.size = (unsigned int)size;
+	slot->record.timestamp = timestamp;
+	if (size)
+		memcpy(&slot->record.payload, payload, size);
+	atomic_store64(&slot->sequence, ticket + 1, memory_order_release);
+}
+
+bool
+input_ring_post(input_ring_t* ring, unsigned int id, tick_t timestamp, const input_event_payload_t* payload,
+                size_t size) {
+	int64_t ticket;
+	if (!input_ring_claim(ring, 1, &ticket))
+		return false;
+	input_ring_store(ring, ticket, id, timestamp, payload, size);
+	return true;
+}
+
+size_t
+input_ring_post_batch(input_ring_t* ring, unsigned int id, tick_t timestamp, const void* payload, size_t size,
+                      size_t count) {
+	const uint8_t* source = payload;
+	size_t posted = 0;
+	while (posted < count) {
+		int64_t ticket;
+		int64_t claim = input_ring_claim(ring, (int64_t)(count - posted), &ticket);
+		if (!claim)
+			break;
+		for (int64_t iclaim = 0; iclaim < claim; ++iclaim, ++ticket, source += size)
+			input_ring_store(ring, ticket, id, timestamp, source, size);
+		posted += (size_t)claim;
+	}
+	return posted;
+}
+
+size_t
+input_ring_capacity(input_ring_t* ring) {
+	return (size_t)ring->capacity;
+}
+
+size_t
+input_ring_size(input_ring_t* ring) {
+	int64_t head = atomic_load64(&ring->head, memory_order_acquire);
+	int64_t tail = atomic_load64(&ring->tail, memory_order_acquire);
+	return (tail > head) ? (size_t)(tail - head) : 0;
+}
+
+const input_event_t*
+input_ring_peek(input_ring_t* ring) {
+	int64_t head = atomic_load64(&ring->head, memory_order_relaxed);
+	input_ring_slot_t* slot = ring->slots + (head & ring->mask);
+	if (atomic_load64(&slot->sequence, memory_order_acquire) != head + 1)
+		return 0;
+	return &slot->record;
+}
+
+void
+input_ring_pop(input_ring_t* ring) {
+	int64_t head = atomic_load64(&ring->head, memory_order_relaxed);
+	input_ring_slot_t* slot = ring->slots + (head & ring->mask);
+	atomic_store64(&slot->sequence, head + ring->capacity, memory_order_release);
+	atomic_store64(&ring->head, head + 1, memory_order_release);
+}
@@ -0,0 +1,398 @@
+/* sequence.c  -  Input sequences  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/array.h>
+#include <foundation/hashtable.h>
+#include <foundation/time.h>
+
+/* Sequences are compiled into an Aho-Corasick automaton over the key and button codes used
+   by any sequence, with failure links folded into a full transition table so each press
+   is a single table lookup. Each state lists every variant ending in it, including those
+   reached through failure links. Chords are expanded into variants with the chorded steps
+   in either order. Timing is not part of the automaton, the timestamps of the latest
+   presses are kept in a ring and checked only when a variant is matched. Sequences are
+   modified and presses applied with the event lock held.
+
+   Adding or removing a sequence only updates the identifier table and marks the automaton
+   dirty, it is compiled once before the next press is applied or the next snapshot, so
+   adding many sequences in a row is linear. */
+
+#define INPUT_SEQUENCE_NONE 0xFFFFFFFFU
+
+typedef struct input_sequence_t input_sequence_t;
+typedef struct input_sequence_variant_t input_sequence_variant_t;
+
+struct input_sequence_t {
+	hash_t id;
+	unsigned int count;
+	unsigned int window_ms;
+	unsigned int step[INPUT_SEQUENCE_MAX_STEPS];
+};
+
+struct input_sequence_variant_t {
+	unsigned int sequence;
+	unsigned int length;
+	unsigned int chord;
+};
+
+static input_sequence_t* input_sequence_source;
+static hashtable64_t* input_sequence_table;
+static size_t input_sequence_table_capacity;
+static size_t input_sequence_erased;
+static bool input_sequence_dirty;
+static unsigned int input_sequence_symbol[INPUT_CODE_COUNT];
+static unsigned int input_sequence_symbol_count;
+static unsigned int* input_sequence_transition;
+static unsigned int* input_sequence_output_first;
+static unsigned int* input_sequence_output_count;
+static unsigned int* input_sequence_output;
+static input_sequence_variant_t* input_sequence_variants;
+static unsigned int input_sequence_state;
+static tick_t input_sequence_history[INPUT_SEQUENCE_MAX_STEPS];
+static unsigned int input_sequence_history_count;
+static uint64_t* input_sequence_triggered_live;
+static uint64_t* input_sequence_triggered_frame;
+
+void
+input_sequence_initialize(void) {
+	memset(input_sequence_symbol, 0, sizeof(input_sequence_symbol));
+	input_sequence_symbol_count = 0;
+	input_sequence_state = 0;
+	input_sequence_history_count = 0;
+	input_sequence_dirty = false;
+}
+
+void
+input_sequence_finalize(void) {
+	array_deallocate(input_sequence_source);
+	array_deallocate(input_sequence_transition);
+	array_deallocate(input_sequence_output_first);
+	array_deallocate(input_sequence_output_count);
+	array_deallocate(input_sequence_output);
+	array_deallocate(input_sequence_variants);
+	array_deallocate(input_sequence_triggered_live);
+	array_deallocate(input_sequence_triggered_frame);
+	hashtable64_deallocate(input_sequence_table);
+	input_sequence_table = 0;
+	input_sequence_table_capacity = 0;
+	input_sequence_erased = 0;
+}
+
+static unsigned int
+input_sequence_code(unsigned int step) {
+	if (step & INPUT_SEQUENCE_MOUSE)
+		return input_mouse_code(step & ~(INPUT_SEQUENCE_MOUSE | INPUT_SEQUENCE_CHORD));
+	unsigned int index = input_key_index(step & ~INPUT_SEQUENCE_CHORD);
+	return (index < INPUT_KEY_COUNT) ? index : INPUT_CODE_COUNT;
+}
+
+static unsigned int
+input_sequence_lookup(hash_t sequence) {
+	uint64_t index = input_sequence_table ? hashtable64_get(input_sequence_table, sequence) : 0;
+	return index ? (unsigned int)(index - 1) : INPUT_SEQUENCE_NONE;
+}
+
+static void
+input_sequence_rehash(size_t capacity) {
+	hashtable64_deallocate(input_sequence_table);
+	input_sequence_table = hashtable64_allocate(capacity);
+	input_sequence_table_capacity = capacity;
+	input_sequence_erased = 0;
+	for (size_t isequence = 0, count = array_size(input_sequence_source); isequence < count; ++isequence)
+		hashtable64_set(input_sequence_table, input_sequence_source[isequence].id, isequence + 1);
+}
+
+static void
+input_sequence_modified(void) {
+	// Triggers are cleared by the compile, until then indices may no longer match
+	if (!input_sequence_dirty) {
+		size_t words = array_size(input_sequence_triggered_frame);
+		if (words)
+			memset(input_sequence_triggered_frame, 0, sizeof(uint64_t) * words);
+	}
+	input_sequence_dirty = true;
+}
+
+static void
+input_sequence_insert(unsigned int** first, unsigned int** chain, const unsigned int* symbol, unsigned int length,
+                      const input_sequence_variant_t* variant) {
+	unsigned int state = 0;
+	for (unsigned int istep = 0; istep < length; ++istep) {
+		size_t slot = (state * input_sequence_symbol_count) + symbol[istep];
+		if (input_sequence_transition[slot] == INPUT_SEQUENCE_NONE) {
+			unsigned int next = (unsigned int)array_size(*first);
+			array_push(*first, INPUT_SEQUENCE_NONE);
+			for (unsigned int isymbol = 0; isymbol < input_sequence_symbol_count; ++isymbol)
+				array_push(input_sequence_transition, INPUT_SEQUENCE_NONE);
+			input_sequence_transition[slot] = next;
+		}
+		state = input_sequence_transition[slot];
+	}
+	// Variants ending in the same state are chained
+	unsigned int index = (unsigned int)array_size(input_sequence_variants);
+	array_push_memcpy(input_sequence_variants, variant);
+	array_push(*chain, (*first)[state]);
+	(*first)[state] = index;
+}
+
+static void
+input_sequence_compile(void) {
+	size_t sequence_count = array_size(input_sequence_source);
+
+	memset(input_sequence_symbol, 0, sizeof(input_sequence_symbol));
+	input_sequence_symbol_count = 0;
+	for (size_t isequence = 0; isequence < sequence_count; ++isequence) {
+		const input_sequence_t* sequence = input_sequence_source + isequence;
+		for (unsigned int istep = 0; istep < sequence->count; ++istep) {
+			unsigned int code = input_sequence_code(sequence->step[istep]);
+			if (!input_sequence_symbol[code])
+				input_sequence_symbol[code] = ++input_sequence_symbol_count;
+		}
+	}
+
+	// Build the trie, inserting every combination of chorded pairs in either order
+	unsigned int* first = 0;
+	unsigned int* chain = 0;
+	array_clear(input_sequence_transition);
+	array_clear(input_sequence_variants);
+	array_push(first, INPUT_SEQUENCE_NONE);
+	for (unsigned int isymbol = 0; isymbol < input_sequence_symbol_count; ++isymbol)
+		array_push(input_sequence_transition, INPUT_SEQUENCE_NONE);
+
+	for (size_t isequence = 0; isequence < sequence_count; ++isequence) {
+		const input_sequence_t* sequence = input_sequence_source + isequence;
+		input_sequence_variant_t variant;
+		unsigned int symbol[INPUT_SEQUENCE_MAX_STEPS];
+		variant.sequence = (unsigned int)isequence;
+		variant.length = sequence->count;
+		variant.chord = 0;
+		for (unsigned int istep = 0; istep < sequence->count; ++istep) {
+			symbol[istep] = input_sequence_symbol[input_sequence_code(sequence->step[istep])] - 1;
+			if ((istep > 0) && (sequence->step[istep] & INPUT_SEQUENCE_CHORD))
+				variant.chord |= 1U << istep;
+		}
+		unsigned int swap = variant.chord;
+		while (true) {
+			// Overlapping pairs cannot both be swapped
+			if (!(swap & (swap >> 1))) {
+				unsigned int ordered[INPUT_SEQUENCE_MAX_STEPS];
+				memcpy(ordered, symbol, sizeof(unsigned int) * sequence->count);
+				for (unsigned int istep = 1; istep < sequence->count; ++istep) {
+					if (swap & (1U << istep)) {
+						ordered[istep - 1] = symbol[istep];
+						ordered[istep] = symbol[istep - 1];
+					}
+				}
+				input_sequence_insert(&first, &chain, ordered, sequence->count, &variant);
+			}
+			if (!swap)
+				break;
+			swap = (swap - 1) & variant.chord;
+		}
+	}
+
+	// Fold failure links into the transition table in breadth first order, and collect the
+	// variants ending in each state together with those of its failure state
+	unsigned int state_count = (unsigned int)array_size(first);
+	unsigned int* fail = 0;
+	unsigned int* queue = 0;
+	array_resize(fail, state_count);
+	array_resize(queue, state_count);
+	array_resize(input_sequence_output_first, state_count);
+	array_resize(input_sequence_output_count, state_count);
+	array_clear(input_sequence_output);
+	unsigned int head = 0;
+	unsigned int tail = 0;
+	fail[0] = 0;
+	queue[tail++] = 0;
+	while (head < tail) {
+		unsigned int state = queue[head++];
+		unsigned int* row = input_sequence_transition + (state * input_sequence_symbol_count);
+		const unsigned int* fail_row = input_sequence_transition + (fail[state] * input_sequence_symbol_count);
+		for (unsigned int isymbol = 0; isymbol < input_sequence_symbol_count; ++isymbol) {
+			if (row[isymbol] != INPUT_SEQUENCE_NONE) {
+				fail[row[isymbol]] = state ? fail_row[isymbol] : 0;
+				queue[tail++] = row[isymbol];
+			} else {
+				row[isymbol] = state ? fail_row[isymbol] : 0;
+			}
+		}
+
+		input_sequence_output_first[state] = (unsigned int)array_size(input_sequence_output);
+		for (unsigned int variant = first[state]; variant != INPUT_SEQUENCE_NONE; variant = chain[variant])
+			array_push(input_sequence_output, variant);
+		if (state) {
+			unsigned int fail_first = input_sequence_output_first[fail[state]];
+			unsigned int fail_count = input_sequence_output_count[fail[state]];
+			for (unsigned int ioutput = 0; ioutput < fail_count; ++ioutput) {
+				unsigned int variant = input_sequence_output[fail_first + ioutput];
+				array_push(input_sequence_output, variant);
+			}
+		}
+		input_sequence_output_count[state] =
+		    (unsigned int)array_size(input_sequence_output) - input_sequence_output_first[state];
+	}
+
+	array_deallocate(queue);
+	array_deallocate(fail);
+	array_deallocate(chain);
+	array_deallocate(first);
+
+	size_t words = (sequence_count + 63) / 64;
+	array_resize(input_sequence_triggered_live, words);
+	array_resize(input_sequence_triggered_frame, words);
+	if (words) {
+		memset(input_sequence_triggered_live, 0, sizeof(uint64_t) * words);
+		memset(input_sequence_triggered_frame, 0, sizeof(uint64_t) * words);
+	}
+	input_sequence_state = 0;
+	input_sequence_dirty = false;
+}
+
+bool
+input_sequence_add(hash_t sequence, const unsigned int* steps, size_t count, unsigned int window_ms) {
+	if (!count || (count > INPUT_SEQUENCE_MAX_STEPS))
+		return false;
+	for (size_t istep = 0; istep < count; ++istep) {
+		if (input_sequence_code(steps[istep]) >= INPUT_CODE_COUNT)
+			return false;
+	}
+
+	// Posted events are applied by the drain, so drain them before the state machine changes
+	input_event_pump();
+	input_event_lock();
+	unsigned int index = input_sequence_lookup(sequence);
+	bool added = (index == INPUT_SEQUENCE_NONE);
+	if (added) {
+		index = (unsigned int)array_size(input_sequence_source);
+		array_resize(input_sequence_source, index + 1);
+	}
+	input_sequence_t* source = input_sequence_source + index;
+	source->id = sequence;
+	source->count = (unsigned int)count;
+	source->window_ms = window_ms;
+	memcpy(source->step, steps, sizeof(unsigned int) * count);
+	if (added) {
+		// Keep the table at most half full, counting erased keys that still hold a slot
+		if ((index + 1 + input_sequence_erased) * 2 > input_sequence_table_capacity)
+			input_sequence_rehash(((size_t)index + 1) * 4 + 16);
+		else
+			hashtable64_set(input_sequence_table, sequence, index + 1);
+	}
+	input_sequence_modified();
+	input_event_unlock();
+	return true;
+}
+
+void
+input_sequence_remove(hash_t sequence) {
+	input_event_pump();
+	input_event_lock();
+	unsigned int index = input_sequence_lookup(sequence);
+	if (index != INPUT_SEQUENCE_NONE) {
+		// The last sequence is moved to the erased index
+		hashtable64_erase(input_sequence_table, sequence);
+		++input_sequence_erased;
+		array_erase(input_sequence_source, index);
+		if (index < array_size(input_sequence_source))
+			hashtable64_set(input_sequence_table, input_sequence_source[index].id, index + 1);
+		if ((array_size(input_sequence_source) + input_sequence_erased) * 2 > input_sequence_table_capacity)
+			input_sequence_rehash(input_sequence_table_capacity);
+		input_sequence_modified();
+	}
+	input_event_unlock();
+}
+
+static bool
+input_sequence_timing(const input_sequence_variant_t* variant, tick_t timestamp) {
+	const input_sequence_t* sequence = input_sequence_source + variant->sequence;
+	unsigned int start = input_sequence_history_count - variant->length;
+	if (sequence->window_ms) {
+		tick_t window = ((tick_t)sequence->window_ms * time_ticks_per_second()) / 1000;
+		if (timestamp - input_sequence_history[start & (INPUT_SEQUENCE_MAX_STEPS - 1)] > window)
+			return false;
+	}
+	if (variant->chord) {
+		tick_t window = ((tick_t)INPUT_SEQUENCE_CHORD_MS * time_ticks_per_second()) / 1000;
+		for (unsigned int istep = 1; istep < variant->length; ++istep) {
+			if (!(variant->chord & (1U << istep)))
+				continue;
+			tick_t previous = input_sequence_history[(start + istep - 1) & (INPUT_SEQUENCE_MAX_STEPS - 1)];
+			tick_t current = input_sequence_history[(start + istep) & (INPUT_SEQUENCE_MAX_STEPS - 1)];
+			if (current - previous > window)
+				return false;
+		}
+	}
+	return true;
+}
+
+static void
+input_sequence_press(unsigned int code, tick_t timestamp) {
+	unsigned int symbol = input_sequence_symbol[code];
+	if (!symbol)
+		return;
+	input_sequence_history[input_sequence_history_count++ & (INPUT_SEQUENCE_MAX_STEPS - 1)] = timestamp;
+	input_sequence_state =
+	    input_sequence_transition[(input_sequence_state * input_sequence_symbol_count) + (symbol - 1)];
+
+	unsigned int output = input_sequence_output_first[input_sequence_state];
+	unsigned int output_end = output + input_sequence_output_count[input_sequence_state];
+	for (; output < output_end; ++output) {
+		const input_sequence_variant_t* variant = input_sequence_variants + input_sequence_output[output];
+		if (input_sequence_timing(variant, timestamp))
+			input_sequence_triggered_live[variant->sequence >> 6] |= ((uint64_t)1) << (variant->sequence & 63);
+	}
+}
+
+void
+input_sequence_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload) {
+	if (input_sequence_dirty)
+		input_sequence_compile();
+	if (!input_sequence_symbol_count)
+		return;
+	if (id == INPUTEVENT_KEYDOWN) {
+		unsigned int index = input_key_index(payload->key.key);
+		if (index < INPUT_KEY_COUNT)
+			input_sequence_press(index, timestamp);
+	} else if (id == INPUTEVENT_MOUSEDOWN) {
+		for (unsigned int ibutton = 0; ibutton < INPUT_MOUSE_BUTTON_COUNT; ++ibutton) {
+			if (payload->mouse.button & (1U << ibutton))
+				input_sequence_press(INPUT_KEY_COUNT + ibutton, timestamp);
+		}
+	}
+}
+
+void
+input_sequence_snapshot(void) {
+	if (input_sequence_dirty)
+		input_sequence_compile();
+	size_t words = array_size(input_sequence_triggered_live);
+	for (size_t iword = 0; iword < words; ++iword) {
+		input_sequence_triggered_frame[iword] = input_sequence_triggered_live[iword];
+		input_sequence_triggered_live[iword] = 0;
+	}
+}
+
+bool
+input_sequence_triggered(hash_t sequence) {
+	unsigned int index = input_sequence_lookup(sequence);
+	if ((index == INPUT_SEQUENCE_NONE) || (index >= array_size(input_sequence_triggered_frame) * 64))
+		return false;
+	return (input_sequence_triggered_frame[index >> 6] & (((uint64_t)1) << (index & 63))) != 0;
+}
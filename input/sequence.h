@@ -0,0 +1,63 @@
+/* sequence.h  -  Input sequences  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file sequence.h
+    Input sequences and combos. All sequences are compiled into a single state machine
+    driven by key and mouse button presses, so each press is matched against every
+    sequence in a single transition. Presses of keys and buttons not used by any sequence
+    are ignored. Adding and removing sequences is cheap, the state machine is compiled once
+    before the next press is matched. Triggered sequences are snapshotted along with the
+    input state in input_event_process and queries read the latest snapshot. */
+
+#include <input/types.h>
+
+/*! Maximum number of steps in a sequence */
+#define INPUT_SEQUENCE_MAX_STEPS 16
+
+/*! Flag for a step that is a mouse button, see input_mouse_button_id, rather than a key */
+#define INPUT_SEQUENCE_MOUSE 0x40000000U
+
+/*! Flag for a step pressed together with the previous step, in either order and within
+INPUT_SEQUENCE_CHORD_MS milliseconds of it */
+#define INPUT_SEQUENCE_CHORD 0x80000000U
+
+/*! Maximum time in milliseconds between the presses of a chord */
+#define INPUT_SEQUENCE_CHORD_MS 50
+
+/*! Add a sequence. Adding a sequence with an existing identifier replaces it. Events posted
+before the call are matched against the previous set of sequences, and any partially
+matched sequence is reset.
+\param sequence Sequence identifier
+\param steps Key codes of the steps, optionally combined with INPUT_SEQUENCE_MOUSE and
+             INPUT_SEQUENCE_CHORD flags
+\param count Number of steps
+\param window_ms Maximum time in milliseconds from the first to the last press, zero for no limit
+\return true if added, false if steps are invalid */
+INPUT_API bool
+input_sequence_add(hash_t sequence, const unsigned int* steps, size_t count, unsigned int window_ms);
+
+/*! Remove a sequence. Events posted before the call are matched against the previous set
+of sequences, and any partially matched sequence is reset.
+\param sequence Sequence identifier */
+INPUT_API void
+input_sequence_remove(hash_t sequence);
+
+/*! Query if a sequence was completed since the previous snapshot
+\param sequence Sequence identifier
+\return true if sequence was completed, false if not */
+INPUT_API bool
+input_sequence_triggered(hash_t sequence);
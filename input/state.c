@@ -0,0 +1,367 @@
+/* state.c  -  Input state  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/time.h>
+
+/* The live state is updated as events are published, with the event lock held. Along with
+   the current value each bit has a changed bit that is set on every transition, so a key
+   going down and up again between two snapshots is still reported as both pressed and
+   released. Snapshots are taken with the event lock held and compute edges a word at a
+   time from the previous snapshot.
+
+   Each key and mouse button also keeps a short history of its latest transitions, tagged
+   with the event timestamp and the snapshot the transition belongs to. Repeated downs from
+   autorepeat are not transitions and are not recorded. The snapshot copies
+   the history of codes that changed since the previous snapshot, and queries read that copy
+   without the event lock, so they agree with the snapshot state like the other queries. */
+
+#define INPUT_HISTORY_SIZE 4
+#define INPUT_HISTORY_WORDS ((INPUT_CODE_COUNT + 63) / 64)
+
+typedef struct input_state_live_t input_state_live_t;
+
+struct input_state_live_t {
+	uint64_t key_down[INPUT_KEY_WORDS];
+	uint64_t key_changed[INPUT_KEY_WORDS];
+	int mouse_x;
+	int mouse_y;
+	real mouse_dx;
+	real mouse_dy;
+	real mouse_wheel;
+	unsigned int mouse_buttons;
+	unsigned int mouse_changed;
+	unsigned int touches;
+	unsigned int touches_changed;
+	int touch_x[INPUT_TOUCH_MAX];
+	int touch_y[INPUT_TOUCH_MAX];
+};
+
+typedef struct input_history_t input_history_t;
+
+FOUNDATION_ALIGNED_STRUCT(input_history_t, 64) {
+	tick_t timestamp[INPUT_HISTORY_SIZE];
+	unsigned int frame[INPUT_HISTORY_SIZE];
+	uint8_t down[INPUT_HISTORY_SIZE];
+	unsigned int head;
+};
+
+static input_state_live_t input_state_live;
+static input_state_t input_state_frame;
+static input_history_t input_state_history[INPUT_CODE_COUNT];
+static input_history_t input_state_history_frame[INPUT_CODE_COUNT];
+static uint64_t input_state_history_changed[INPUT_HISTORY_WORDS];
+
+void
+input_state_initialize(void) {
+	memset(&input_state_live, 0, sizeof(input_state_live));
+	memset(&input_state_frame, 0, sizeof(input_state_frame));
+	memset(input_state_history, 0, sizeof(input_state_history));
+	memset(input_state_history_frame, 0, sizeof(input_state_history_frame));
+	memset(input_state_history_changed, 0, sizeof(input_state_history_changed));
+}
+
+unsigned int
+input_mouse_code(unsigned int button) {
+	for (unsigned int ibutton = 0; ibutton < INPUT_MOUSE_BUTTON_COUNT; ++ibutton) {
+		if (button & (1U << ibutton))
+			return INPUT_KEY_COUNT + ibutton;
+	}
+	return INPUT_CODE_COUNT;
+}
+
+unsigned int
+input_state_modifiers(void) {
+	static const unsigned int modifier_key[] = {KEY_LSHIFT, KEY_RSHIFT, KEY_LCTRL, KEY_RCTRL,
+	                                            KEY_LALT,   KEY_RALT,   KEY_LMETA, KEY_RMETA};
+	unsigned int modifiers = 0;
+	for (unsigned int ikey = 0; ikey < sizeof(modifier_key) / sizeof(modifier_key[0]); ++ikey) {
+		unsigned int index = input_key_index(modifier_key[ikey]);
+		if (input_state_live.key_down[index >> 6] & (((uint64_t)1) << (index & 63)))
+			modifiers |= 1U << (ikey / 2);
+	}
+	return modifiers;
+}
+
+static void
+input_state_record(unsigned int code, tick_t timestamp, bool down) {
+	input_history_t* history = input_state_history + code;
+	unsigned int head = (history->head + 1) & (INPUT_HISTORY_SIZE - 1);
+	history->timestamp[head] = timestamp;
+	history->frame[head] = input_state_frame.frame + 1;
+	history->down[head] = down ? 1 : 0;
+	history->head = head;
+	input_state_history_changed[code >> 6] |= ((uint64_t)1) << (code & 63);
+}
+
+static void
+input_state_record_buttons(unsigned int buttons, tick_t timestamp, bool down) {
+	for (unsigned int ibutton = 0; ibutton < INPUT_MOUSE_BUTTON_COUNT; ++ibutton) {
+		if (buttons & (1U << ibutton))
+			input_state_record(INPUT_KEY_COUNT + ibutton, timestamp, down);
+	}
+}
+
+void
+input_state_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload) {
+	switch (id) {
+		case INPUTEVENT_KEYDOWN:
+		case INPUTEVENT_KEYUP: {
+			unsigned int index = input_key_index(payload->key.key);
+			if (index >= INPUT_KEY_COUNT)
+				break;
+			// Autorepeat posts key down for a held key, only a change of the down bit is an edge
+			uint64_t bit = ((uint64_t)1) << (index & 63);
+			bool down = (id == INPUTEVENT_KEYDOWN);
+			if (((input_state_live.key_down[index >> 6] & bit) != 0) == down)
+				break;
+			input_state_live.key_down[index >> 6] ^= bit;
+			input_state_live.key_changed[index >> 6] |= bit;
+			input_state_record(index, timestamp, down);
+			break;
+		}
+
+		case INPUTEVENT_MOUSEDOWN: {
+			unsigned int changed = payload->mouse.button & ~input_state_live.mouse_buttons;
+			input_state_live.mouse_changed |= changed;
+			input_state_live.mouse_buttons |= payload->mouse.button;
+			input_state_live.mouse_x = payload->mouse.x;
+			input_state_live.mouse_y = payload->mouse.y;
+			input_state_record_buttons(changed, timestamp, true);
+			break;
+		}
+
+		case INPUTEVENT_MOUSEUP: {
+			unsigned int changed = payload->mouse.button & input_state_live.mouse_buttons;
+			input_state_live.mouse_changed |= changed;
+			input_state_live.mouse_buttons &= ~payload->mouse.button;
+			input_state_live.mouse_x = payload->mouse.x;
+			input_state_live.mouse_y = payload->mouse.y;
+			input_state_record_buttons(changed, timestamp, false);
+			break;
+		}
+
+		case INPUTEVENT_MOUSEMOVE:
+			input_state_live.mouse_x = payload->mouse.x;
+			input_state_live.mouse_y = payload->mouse.y;
+			input_state_live.mouse_dx += payload->mouse.dx;
+			input_state_live.mouse_dy += payload->mouse.dy;
+			input_state_live.mouse_wheel += payload->mouse.dz;
+			break;
+
+		case INPUTEVENT_TOUCHBEGIN:
+		case INPUTEVENT_TOUCHMOVE:
+		case INPUTEVENT_TOUCHEND:
+		case INPUTEVENT_TOUCHCANCEL: {
+			unsigned int touch = payload->touch.touch;
+			if (touch >= INPUT_TOUCH_MAX)
+				break;
+			unsigned int bit = 1U << touch;
+			input_state_live.touch_x[touch] = payload->touch.x;
+			input_state_live.touch_y[touch] = payload->touch.y;
+			if (id == INPUTEVENT_TOUCHBEGIN) {
+				input_state_live.touches |= bit;
+				input_state_live.touches_changed |= bit;
+			} else if (id != INPUTEVENT_TOUCHMOVE) {
+				input_state_live.touches &= ~bit;
+				input_state_live.touches_changed |= bit;
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void
+input_state_snapshot(void) {
+	uint64_t pressed, released;
+	++input_state_frame.frame;
+	input_state_frame.timestamp = time_current();
+	for (unsigned int iword = 0; iword < INPUT_KEY_WORDS; ++iword) {
+		input_bitset_edges(input_state_live.key_down[iword], input_state_frame.key_down[iword],
+		                  input_state_live.key_changed[iword], input_state_frame.key_pressed + iword,
+		                  input_state_frame.key_released + iword);
+		input_state_frame.key_down[iword] = input_state_live.key_down[iword];
+		input_state_live.key_changed[iword] = 0;
+	}
+
+	input_bitset_edges(input_state_live.mouse_buttons, input_state_frame.mouse_buttons, input_state_live.mouse_changed,
+	                  &pressed, &released);
+	input_state_frame.mouse_buttons = input_state_live.mouse_buttons;
+	input_state_frame.mouse_pressed = (unsigned int)pressed;
+	input_state_frame.mouse_released = (unsigned int)released;
+	input_state_live.mouse_changed = 0;
+
+	input_state_frame.mouse_x = input_state_live.mouse_x;
+	input_state_frame.mouse_y = input_state_live.mouse_y;
+	input_state_frame.mouse_dx = input_state_live.mouse_dx;
+	input_state_frame.mouse_dy = input_state_live.mouse_dy;
+	input_state_frame.mouse_wheel = input_state_live.mouse_wheel;
+	input_state_live.mouse_dx = 0;
+	input_state_live.mouse_dy = 0;
+	input_state_live.mouse_wheel = 0;
+
+	input_bitset_edges(input_state_live.touches, input_state_frame.touches, input_state_live.touches_changed, &pressed,
+	                  &released);
+	input_state_frame.touches = input_state_live.touches;
+	input_state_frame.touches_began = (unsigned int)pressed;
+	input_state_frame.touches_ended = (unsigned int)released;
+	input_state_live.touches_changed = 0;
+	memcpy(input_state_frame.touch_x, input_state_live.touch_x, sizeof(input_state_frame.touch_x));
+	memcpy(input_state_frame.touch_y, input_state_live.touch_y, sizeof(input_state_frame.touch_y));
+
+	for (unsigned int iword = 0; iword < INPUT_HISTORY_WORDS; ++iword) {
+		uint64_t changed = input_state_history_changed[iword];
+		for (; changed; changed &= changed - 1) {
+			unsigned int code = (iword * 64) + (unsigned int)__builtin_ctzll(changed);
+			input_state_history_frame[code] = input_state_history[code];
+		}
+		input_state_history_changed[iword] = 0;
+	}
+}
+
+const input_state_t*
+input_state(void) {
+	return &input_state_frame;
+}
+
+static FOUNDATION_FORCEINLINE bool
+input_state_test(const uint64_t* bits, unsigned int key) {
+	unsigned int index = input_key_index(key);
+	if (index >= INPUT_KEY_COUNT)
+		return false;
+	return (bits[index >> 6] & (((uint64_t)1) << (index & 63))) != 0;
+}
+
+bool
+input_key_down(unsigned int key) {
+	return input_state_test(input_state_frame.key_down, key);
+}
+
+bool
+input_key_pressed(unsigned int key) {
+	return input_state_test(input_state_frame.key_pressed, key);
+}
+
+bool
+input_key_released(unsigned int key) {
+	return input_state_test(input_state_frame.key_released, key);
+}
+
+bool
+input_mouse_down(unsigned int buttons) {
+	return (input_state_frame.mouse_buttons & buttons) != 0;
+}
+
+bool
+input_mouse_pressed(unsigned int buttons) {
+	return (input_state_frame.mouse_pressed & buttons) != 0;
+}
+
+bool
+input_mouse_released(unsigned int buttons) {
+	return (input_state_frame.mouse_released & buttons) != 0;
+}
+
+/* Find the latest transition in the given direction in the current snapshot, and no older
+   than the given time and snapshot limits */
+static bool
+input_state_find(unsigned int code, bool down, tick_t since, unsigned int since_frame, tick_t* timestamp) {
+	const input_history_t* history = input_state_history_frame + code;
+	for (unsigned int ientry = 0; ientry < INPUT_HISTORY_SIZE; ++ientry) {
+		unsigned int entry = (history->head - ientry) & (INPUT_HISTORY_SIZE - 1);
+		unsigned int frame = history->frame[entry];
+		if (!frame || (frame < since_frame) || (history->timestamp[entry] < since))
+			break;
+		if (history->down[entry] == (down ? 1 : 0)) {
+			if (timestamp)
+				*timestamp = history->timestamp[entry];
+			return true;
+		}
+	}
+	return false;
+}
+
+static tick_t
+input_state_since(unsigned int ms) {
+	return input_state_frame.timestamp - (((tick_t)ms * time_ticks_per_second()) / 1000);
+}
+
+static unsigned int
+input_state_since_frame(unsigned int frames) {
+	return (frames < input_state_frame.frame) ? (input_state_frame.frame - frames + 1) : 1;
+}
+
+static unsigned int
+input_state_hold_duration(unsigned int code) {
+	tick_t timestamp = 0;
+	if (!input_state_find(code, true, 0, 1, &timestamp))
+		return 0;
+	tick_t held = input_state_frame.timestamp - timestamp;
+	return (held > 0) ? (unsigned int)((held * 1000) / time_ticks_per_second()) : 0;
+}
+
+bool
+input_key_pressed_within(unsigned int key, unsigned int ms) {
+	unsigned int index = input_key_index(key);
+	if (index >= INPUT_KEY_COUNT)
+		return false;
+	return input_state_find(index, true, input_state_since(ms), 1, 0);
+}
+
+bool
+input_key_released_within(unsigned int key, unsigned int ms) {
+	unsigned int index = input_key_index(key);
+	if (index >= INPUT_KEY_COUNT)
+		return false;
+	return input_state_find(index, false, input_state_since(ms), 1, 0);
+}
+
+bool
+input_key_pressed_within_frames(unsigned int key, unsigned int frames) {
+	unsigned int index = input_key_index(key);
+	if ((index >= INPUT_KEY_COUNT) || !frames)
+		return false;
+	return input_state_find(index, true, 0, input_state_since_frame(frames), 0);
+}
+
+unsigned int
+input_key_hold_duration(unsigned int key) {
+	unsigned int index = input_key_index(key);
+	if ((index >= INPUT_KEY_COUNT) || !input_key_down(key))
+		return 0;
+	return input_state_hold_duration(index);
+}
+
+bool
+input_mouse_pressed_within(unsigned int button, unsigned int ms) {
+	unsigned int code = input_mouse_code(button);
+	if (code >= INPUT_CODE_COUNT)
+		return false;
+	return input_state_find(code, true, input_state_since(ms), 1, 0);
+}
+
+unsigned int
+input_mouse_hold_duration(unsigned int button) {
+	unsigned int code = input_mouse_code(button);
+	if ((code >= INPUT_CODE_COUNT) || !input_mouse_down(button))
+		return 0;
+	return input_state_hold_duration(code);
+}
@@ -0,0 +1,120 @@
+/* state.h  -  Input state  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file state.h
+    Polled input state. The library maintains key, mouse and touch state from the events
+    it publishes, and takes a snapshot of it in each call to input_event_process. Queries
+    read the latest snapshot and are stable until the next call to input_event_process,
+    which must be on the same thread as the queries. The latest transitions of each key and
+    mouse button are kept with their timestamps for input buffering queries. */
+
+#include <input/types.h>
+
+/*! Map a key code to an index in the key bitsets
+\param key Key code
+\return Key index, INPUT_KEY_COUNT if key is not tracked */
+static FOUNDATION_FORCEINLINE unsigned int
+input_key_index(unsigned int key) {
+	if (key < (INPUT_KEY_COUNT / 2))
+		return key;
+	if ((key >= KEY_NONASCIIKEYCODE) && (key < KEY_NONASCIIKEYCODE + (INPUT_KEY_COUNT / 2)))
+		return key - KEY_NONASCIIKEYCODE + (INPUT_KEY_COUNT / 2);
+	return INPUT_KEY_COUNT;
+}
+
+/*! Get the latest input state snapshot
+\return Input state */
+INPUT_API const input_state_t*
+input_state(void);
+
+/*! Query if a key is held down
+\param key Key code
+\return true if key is down, false if not */
+INPUT_API bool
+input_key_down(unsigned int key);
+
+/*! Query if a key was pressed since the previous snapshot
+\param key Key code
+\return true if key was pressed, false if not */
+INPUT_API bool
+input_key_pressed(unsigned int key);
+
+/*! Query if a key was released since the previous snapshot
+\param key Key code
+\return true if key was released, false if not */
+INPUT_API bool
+input_key_released(unsigned int key);
+
+/*! Query if any of the given mouse buttons is held down
+\param buttons Mouse button mask, see input_mouse_button_id
+\return true if any button is down, false if not */
+INPUT_API bool
+input_mouse_down(unsigned int buttons);
+
+/*! Query if any of the given mouse buttons was pressed since the previous snapshot
+\param buttons Mouse button mask, see input_mouse_button_id
+\return true if any button was pressed, false if not */
+INPUT_API bool
+input_mouse_pressed(unsigned int buttons);
+
+/*! Query if any of the given mouse buttons was released since the previous snapshot
+\param buttons Mouse button mask, see input_mouse_button_id
+\return true if any button was released, false if not */
+INPUT_API bool
+input_mouse_released(unsigned int buttons);
+
+/*! Query if a key was pressed within the given time before the latest snapshot. Only the
+latest few transitions of each key are kept, so a key tapped rapidly may lose older presses.
+\param key Key code
+\param ms Time window in milliseconds
+\return true if key was pressed within the window, false if not */
+INPUT_API bool
+input_key_pressed_within(unsigned int key, unsigned int ms);
+
+/*! Query if a key was released within the given time before the latest snapshot
+\param key Key code
+\param ms Time window in milliseconds
+\return true if key was released within the window, false if not */
+INPUT_API bool
+input_key_released_within(unsigned int key, unsigned int ms);
+
+/*! Query if a key was pressed within the given number of snapshots, where one means since
+the previous snapshot
+\param key Key code
+\param frames Number of snapshots
+\return true if key was pressed within the window, false if not */
+INPUT_API bool
+input_key_pressed_within_frames(unsigned int key, unsigned int frames);
+
+/*! Get the time a key has been held down as of the latest snapshot
+\param key Key code
+\return Time in milliseconds, zero if key is not down */
+INPUT_API unsigned int
+input_key_hold_duration(unsigned int key);
+
+/*! Query if a mouse button was pressed within the given time before the latest snapshot
+\param button Mouse button, see input_mouse_button_id
+\param ms Time window in milliseconds
+\return true if button was pressed within the window, false if not */
+INPUT_API bool
+input_mouse_pressed_within(unsigned int button, unsigned int ms);
+
+/*! Get the time a mouse button has been held down as of the latest snapshot
+\param button Mouse button, see input_mouse_button_id
+\return Time in milliseconds, zero if button is not down */
+INPUT_API unsigned int
+input_mouse_hold_duration(unsigned int button);
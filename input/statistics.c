@@ -0,0 +1,201 @@
+/* statistics.c  -  Input statistics  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/atomic.h>
+#include <foundation/time.h>
+
+#if FOUNDATION_COMPILER_MSVC
+#include <intrin.h>
+#endif
+
+/* Each posting thread claims a counter block on its first post and is the only writer of
+   it, so counting is a plain load and store without a locked instruction. Blocks are never
+   released, counts from threads that have exited are still part of the totals. Threads
+   beyond the number of blocks share the last block and count with atomic adds. The latency
+   histogram is only written when publishing, with the event lock held. */
+
+#define INPUT_STATISTICS_THREADS 64
+#define INPUT_STATISTICS_SUBBUCKETS 8
+
+#if INPUT_ENABLE_STATISTICS
+
+typedef struct input_statistics_block_t input_statistics_block_t;
+
+FOUNDATION_ALIGNED_STRUCT(input_statistics_block_t, 64) {
+	atomic64_t posted[INPUT_EVENT_ID_MAX];
+};
+
+static input_statistics_block_t input_statistics_blocks[INPUT_STATISTICS_THREADS];
+static atomic32_t input_statistics_block_count;
+static uint64_t input_statistics_published;
+static uint64_t input_statistics_latency_count;
+static uint64_t input_statistics_latency_max;
+static uint64_t input_statistics_latency[INPUT_STATISTICS_BUCKETS];
+static real input_statistics_ns_per_tick;
+
+FOUNDATION_DECLARE_THREAD_LOCAL(input_statistics_block_t*, input_statistics_block, 0)
+
+void
+input_statistics_initialize(void) {
+	// Blocks stay claimed by their threads across module reinitialization
+	int32_t count = atomic_load32(&input_statistics_block_count, memory_order_acquire);
+	if (count > INPUT_STATISTICS_THREADS)
+		count = INPUT_STATISTICS_THREADS;
+	for (int32_t iblock = 0; iblock < count; ++iblock) {
+		for (unsigned int id = 0; id < INPUT_EVENT_ID_MAX; ++id)
+			atomic_store64(&input_statistics_blocks[iblock].posted[id], 0, memory_order_relaxed);
+	}
+	input_statistics_published = 0;
+	input_statistics_latency_count = 0;
+	input_statistics_latency_max = 0;
+	memset(input_statistics_latency, 0, sizeof(input_statistics_latency));
+	input_statistics_ns_per_tick = REAL_C(1000000000.0) / (real)time_ticks_per_second();
+}
+
+static input_statistics_block_t*
+input_statistics_block_claim(void) {
+	int32_t index = atomic_incr32(&input_statistics_block_count, memory_order_acq_rel) - 1;
+	if (index >= INPUT_STATISTICS_THREADS)
+		index = INPUT_STATISTICS_THREADS - 1;
+	input_statistics_block_t* block = input_statistics_blocks + index;
+	set_thread_input_statistics_block(block);
+	return block;
+}
+
+void
+input_statistics_post(unsigned int id, size_t count) {
+	if (id >= INPUT_EVENT_ID_MAX)
+		return;
+	input_statistics_block_t* block = get_thread_input_statistics_block();
+	if (!block)
+		block = input_statistics_block_claim();
+	atomic64_t* counter = block->posted + id;
+	if (block == input_statistics_blocks + (INPUT_STATISTICS_THREADS - 1)) {
+		atomic_add64(counter, (int64_t)count, memory_order_relaxed);
+		return;
+	}
+	atomic_store64(counter, atomic_load64(counter, memory_order_relaxed) + (int64_t)count, memory_order_relaxed);
+}
+
+static unsigned int
+input_statistics_bucket(uint64_t ns) {
+	if (ns < INPUT_STATISTICS_SUBBUCKETS)
+		return (unsigned int)ns;
+#if FOUNDATION_COMPILER_MSVC
+	unsigned long msb;
+	_BitScanReverse64(&msb, ns);
+	unsigned int exponent = (unsigned int)msb;
+#else
+	unsigned int exponent = 63U - (unsigned int)__builtin_clzll(ns);
+#endif
+	unsigned int bucket = ((exponent - 2) * INPUT_STATISTICS_SUBBUCKETS) +
+	                      (unsigned int)((ns >> (exponent - 3)) & (INPUT_STATISTICS_SUBBUCKETS - 1));
+	return (bucket < INPUT_STATISTICS_BUCKETS) ? bucket : INPUT_STATISTICS_BUCKETS - 1;
+}
+
+void
+input_statistics_publish(tick_t timestamp, tick_t now) {
+	++input_statistics_published;
+	uint64_t ns = 0;
+	if (now > timestamp)
+		ns = (uint64_t)((real)(now - timestamp) * input_statistics_ns_per_tick);
+	++input_statistics_latency[input_statistics_bucket(ns)];
+	++input_statistics_latency_count;
+	if (ns > input_statistics_latency_max)
+		input_statistics_latency_max = ns;
+}
+
+void
+input_statistics(input_statistics_t* statistics) {
+	memset(statistics, 0, sizeof(input_statistics_t));
+	int32_t count = atomic_load32(&input_statistics_block_count, memory_order_acquire);
+	if (count > INPUT_STATISTICS_THREADS)
+		count = INPUT_STATISTICS_THREADS;
+	for (int32_t iblock = 0; iblock < count; ++iblock) {
+		for (unsigned int id = 0; id < INPUT_EVENT_ID_MAX; ++id)
+			statistics->posted[id] +=
+			    (uint64_t)atomic_load64(&input_statistics_blocks[iblock].posted[id], memory_order_relaxed);
+	}
+
+	input_queue_statistics_t queue = input_event_queue_statistics();
+	statistics->dropped = queue.dropped;
+	statistics->coalesced = queue.coalesced;
+	statistics->overflowed = queue.overflowed;
+	statistics->queue_high_water = queue.high_water;
+
+	input_event_lock();
+	statistics->queue_depth = input_event_queue_depth();
+	statistics->published = input_statistics_published;
+	statistics->latency_count = input_statistics_latency_count;
+	statistics->latency_max = input_statistics_latency_max;
+	memcpy(statistics->latency, input_statistics_latency, sizeof(input_statistics_latency));
+	input_event_unlock();
+}
+
+#else
+
+void
+input_statistics_initialize(void) {
+}
+
+void
+input_statistics_post(unsigned int id, size_t count) {
+	FOUNDATION_UNUSED(id, count);
+}
+
+void
+input_statistics_publish(tick_t timestamp, tick_t now) {
+	FOUNDATION_UNUSED(timestamp, now);
+}
+
+void
+input_statistics(input_statistics_t* statistics) {
+	memset(statistics, 0, sizeof(input_statistics_t));
+}
+
+#endif
+
+uint64_t
+input_statistics_bucket_limit(unsigned int bucket) {
+	if (bucket < INPUT_STATISTICS_SUBBUCKETS)
+		return bucket;
+	if (bucket >= INPUT_STATISTICS_BUCKETS - 1)
+		return UINT64_MAX;
+	unsigned int exponent = (bucket / INPUT_STATISTICS_SUBBUCKETS) + 2;
+	uint64_t base = (uint64_t)(INPUT_STATISTICS_SUBBUCKETS + (bucket % INPUT_STATISTICS_SUBBUCKETS));
+	return ((base + 1) << (exponent - 3)) - 1;
+}
+
+uint64_t
+input_statistics_latency_percentile(const input_statistics_t* statistics, real percentile) {
+	if (!statistics->latency_count)
+		return 0;
+	uint64_t rank = (uint64_t)(((real)statistics->latency_count * percentile) / REAL_C(100.0));
+	if (rank >= statistics->latency_count)
+		rank = statistics->latency_count - 1;
+	uint64_t seen = 0;
+	for (unsigned int bucket = 0; bucket < INPUT_STATISTICS_BUCKETS; ++bucket) {
+		seen += statistics->latency[bucket];
+		if (seen > rank) {
+			uint64_t limit = input_statistics_bucket_limit(bucket);
+			return (limit < statistics->latency_max) ? limit : statistics->latency_max;
+		}
+	}
+	return statistics->latency_max;
+}
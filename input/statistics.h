@@ -0,0 +1,44 @@
+/* statistics.h  -  Input statistics  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file statistics.h
+    Input pipeline statistics. Posted events are counted per event id in counters owned by
+    the posting thread, so posting never contends on a shared cache line. The time from the
+    event timestamp until the event is published to consumers is recorded in a log-linear
+    histogram with eight buckets per power of two nanoseconds. Statistics are maintained
+    when the library is built with INPUT_ENABLE_STATISTICS, which is the default. */
+
+#include <input/types.h>
+
+/*! Get a snapshot of the input statistics
+\param statistics Statistics to fill */
+INPUT_API void
+input_statistics(input_statistics_t* statistics);
+
+/*! Get the largest latency in nanoseconds counted in a histogram bucket
+\param bucket Bucket index
+\return Upper limit of bucket in nanoseconds */
+INPUT_API uint64_t
+input_statistics_bucket_limit(unsigned int bucket);
+
+/*! Get a latency percentile from a statistics snapshot
+\param statistics Statistics snapshot
+\param percentile Percentile in range [0,100]
+\return Upper limit in nanoseconds of the histogram bucket containing the percentile,
+        zero if there are no latency samples */
+INPUT_API uint64_t
+input_statistics_latency_percentile(const input_statistics_t* statistics, real percentile);
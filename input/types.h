@@ -42,6 +42,35 @@
 #endif
 #endif
 
+/*! Number of key codes tracked in the input state. Key codes below 0x200 and key codes
+from KEY_NONASCIIKEYCODE up to KEY_NONASCIIKEYCODE + 0x1ff are tracked */
+#define INPUT_KEY_COUNT 1024
+
+/*! Number of 64-bit words in a key bitset */
+#define INPUT_KEY_WORDS (INPUT_KEY_COUNT / 64)
+
+/*! Number of touches tracked in the input state */
+#define INPUT_TOUCH_MAX 16
+
+/*! Time window in milliseconds of the samples used to estimate pointer and touch velocity */
+#define INPUT_VELOCITY_HORIZON_MS 100
+
+/*! Pause in milliseconds after which a pointer or touch is assumed to have stopped */
+#define INPUT_VELOCITY_STOP_MS 40
+
+/*! Number of gamepads and joysticks tracked in the input state */
+#define INPUT_PAD_MAX 16
+
+/*! Number of event ids counted in input statistics, event ids must be below this limit */
+#define INPUT_EVENT_ID_MAX 64
+
+/*! Number of buckets in the latency histogram of input statistics, see statistics.h */
+#define INPUT_STATISTICS_BUCKETS 256
+
+/*! Maximum number of UTF-8 bytes in a text event. Longer text is split in several events at
+code point boundaries */
+#define INPUT_TEXT_MAX 24
+
 typedef enum input_event_id {
 	INPUTEVENT_KEYDOWN = 1,
 	INPUTEVENT_KEYUP,
@@ -54,9 +83,36 @@ typedef enum input_event_id {
 	INPUTEVENT_TOUCHCANCEL,
 	INPUTEVENT_TOUCHMOVE,
 	INPUTEVENT_TOUCHSWIPE,
-	INPUTEVENT_ACCELERATION
+	INPUTEVENT_ACCELERATION,
+	INPUTEVENT_GESTURETAP,
+	INPUTEVENT_GESTUREDOUBLETAP,
+	INPUTEVENT_GESTURELONGPRESS,
+	INPUTEVENT_GESTURESWIPE,
+	INPUTEVENT_GESTUREPINCH,
+	INPUTEVENT_GESTUREROTATE,
+	INPUTEVENT_PADCONNECT,
+	INPUTEVENT_PADDISCONNECT,
+	INPUTEVENT_PADBUTTONDOWN,
+	INPUTEVENT_PADBUTTONUP,
+	INPUTEVENT_TEXT,
+	/*! Angular velocity from a gyroscope in radians per second, with an acceleration payload */
+	INPUTEVENT_ROTATION
 } input_event_id;
 
+typedef enum input_overflow_policy {
+	/*! Keep the events in a growing overflow buffer until the next drain */
+	INPUTOVERFLOW_GROW = 0,
+	/*! Drop the oldest queued continuous events to make room, keeping discrete events. At most
+	as many discrete events as the ring holds are kept aside, beyond that the oldest discrete
+	events are dropped too */
+	INPUTOVERFLOW_DROP_OLDEST,
+	/*! Drop the event being posted */
+	INPUTOVERFLOW_DROP_NEWEST,
+	/*! Block the posting thread until the consumer drains the queue. Events posted on the
+	thread draining the queue go to the overflow buffer as with INPUTOVERFLOW_GROW */
+	INPUTOVERFLOW_BLOCK
+} input_overflow_policy;
+
 typedef enum input_mouse_button_id {
 	MOUSEBUTTON_LEFT = 0x01,
 	MOUSEBUTTON_RIGHT = 0x02,
@@ -68,6 +124,91 @@ typedef enum input_mouse_button_id {
 	MOUSEBUTTON_7 = 0x80
 } input_mouse_button_id;
 
+/*! Gamepad buttons. Face buttons are named by position, south is A on an Xbox layout and
+cross on a PlayStation layout */
+typedef enum input_pad_button_id {
+	PADBUTTON_SOUTH = 0x00001,
+	PADBUTTON_EAST = 0x00002,
+	PADBUTTON_WEST = 0x00004,
+	PADBUTTON_NORTH = 0x00008,
+	PADBUTTON_LSHOULDER = 0x00010,
+	PADBUTTON_RSHOULDER = 0x00020,
+	PADBUTTON_LTRIGGER = 0x00040,
+	PADBUTTON_RTRIGGER = 0x00080,
+	PADBUTTON_BACK = 0x00100,
+	PADBUTTON_START = 0x00200,
+	PADBUTTON_GUIDE = 0x00400,
+	PADBUTTON_LSTICK = 0x00800,
+	PADBUTTON_RSTICK = 0x01000,
+	PADBUTTON_DPAD_UP = 0x02000,
+	PADBUTTON_DPAD_DOWN = 0x04000,
+	PADBUTTON_DPAD_LEFT = 0x08000,
+	PADBUTTON_DPAD_RIGHT = 0x10000,
+	/*! First joystick button, joystick buttons are mapped to consecutive bits up to bit 31 */
+	PADBUTTON_JOYSTICK = 0x20000
+} input_pad_button_id;
+
+typedef enum input_pad_axis_id {
+	/*! Left stick x axis in range [-1,1] */
+	PADAXIS_LEFT_X = 0,
+	/*! Left stick y axis in range [-1,1], positive down */
+	PADAXIS_LEFT_Y,
+	/*! Right stick x axis in range [-1,1] */
+	PADAXIS_RIGHT_X,
+	/*! Right stick y axis in range [-1,1], positive down */
+	PADAXIS_RIGHT_Y,
+	/*! Left trigger in range [0,1] */
+	PADAXIS_LEFT_TRIGGER,
+	/*! Right trigger in range [0,1] */
+	PADAXIS_RIGHT_TRIGGER,
+
+	PADAXIS_COUNT
+} input_pad_axis_id;
+
+/*! Analog channels of the conditioning stage, see condition.h. Pad axes follow the other
+channels, axis a of pad p is channel INPUTCHANNEL_PAD + (p * PADAXIS_COUNT) + a */
+typedef enum input_channel_id {
+	/*! Latest acceleration sample */
+	INPUTCHANNEL_ACCELERATION_X = 0,
+	INPUTCHANNEL_ACCELERATION_Y,
+	INPUTCHANNEL_ACCELERATION_Z,
+	/*! Latest angular velocity sample */
+	INPUTCHANNEL_ROTATION_X,
+	INPUTCHANNEL_ROTATION_Y,
+	INPUTCHANNEL_ROTATION_Z,
+	/*! Mouse movement accumulated since the previous snapshot */
+	INPUTCHANNEL_MOUSE_DX,
+	INPUTCHANNEL_MOUSE_DY,
+	/*! Mouse wheel movement accumulated since the previous snapshot */
+	INPUTCHANNEL_MOUSE_WHEEL,
+	/*! First pad axis */
+	INPUTCHANNEL_PAD,
+
+	INPUTCHANNEL_COUNT = INPUTCHANNEL_PAD + (INPUT_PAD_MAX * PADAXIS_COUNT)
+} input_channel_id;
+
+typedef enum input_key_modifier_id {
+	KEYMODIFIER_SHIFT = 0x01,
+	KEYMODIFIER_CTRL = 0x02,
+	KEYMODIFIER_ALT = 0x04,
+	KEYMODIFIER_META = 0x08
+} input_key_modifier_id;
+
+typedef enum input_axis_id {
+	/*! Mouse movement along x axis */
+	INPUTAXIS_MOUSE_X = 0,
+	/*! Mouse movement along y axis */
+	INPUTAXIS_MOUSE_Y,
+	/*! Mouse wheel movement */
+	INPUTAXIS_MOUSE_WHEEL,
+	/*! Touch movement along x axis */
+	INPUTAXIS_TOUCH_X,
+	/*! Touch movement along y axis */
+	INPUTAXIS_TOUCH_Y,
+
+	INPUTAXIS_COUNT
+} input_axis_id;
+
 typedef enum input_key_id {
 	KEY_SPACE = 32,
 	KEY_EXCLAMATION = 33,
@@ -257,14 +398,94 @@ typedef enum input_key_id {
 	KEY_LASTRESERVEDKEYCODE = 0x1ffff
 } input_key_id;
 
+typedef enum input_loadgen_workload {
+	/*! Mouse moves along a closed curve */
+	INPUTLOADGEN_MOUSE_MOTION = 0,
+	/*! Touches that begin, move along parallel strokes and end every quarter second */
+	INPUTLOADGEN_TOUCH_STORM,
+	/*! Bursts of keys pressed in order and released in reverse order */
+	INPUTLOADGEN_KEY_ROLLOVER,
+	/*! Acceleration samples of a slowly rotating gravity vector */
+	INPUTLOADGEN_ACCELERATION
+} input_loadgen_workload;
+
 typedef struct input_config_t input_config_t;
 typedef struct input_mouse_event_t input_mouse_event_t;
 typedef struct input_touch_event_t input_touch_event_t;
 typedef struct input_key_event_t input_key_event_t;
 typedef struct input_acceleration_event_t input_acceleration_event_t;
+typedef struct input_gesture_event_t input_gesture_event_t;
+typedef struct input_pad_event_t input_pad_event_t;
+typedef struct input_text_event_t input_text_event_t;
+typedef struct input_pad_state_t input_pad_state_t;
+typedef struct input_condition_t input_condition_t;
+typedef struct input_event_t input_event_t;
+typedef struct input_consumer_t input_consumer_t;
+typedef struct input_replay_t input_replay_t;
+typedef struct input_loadgen_t input_loadgen_t;
+typedef struct input_queue_statistics_t input_queue_statistics_t;
+typedef struct input_state_t input_state_t;
+typedef struct input_statistics_t input_statistics_t;
+typedef struct input_key_compact_t input_key_compact_t;
+typedef struct input_mouse_compact_t input_mouse_compact_t;
+typedef struct input_touch_compact_t input_touch_compact_t;
+typedef struct input_acceleration_compact_t input_acceleration_compact_t;
 
 struct input_config_t {
-	unsigned int unused;
+	/*! Initial capacity of the event stream in number of events, zero for default (1024) */
+	size_t event_stream_size;
+	/*! Number of slots in the lock-free event ring holding posted events until the next drain,
+	rounded up to a power of two. Zero for the size of the event stream */
+	size_t event_ring_size;
+	/*! Post events to the event stream in the compact encoding, where each event id has an
+	exact size packed record. Use input_event_decode to read payloads in either encoding */
+	bool event_compact;
+	/*! Coalesce runs of continuous events between discrete events. Consecutive mouse moves are
+	merged by summing deltas and keeping the latest position and buttons, touch moves are merged
+	per touch id the same way and acceleration samples are averaged. Events are never reordered
+	across discrete events such as button and key transitions */
+	bool event_coalesce;
+	/*! Policy when the event ring is full */
+	input_overflow_policy event_overflow;
+	/*! Number of events in the broadcast ring, zero to disable broadcast. When enabled, events
+	are published to the broadcast ring and read through input_consumer_t consumers instead of
+	the input event stream */
+	size_t event_broadcast_size;
+	/*! Recognize gestures from touch events and post gesture events, see gesture.h */
+	bool event_gestures;
+	/*! Post text input as INPUTEVENT_TEXT events carrying runs of UTF-8 text instead of one
+	INPUTEVENT_CHAR event per code point, see input_event_post_text */
+	bool event_text_runs;
+	/*! Maximum number of actions that can be bound, zero for default (1024) */
+	size_t action_capacity;
+	/*! Number of slots in the ring holding posted events until the recording thread writes
+	them, zero for default (4096). Events posted while the ring is full are not recorded */
+	size_t record_ring_size;
+	/*! Read keyboard and mouse input directly from the evdev device nodes in /dev/input on
+	Linux, see evdev.h. Requires read access to the device nodes. Window events should not be
+	passed to input_event_handle_window at the same time, or input is posted twice */
+	bool evdev;
+	/*! Open gamepads and joysticks, see pad.h. On Linux pads are read from the evdev device
+	nodes in /dev/input and require read access to the device nodes */
+	bool gamepads;
+	/*! Read native input on a dedicated input thread instead of in input_event_process. On
+	Linux the thread waits on the evdev devices and translates and posts their events as they
+	arrive, so input latency does not depend on the frame time of the main loop. Window system
+	input is still translated by input_event_handle_window on the thread handling window events */
+	bool thread;
+	/*! Mask of the CPU cores the input thread may run on, zero for no restriction */
+	uint64_t thread_affinity;
+	/*! Real-time priority of the input thread, zero for normal scheduling. On Linux this is the
+	SCHED_FIFO priority in [1,99], which requires CAP_SYS_NICE or an RLIMIT_RTPRIO limit. If the
+	priority cannot be set the thread runs with normal scheduling. With a priority set the event
+	lock and waits on a full event ring block in the scheduler instead of spinning */
+	int thread_priority;
+	/*! Read accelerometers and gyroscopes from the IIO devices in /sys/bus/iio/devices on
+	Linux, see iio.h. Requires write access to the device attributes in sysfs and read access
+	to the /dev/iio:device nodes */
+	bool sensors;
+	/*! Sampling rate of sensors in Hz, zero to keep the rate of the device */
+	unsigned int sensor_rate;
 };
 
 struct input_mouse_event_t {
@@ -299,9 +520,218 @@ struct input_acceleration_event_t {
 	real z;
 };
 
+/*! Gesture event payload, see gesture.h */
+struct input_gesture_event_t {
+	/*! Position of the gesture, the centroid for gestures with two touches */
+	int x;
+	/*! Position of the gesture, the centroid for gestures with two touches */
+	int y;
+	/*! Swipe displacement from the first touch position */
+	real dx;
+	/*! Swipe displacement from the first touch position */
+	real dy;
+	/*! Gesture value. Swipe velocity in pixels per second, pinch scale relative to the initial
+	touch distance, rotation angle in radians relative to the initial touch angle, or the
+	long press duration in seconds */
+	real value;
+	/*! Bit mask of touches in the gesture */
+	unsigned int touches;
+};
+
+/*! Gamepad event payload, see pad.h */
+struct input_pad_event_t {
+	/*! Pad index */
+	unsigned int pad;
+	/*! Button that changed, see input_pad_button_id, zero for connection events */
+	unsigned int button;
+	/*! Buttons held down after the event */
+	unsigned int buttons;
+};
+
+/*! Text event payload, see input_event_post_text */
+struct input_text_event_t {
+	/*! Number of bytes of text */
+	unsigned int length;
+	/*! UTF-8 text, not zero terminated. Never ends in the middle of a code point */
+	char text[INPUT_TEXT_MAX];
+};
+
 typedef union input_event_payload_t {
 	input_mouse_event_t mouse;
 	input_touch_event_t touch;
 	input_key_event_t key;
 	input_acceleration_event_t acceleration;
+	input_gesture_event_t gesture;
+	input_pad_event_t pad;
+	input_text_event_t text;
 } input_event_payload_t;
+
+/*! Input event as held in the event ring and the broadcast ring */
+struct input_event_t {
+	/*! Event id, one of input_event_id */
+	unsigned int id;
+	/*! Size of payload in bytes, zero for events without payload */
+	unsigned int size;
+	/*! Timestamp of the event */
+	tick_t timestamp;
+	/*! Event payload */
+	input_event_payload_t payload;
+};
+
+/*! Event queue counters, see input_event_queue_statistics */
+struct input_queue_statistics_t {
+	/*! Number of events the event ring holds before the overflow policy applies */
+	size_t capacity;
+	/*! Largest number of events posted between two drains of the event queue */
+	size_t high_water;
+	/*! Number of events dropped by the overflow policy or discarded on a full broadcast ring */
+	uint64_t dropped;
+	/*! Number of events merged into another event by coalescing */
+	uint64_t coalesced;
+	/*! Number of events that went to the overflow buffer with INPUTOVERFLOW_GROW, or with
+	INPUTOVERFLOW_BLOCK when posted on the thread draining the queue */
+	uint64_t overflowed;
+};
+
+/*! Input pipeline statistics, see input_statistics. Counters are accumulated since the
+input module was initialized, subtract two snapshots to get the counts for an interval */
+struct input_statistics_t {
+	/*! Number of events posted per event id */
+	uint64_t posted[INPUT_EVENT_ID_MAX];
+	/*! Number of events published to the event stream or broadcast ring, including events
+	derived from posted events */
+	uint64_t published;
+	/*! Number of events dropped by the overflow policy or discarded on a full broadcast ring */
+	uint64_t dropped;
+	/*! Number of events merged into another event by coalescing */
+	uint64_t coalesced;
+	/*! Number of events that went to the overflow buffer */
+	uint64_t overflowed;
+	/*! Number of events currently in the event ring */
+	size_t queue_depth;
+	/*! Largest number of events posted between two drains of the event queue */
+	size_t queue_high_water;
+	/*! Number of latency samples, one per published event */
+	uint64_t latency_count;
+	/*! Largest latency in nanoseconds */
+	uint64_t latency_max;
+	/*! Log-linear histogram of latency in nanoseconds from event timestamp to publish, see
+	input_statistics_bucket_limit for bucket ranges */
+	uint64_t latency[INPUT_STATISTICS_BUCKETS];
+};
+
+/*! Input state snapshot taken by input_event_process. Key bitsets are indexed by
+input_key_index, edges are relative to the previous snapshot. A key pressed and released
+between two snapshots is both pressed and released but not down */
+struct input_state_t {
+	/*! Snapshot number, incremented by each call to input_event_process */
+	unsigned int frame;
+	/*! Time the snapshot was taken */
+	tick_t timestamp;
+	/*! Keys held down */
+	uint64_t key_down[INPUT_KEY_WORDS];
+	/*! Keys pressed since the previous snapshot */
+	uint64_t key_pressed[INPUT_KEY_WORDS];
+	/*! Keys released since the previous snapshot */
+	uint64_t key_released[INPUT_KEY_WORDS];
+	/*! Mouse position */
+	int mouse_x;
+	/*! Mouse position */
+	int mouse_y;
+	/*! Mouse movement accumulated since the previous snapshot */
+	real mouse_dx;
+	/*! Mouse movement accumulated since the previous snapshot */
+	real mouse_dy;
+	/*! Mouse wheel movement accumulated since the previous snapshot */
+	real mouse_wheel;
+	/*! Mouse buttons held down, see input_mouse_button_id */
+	unsigned int mouse_buttons;
+	/*! Mouse buttons pressed since the previous snapshot */
+	unsigned int mouse_pressed;
+	/*! Mouse buttons released since the previous snapshot */
+	unsigned int mouse_released;
+	/*! Bit mask of active touches */
+	unsigned int touches;
+	/*! Bit mask of touches that began since the previous snapshot */
+	unsigned int touches_began;
+	/*! Bit mask of touches that ended since the previous snapshot */
+	unsigned int touches_ended;
+	/*! Touch positions */
+	int touch_x[INPUT_TOUCH_MAX];
+	/*! Touch positions */
+	int touch_y[INPUT_TOUCH_MAX];
+};
+
+/*! Gamepad state snapshot taken by input_event_process, edges are relative to the previous
+snapshot */
+struct input_pad_state_t {
+	/*! Pad is connected */
+	bool connected;
+	/*! Time of the latest update from the device */
+	tick_t timestamp;
+	/*! Buttons held down, see input_pad_button_id */
+	unsigned int buttons;
+	/*! Buttons pressed since the previous snapshot */
+	unsigned int pressed;
+	/*! Buttons released since the previous snapshot */
+	unsigned int released;
+	/*! Axis values, see input_pad_axis_id */
+	real axis[PADAXIS_COUNT];
+};
+
+/*! Conditioning of an analog channel, see condition.h. A zero initialized condition passes
+values through unchanged */
+struct input_condition_t {
+	/*! Magnitude of full deflection, zero for one. Dead zone and response curve apply to the
+	value normalized by the range */
+	real range;
+	/*! Normalized magnitude below which the value is zero. The rest of the range is stretched
+	so full deflection is still reached */
+	real deadzone;
+	/*! Response curve, blends from linear at zero to cubic at one for finer control near
+	the center */
+	real curve;
+	/*! Scale of the output, zero for one */
+	real scale;
+	/*! Smoothing cutoff frequency in Hz, zero disables smoothing */
+	real cutoff;
+	/*! Increase of the cutoff frequency per unit of output speed, One Euro filtering which
+	trades smoothing for lag when the value moves fast. Zero for exponential smoothing */
+	real beta;
+};
+
+/*! Compact record for key and char events. Scancode and flags are truncated to 16 bits */
+struct input_key_compact_t {
+	uint32_t key;
+	uint16_t scancode;
+	uint16_t flags;
+};
+
+/*! Compact record for mouse events. Coordinates are saturated to 16 bits */
+struct input_mouse_compact_t {
+	int16_t x;
+	int16_t y;
+	float32_t dx;
+	float32_t dy;
+	float32_t dz;
+	uint8_t button;
+	uint8_t buttons;
+};
+
+/*! Compact record for touch events. Coordinates are saturated to 16 bits */
+struct input_touch_compact_t {
+	int16_t x;
+	int16_t y;
+	float32_t dx;
+	float32_t dy;
+	float32_t velocity;
+	uint16_t touch;
+	uint16_t touches;
+};
+
+/*! Compact record for acceleration events */
+struct input_acceleration_compact_t {
+	float32_t x;
+	float32_t y;
+	float32_t z;
+};
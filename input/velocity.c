@@ -0,0 +1,162 @@
+/* velocity.c  -  Pointer and touch velocity  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any
+ * restrictions.
+ *
+ */
+
+#include <input/input.h>
+#include <input/internal.h>
+
+#include <foundation/math.h>
+#include <foundation/time.h>
+
+/* Each tracker is a ring of the latest samples, written when events are published with the
+   event lock held. The fit runs over at most INPUT_VELOCITY_SAMPLES samples, so the cost per
+   sample is bounded. Sums are accumulated in double precision with time relative to the
+   newest sample, as tick timestamps lose precision in a float real. */
+
+#define INPUT_VELOCITY_SAMPLES 16
+
+typedef struct input_velocity_tracker_t input_velocity_tracker_t;
+
+struct input_velocity_tracker_t {
+	unsigned int head;
+	unsigned int count;
+	tick_t time[INPUT_VELOCITY_SAMPLES];
+	int x[INPUT_VELOCITY_SAMPLES];
+	int y[INPUT_VELOCITY_SAMPLES];
+};
+
+static input_velocity_tracker_t input_velocity_mouse_tracker;
+static input_velocity_tracker_t input_velocity_touch_tracker[INPUT_TOUCH_MAX];
+
+void
+input_velocity_initialize(void) {
+	memset(&input_velocity_mouse_tracker, 0, sizeof(input_velocity_mouse_tracker));
+	memset(input_velocity_touch_tracker, 0, sizeof(input_velocity_touch_tracker));
+}
+
+static tick_t
+input_velocity_newest(const input_velocity_tracker_t* tracker) {
+	return tracker->time[(tracker->head + INPUT_VELOCITY_SAMPLES - 1) % INPUT_VELOCITY_SAMPLES];
+}
+
+static void
+input_velocity_add(input_velocity_tracker_t* tracker, tick_t timestamp, int x, int y) {
+	tick_t stop = (time_ticks_per_second() * INPUT_VELOCITY_STOP_MS) / 1000;
+	if (tracker->count && ((timestamp - input_velocity_newest(tracker)) > stop))
+		tracker->count = 0;
+	tracker->time[tracker->head] = timestamp;
+	tracker->x[tracker->head] = x;
+	tracker->y[tracker->head] = y;
+	tracker->head = (tracker->head + 1) % INPUT_VELOCITY_SAMPLES;
+	if (tracker->count < INPUT_VELOCITY_SAMPLES)
+		++tracker->count;
+}
+
+static bool
+input_velocity_estimate(const input_velocity_tracker_t* tracker, real* vx, real* vy) {
+	*vx = 0;
+	*vy = 0;
+	if (tracker->count < 2)
+		return false;
+
+	tick_t newest = input_velocity_newest(tracker);
+	tick_t horizon = (time_ticks_per_second() * INPUT_VELOCITY_HORIZON_MS) / 1000;
+	double seconds_per_tick = 1.0 / (double)time_ticks_per_second();
+	double n = 0, st = 0, stt = 0, sx = 0, stx = 0, sy = 0, sty = 0;
+	for (unsigned int isample = 0; isample < tracker->count; ++isample) {
+		unsigned int index = (tracker->head + INPUT_VELOCITY_SAMPLES - 1 - isample) % INPUT_VELOCITY_SAMPLES;
+		if ((newest - tracker->time[index]) > horizon)
+			break;
+		double t = (double)(tracker->time[index] - newest) * seconds_per_tick;
+		double x = (double)tracker->x[index];
+		double y = (double)tracker->y[index];
+		n += 1.0;
+		st += t;
+		stt += t * t;
+		sx += x;
+		stx += t * x;
+		sy += y;
+		sty += t * y;
+	}
+	double denominator = (n * stt) - (st * st);
+	if ((n < 2.0) || (denominator <= 0))
+		return false;
+	*vx = (real)(((n * stx) - (st * sx)) / denominator);
+	*vy = (real)(((n * sty) - (st * sy)) / denominator);
+	return true;
+}
+
+bool
+input_velocity_apply(unsigned int id, tick_t timestamp, const input_event_payload_t* payload,
+                     input_event_payload_t* tracked) {
+	switch (id) {
+		case INPUTEVENT_MOUSEDOWN:
+		case INPUTEVENT_MOUSEUP:
+		case INPUTEVENT_MOUSEMOVE:
+			input_velocity_add(&input_velocity_mouse_tracker, timestamp, payload->mouse.x, payload->mouse.y);
+			return false;
+
+		case INPUTEVENT_TOUCHBEGIN:
+		case INPUTEVENT_TOUCHMOVE:
+		case INPUTEVENT_TOUCHEND: {
+			unsigned int touch = payload->touch.touch;
+			if (touch >= INPUT_TOUCH_MAX)
+				return false;
+			input_velocity_tracker_t* tracker = input_velocity_touch_tracker + touch;
+			if (id == INPUTEVENT_TOUCHBEGIN)
+				tracker->count = 0;
+			input_velocity_add(tracker, timestamp, payload->touch.x, payload->touch.y);
+			if (id == INPUTEVENT_TOUCHBEGIN)
+				return false;
+			real vx, vy;
+			if (!input_velocity_estimate(tracker, &vx, &vy))
+				return false;
+			*tracked = *payload;
+			tracked->touch.velocity = math_sqrt((vx * vx) + (vy * vy));
+			return true;
+		}
+
+		default:
+			break;
+	}
+	return false;
+}
+
+bool
+input_velocity_mouse(real* vx, real* vy) {
+	tick_t horizon = (time_ticks_per_second() * INPUT_VELOCITY_HORIZON_MS) / 1000;
+	input_event_lock();
+	bool estimated = input_velocity_estimate(&input_velocity_mouse_tracker, vx, vy);
+	if (estimated && ((time_current() - input_velocity_newest(&input_velocity_mouse_tracker)) > horizon)) {
+		*vx = 0;
+		*vy = 0;
+		estimated = false;
+	}
+	input_event_unlock();
+	return estimated;
+}
+
+bool
+input_velocity_touch(unsigned int touch, real* vx, real* vy) {
+	if (touch >= INPUT_TOUCH_MAX) {
+		*vx = 0;
+		*vy = 0;
+		return false;
+	}
+	input_event_lock();
+	bool estimated = input_velocity_estimate(input_velocity_touch_tracker + touch, vx, vy);
+	input_event_unlock();
+	return estimated;
+}
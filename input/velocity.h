@@ -0,0 +1,43 @@
+/* velocity.h  -  Pointer and touch velocity  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file velocity.h
+    Pointer and touch velocity. Positions of published mouse and touch events are kept with
+    their timestamps, and velocity is estimated by a least squares linear fit of the position
+    over the samples of the last INPUT_VELOCITY_HORIZON_MS milliseconds. Samples older than a
+    pause of more than INPUT_VELOCITY_STOP_MS milliseconds are discarded, as the pointer is
+    assumed to have stopped. The estimated speed replaces the velocity of touch move and touch
+    end events once the touch has two samples. Velocity is in coordinate units per second. */
+
+#include <input/types.h>
+
+/*! Get the current mouse velocity
+\param vx Velocity x component
+\param vy Velocity y component
+\return true if estimated, false and zero velocity if the mouse has not moved in the last
+        INPUT_VELOCITY_HORIZON_MS milliseconds */
+INPUT_API bool
+input_velocity_mouse(real* vx, real* vy);
+
+/*! Get the velocity of a touch. After the touch ended this is the velocity it was released
+with until the touch slot begins a new touch
+\param touch Touch slot
+\param vx Velocity x component
+\param vy Velocity y component
+\return true if estimated, false and zero velocity if the touch has fewer than two samples */
+INPUT_API bool
+input_velocity_touch(unsigned int touch, real* vx, real* vy);
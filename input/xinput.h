@@ -0,0 +1,65 @@
+/* xinput.h  -  X11 XInput2 input  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#pragma once
+
+/*! \file xinput.h
+    XInput2 input for the X11 backend. When enabled, raw motion from relative pointer devices
+    gives mouse move events unaccelerated subpixel deltas while the window has focus or holds
+    the pointer. The raw delta is posted with the position of the core motion event that
+    follows it, or with the next raw motion when the pointer is stopped at the edge of the
+    screen and there is no core motion. Core motion without raw motion before it, such as from
+    absolute devices, keeps the change in position as delta. Touches from touch screens are
+    posted as touch events, each touch of each device occupying one of INPUT_TOUCH_MAX touch
+    slots while active. XInput2 events received by input_event_handle_window are translated
+    automatically. Requires XInput 2.2, libXi is loaded at runtime. On platforms other than
+    Linux the functions are available but XInput2 cannot be enabled. */
+
+#include <input/types.h>
+
+/*! Enable XInput2 input. Raw motion and device hotplug events are selected on the root window
+and touch, crossing and focus events on the given window. libXi stays loaded once enabled
+\param display X display, a Display pointer
+\param window Window to receive touch events
+\return true if enabled, false if XInput 2.2 or libXi is not available */
+INPUT_API bool
+input_xinput_enable(void* display, unsigned long window);
+
+/*! Disable XInput2 input and return to core pointer events. Clears the event selections, so
+must be called before the window is destroyed or the display closed. Also called when the
+input module is finalized */
+INPUT_API void
+input_xinput_disable(void);
+
+/*! Translate an XInput2 event, for applications running their own X event loop instead of
+passing events to input_event_handle_window
+\param cookie Generic event cookie, an XGenericEventCookie pointer with data retrieved by
+              XGetEventData
+\return true if the event was an XInput2 event handled by the input library */
+INPUT_API bool
+input_xinput_handle_event(void* cookie);
+
+/*! Get the X input device producing an active touch
+\param touch Touch slot
+\return Device id of the source device, -1 if the touch is not active */
+INPUT_API int
+input_xinput_touch_device(unsigned int touch);
+
+/*! Check if raw motion from an X input device is translated. Raw motion is translated for slave
+pointer devices with relative x and y valuators
+\param device Device id
+\return true if the device is a relative pointer device, false if not */
+INPUT_API bool
+input_xinput_relative_device(int device);
@@ -168,6 +168,10 @@ main_initialize(void) {
 #if BUILD_MONOLITHIC
 extern int
 test_basic_run(void);
+extern int
+test_bench_run(void);
+extern int
+test_loadgen_run(void);
 typedef int (*test_run_fn)(void);
 
 static void*
@@ -244,7 +248,7 @@ main_run(void* main_arg) {
 
 #if BUILD_MONOLITHIC
 
-	test_run_fn tests[] = {test_basic_run, 0};
+	test_run_fn tests[] = {test_basic_run, test_bench_run, test_loadgen_run, 0};
 
 #if FOUNDATION_PLATFORM_ANDROID
 
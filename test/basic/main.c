@@ -20,6 +20,16 @@
 
 #include <stdio.h>
 
+#if FOUNDATION_PLATFORM_LINUX
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include <window/event.h>
+#include <X11/Xlib.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XInput2.h>
+#endif
+
 static application_t
 test_basic_application(void) {
 	application_t app;
@@ -58,9 +68,1865 @@ DECLARE_TEST(basic, initfini) {
 	return 0;
 }
 
+DECLARE_TEST(basic, event_ring) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 128;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	for (int ievent = 0; ievent < 3; ++ievent) {
+		for (int ipost = 0; ipost < 64; ++ipost)
+			input_event_post_key(INPUTEVENT_KEYDOWN, (unsigned int)ipost, (unsigned int)ievent, 0);
+		input_event_post(INPUTEVENT_CHAR);
+
+		unsigned int expect = 0;
+		event_block_t* block = event_stream_process(input_event_stream());
+		event_t* event = 0;
+		while ((event = event_next(block, event))) {
+			if (expect < 64) {
+				const input_event_payload_t* payload = (const input_event_payload_t*)event->payload;
+				EXPECT_INTEQ(event->id, INPUTEVENT_KEYDOWN);
+				EXPECT_UINTEQ(payload->key.key, expect);
+				EXPECT_UINTEQ(payload->key.scancode, (unsigned int)ievent);
+			} else {
+				EXPECT_INTEQ(event->id, INPUTEVENT_CHAR);
+			}
+			++expect;
+		}
+		EXPECT_UINTEQ(expect, 65);
+	}
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, event_compact) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_compact = true;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 38, 2);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 100000, -20, REAL_C(1.5), REAL_C(-2.0), REAL_C(0.25), 0,
+	                       MOUSEBUTTON_LEFT | MOUSEBUTTON_7);
+	input_event_post_touch(INPUTEVENT_TOUCHMOVE, 640, 480, REAL_C(3.0), REAL_C(4.0), REAL_C(5.0), 2, 0x7);
+	input_event_post_acceleration(INPUTEVENT_ACCELERATION, REAL_C(0.5), REAL_C(-9.75), REAL_C(0.125));
+	input_event_post(INPUTEVENT_CHAR);
+
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = event_next(block, 0);
+	EXPECT_NE(event, 0);
+	EXPECT_LE(event->size, sizeof(event_t) + sizeof(input_key_compact_t) + 8);
+	EXPECT_TRUE(input_event_decode(event, &payload));
+	EXPECT_UINTEQ(payload.key.key, KEY_A);
+	EXPECT_UINTEQ(payload.key.scancode, 38);
+	EXPECT_UINTEQ(payload.key.flags, 2);
+
+	event = event_next(block, event);
+	EXPECT_NE(event, 0);
+	EXPECT_TRUE(input_event_decode(event, &payload));
+	EXPECT_INTEQ(payload.mouse.x, INT16_MAX);
+	EXPECT_INTEQ(payload.mouse.y, -20);
+	EXPECT_REALEQ(payload.mouse.dx, REAL_C(1.5));
+	EXPECT_REALEQ(payload.mouse.dy, REAL_C(-2.0));
+	EXPECT_REALEQ(payload.mouse.dz, REAL_C(0.25));
+	EXPECT_UINTEQ(payload.mouse.buttons, MOUSEBUTTON_LEFT | MOUSEBUTTON_7);
+
+	event = event_next(block, event);
+	EXPECT_NE(event, 0);
+	EXPECT_TRUE(input_event_decode(event, &payload));
+	EXPECT_INTEQ(payload.touch.x, 640);
+	EXPECT_INTEQ(payload.touch.y, 480);
+	EXPECT_REALEQ(payload.touch.velocity, REAL_C(5.0));
+	EXPECT_UINTEQ(payload.touch.touch, 2);
+	EXPECT_UINTEQ(payload.touch.touches, 0x7);
+
+	event = event_next(block, event);
+	EXPECT_NE(event, 0);
+	EXPECT_TRUE(input_event_decode(event, &payload));
+	EXPECT_REALEQ(payload.acceleration.y, REAL_C(-9.75));
+	EXPECT_REALEQ(payload.acceleration.z, REAL_C(0.125));
+
+	event = event_next(block, event);
+	EXPECT_NE(event, 0);
+	EXPECT_INTEQ(event->id, INPUTEVENT_CHAR);
+	EXPECT_FALSE(input_event_decode(event, &payload));
+	EXPECT_EQ(event_next(block, event), 0);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, event_batch) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 128;
+
+	input_key_event_t key[100];
+	for (unsigned int ikey = 0; ikey < 100; ++ikey) {
+		key[ikey].key = ikey;
+		key[ikey].scancode = ikey * 2;
+		key[ikey].flags = 0;
+	}
+
+	for (int imode = 0; imode < 2; ++imode) {
+		EXPECT_INTEQ(input_module_initialize(config), 0);
+
+		// Batches span several ring claims, with a drain in between
+		input_event_post_key_batch(INPUTEVENT_CHAR, key, 40);
+		unsigned int expect = 0;
+		event_block_t* block = event_stream_process(input_event_stream());
+		input_event_post_key_batch(INPUTEVENT_CHAR, key + 40, 60);
+		for (int iblock = 0; iblock < 2; ++iblock) {
+			event_t* event = 0;
+			input_event_payload_t payload;
+			while ((event = event_next(block, event))) {
+				EXPECT_INTEQ(event->id, INPUTEVENT_CHAR);
+				EXPECT_TRUE(input_event_decode(event, &payload));
+				EXPECT_UINTEQ(payload.key.key, expect);
+				EXPECT_UINTEQ(payload.key.scancode, expect * 2);
+				++expect;
+			}
+			block = event_stream_process(input_event_stream());
+		}
+		EXPECT_UINTEQ(expect, 100);
+
+		input_module_finalize();
+		config.event_ring_size = 0;
+	}
+	return 0;
+}
+
+DECLARE_TEST(basic, event_coalesce) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_coalesce = true;
+
+	for (int imode = 0; imode < 2; ++imode) {
+		EXPECT_INTEQ(input_module_initialize(config), 0);
+
+		for (int imove = 0; imove < 3; ++imove)
+			input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 10 + imove, 20 + imove, REAL_ONE, REAL_TWO, 0, 0, 0);
+		input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 12, 22, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT);
+		input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 13, 23, REAL_ONE, REAL_ONE, 0, 0, MOUSEBUTTON_LEFT);
+		input_event_post_touch(INPUTEVENT_TOUCHMOVE, 100, 100, REAL_ONE, 0, 0, 1, 0x3);
+		input_event_post_touch(INPUTEVENT_TOUCHMOVE, 200, 200, REAL_ONE, 0, 0, 2, 0x3);
+		input_event_post_touch(INPUTEVENT_TOUCHMOVE, 105, 100, REAL_C(5.0), 0, 0, 1, 0x3);
+		input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 15, 23, REAL_TWO, 0, 0, 0, MOUSEBUTTON_LEFT);
+		input_event_post_acceleration(INPUTEVENT_ACCELERATION, REAL_C(1.0), 0, REAL_C(-9.0));
+		input_event_post_acceleration(INPUTEVENT_ACCELERATION, REAL_C(3.0), 0, REAL_C(-11.0));
+		input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 0, 0);
+
+		const unsigned int expect_id[] = {INPUTEVENT_MOUSEMOVE,  INPUTEVENT_MOUSEDOWN,    INPUTEVENT_MOUSEMOVE,
+		                                  INPUTEVENT_TOUCHMOVE,  INPUTEVENT_TOUCHMOVE,    INPUTEVENT_ACCELERATION,
+		                                  INPUTEVENT_KEYDOWN};
+		size_t count = 0;
+		input_event_payload_t payload;
+		event_block_t* block = event_stream_process(input_event_stream());
+		event_t* event = 0;
+		while ((event = event_next(block, event))) {
+			EXPECT_LT(count, sizeof(expect_id) / sizeof(expect_id[0]));
+			EXPECT_UINTEQ(event->id, expect_id[count]);
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			if (count == 0) {
+				EXPECT_INTEQ(payload.mouse.x, 12);
+				EXPECT_REALEQ(payload.mouse.dx, REAL_C(3.0));
+				EXPECT_REALEQ(payload.mouse.dy, REAL_C(6.0));
+			} else if (count == 2) {
+				EXPECT_INTEQ(payload.mouse.x, 15);
+				EXPECT_REALEQ(payload.mouse.dx, REAL_C(3.0));
+				EXPECT_UINTEQ(payload.mouse.buttons, MOUSEBUTTON_LEFT);
+			} else if (count == 3) {
+				EXPECT_UINTEQ(payload.touch.touch, 1);
+				EXPECT_INTEQ(payload.touch.x, 105);
+				EXPECT_REALEQ(payload.touch.dx, REAL_C(6.0));
+			} else if (count == 4) {
+				EXPECT_UINTEQ(payload.touch.touch, 2);
+			} else if (count == 5) {
+				EXPECT_REALEQ(payload.acceleration.x, REAL_C(2.0));
+				EXPECT_REALEQ(payload.acceleration.z, REAL_C(-10.0));
+			}
+			++count;
+		}
+		EXPECT_SIZEEQ(count, sizeof(expect_id) / sizeof(expect_id[0]));
+
+		input_module_finalize();
+		config.event_ring_size = 128;
+	}
+	return 0;
+}
+
+DECLARE_TEST(basic, event_overflow) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 64;
+
+	// Posting on the consuming thread with INPUTOVERFLOW_BLOCK must not wait for itself
+	const input_overflow_policy policy[] = {INPUTOVERFLOW_DROP_NEWEST, INPUTOVERFLOW_GROW, INPUTOVERFLOW_DROP_OLDEST,
+	                                        INPUTOVERFLOW_BLOCK};
+	for (size_t ipolicy = 0; ipolicy < sizeof(policy) / sizeof(policy[0]); ++ipolicy) {
+		config.event_overflow = policy[ipolicy];
+		EXPECT_INTEQ(input_module_initialize(config), 0);
+
+		size_t capacity = input_event_queue_statistics().capacity;
+		EXPECT_GE(capacity, 32);
+		EXPECT_LT(capacity, 90);
+
+		for (unsigned int ikey = 0; ikey < 10; ++ikey)
+			input_event_post_key(INPUTEVENT_KEYDOWN, ikey, 0, 0);
+		for (int imove = 0; imove < 90; ++imove)
+			input_event_post_mouse(INPUTEVENT_MOUSEMOVE, imove, 0, REAL_ONE, 0, 0, 0, 0);
+
+		size_t keys = 0;
+		size_t moves = 0;
+		int last_x = -1;
+		input_event_payload_t payload;
+		event_block_t* block = event_stream_process(input_event_stream());
+		event_t* event = 0;
+		while ((event = event_next(block, event))) {
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			if (event->id == INPUTEVENT_KEYDOWN) {
+				EXPECT_SIZEEQ(moves, 0);
+				EXPECT_UINTEQ(payload.key.key, keys);
+				++keys;
+			} else {
+				EXPECT_INTEQ(event->id, INPUTEVENT_MOUSEMOVE);
+				EXPECT_GT(payload.mouse.x, last_x);
+				last_x = payload.mouse.x;
+				++moves;
+			}
+		}
+
+		input_queue_statistics_t statistics = input_event_queue_statistics();
+		EXPECT_SIZEEQ(keys, 10);
+		if ((policy[ipolicy] == INPUTOVERFLOW_GROW) || (policy[ipolicy] == INPUTOVERFLOW_BLOCK)) {
+			EXPECT_SIZEEQ(moves, 90);
+			EXPECT_EQ(statistics.dropped, 0);
+			EXPECT_EQ(statistics.overflowed, 100 - capacity);
+			EXPECT_SIZEEQ(statistics.high_water, 100);
+		} else if (policy[ipolicy] == INPUTOVERFLOW_DROP_NEWEST) {
+			EXPECT_SIZEEQ(moves, capacity - 10);
+			EXPECT_EQ(statistics.dropped, 100 - capacity);
+			EXPECT_SIZEEQ(statistics.high_water, capacity);
+			EXPECT_INTEQ(last_x, (int)capacity - 11);
+		} else {
+			// Keys are moved aside when evicted, so the ring ends up holding the last moves
+			EXPECT_SIZEEQ(moves, capacity);
+			EXPECT_EQ(statistics.dropped, 90 - capacity);
+			EXPECT_SIZEEQ(statistics.high_water, capacity + 10);
+			EXPECT_INTEQ(last_x, 89);
+		}
+
+		input_module_finalize();
+	}
+
+	// Discrete events kept aside by INPUTOVERFLOW_DROP_OLDEST are bounded, the oldest are dropped
+	config.event_overflow = INPUTOVERFLOW_DROP_OLDEST;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	size_t capacity = input_event_queue_statistics().capacity;
+	for (unsigned int ikey = 0; ikey < 3 * capacity; ++ikey)
+		input_event_post_key(INPUTEVENT_KEYDOWN, ikey, 0, 0);
+
+	size_t keys = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		EXPECT_UINTEQ(payload.key.key, capacity + keys);
+		++keys;
+	}
+	EXPECT_SIZEEQ(keys, 2 * capacity);
+	EXPECT_EQ(input_event_queue_statistics().dropped, capacity);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, event_broadcast) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 256;
+	config.event_broadcast_size = 64;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	input_consumer_t* keys = input_consumer_allocate(INPUT_EVENT_MASK(INPUTEVENT_KEYDOWN));
+	input_consumer_t* mice = input_consumer_allocate(INPUT_EVENT_MASK(INPUTEVENT_MOUSEMOVE));
+	EXPECT_NE(keys, 0);
+	EXPECT_NE(mice, 0);
+
+	for (unsigned int ievent = 0; ievent < 20; ++ievent) {
+		input_event_post_key(INPUTEVENT_KEYDOWN, ievent, 0, 0);
+		input_event_post_mouse(INPUTEVENT_MOUSEMOVE, (int)ievent, 0, REAL_ONE, 0, 0, 0, 0);
+	}
+
+	const input_event_t* event;
+	unsigned int key_count = 0;
+	while ((event = input_consumer_next(keys))) {
+		EXPECT_UINTEQ(event->id, INPUTEVENT_KEYDOWN);
+		EXPECT_UINTEQ(event->payload.key.key, key_count);
+		++key_count;
+	}
+	EXPECT_UINTEQ(key_count, 20);
+	EXPECT_SIZEEQ(input_consumer_lag(keys), 0);
+	EXPECT_SIZEEQ(input_consumer_lag(mice), 40);
+	EXPECT_SIZEEQ(input_broadcast_lag(), 40);
+
+	// A stalled consumer holds back the broadcast ring without losing events
+	for (unsigned int ievent = 20; ievent < 200; ++ievent) {
+		input_event_post_key(INPUTEVENT_KEYDOWN, ievent, 0, 0);
+		input_event_post_mouse(INPUTEVENT_MOUSEMOVE, (int)ievent, 0, REAL_ONE, 0, 0, 0, 0);
+	}
+	while ((event = input_consumer_next(keys)))
+		++key_count;
+	EXPECT_LT(key_count, 200);
+	EXPECT_LE(input_broadcast_lag(), 64);
+
+	int mouse_count = 0;
+	while (key_count < 200) {
+		while ((event = input_consumer_next(mice))) {
+			EXPECT_UINTEQ(event->id, INPUTEVENT_MOUSEMOVE);
+			EXPECT_INTEQ(event->payload.mouse.x, mouse_count);
+			++mouse_count;
+		}
+		while ((event = input_consumer_next(keys))) {
+			EXPECT_UINTEQ(event->payload.key.key, key_count);
+			++key_count;
+		}
+	}
+	while ((event = input_consumer_next(mice)))
+		++mouse_count;
+	EXPECT_UINTEQ(key_count, 200);
+	EXPECT_INTEQ(mouse_count, 200);
+	EXPECT_SIZEEQ(input_broadcast_lag(), 0);
+
+	input_consumer_deallocate(mice);
+	input_consumer_deallocate(keys);
+	input_module_finalize();
+
+	// A long press detected by input_event_process waits for room in the broadcast ring
+	config.event_gestures = true;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+	input_consumer_t* gestures = input_consumer_allocate(INPUT_EVENT_MASK(INPUTEVENT_GESTURELONGPRESS));
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 50, 50, 0, 0, 0, 0, 0x1);
+	for (unsigned int ievent = 0; ievent < 100; ++ievent)
+		input_event_post_key(INPUTEVENT_KEYDOWN, ievent, 0, 0);
+	input_event_process();
+	thread_sleep(INPUT_GESTURE_LONGPRESS_MS + 50);
+	input_event_process();
+
+	size_t longpress = 0;
+	for (int iframe = 0; iframe < 4; ++iframe) {
+		while ((event = input_consumer_next(gestures)))
+			++longpress;
+		input_event_process();
+	}
+	EXPECT_SIZEEQ(longpress, 1);
+	EXPECT_EQ(input_event_queue_statistics().dropped, 0);
+
+	input_consumer_deallocate(gestures);
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, state) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_AUML, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 10, 20, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 12, 21, REAL_TWO, REAL_ONE, REAL_ONE, 0, MOUSEBUTTON_LEFT);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 13, 21, REAL_ONE, 0, REAL_ONE, 0, MOUSEBUTTON_LEFT);
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 100, 200, 0, 0, 0, 3, 0x8);
+	EXPECT_FALSE(input_key_down(KEY_A));
+	input_event_process();
+
+	const input_state_t* state = input_state();
+	EXPECT_TRUE(input_key_down(KEY_A));
+	EXPECT_TRUE(input_key_pressed(KEY_A));
+	EXPECT_FALSE(input_key_released(KEY_A));
+	EXPECT_TRUE(input_key_down(KEY_AUML));
+	EXPECT_FALSE(input_key_down(KEY_B));
+	EXPECT_FALSE(input_key_down(KEY_UNKNOWN));
+	EXPECT_TRUE(input_mouse_down(MOUSEBUTTON_LEFT));
+	EXPECT_TRUE(input_mouse_pressed(MOUSEBUTTON_LEFT));
+	EXPECT_FALSE(input_mouse_down(MOUSEBUTTON_RIGHT));
+	EXPECT_INTEQ(state->mouse_x, 13);
+	EXPECT_REALEQ(state->mouse_dx, REAL_C(3.0));
+	EXPECT_REALEQ(state->mouse_wheel, REAL_TWO);
+	EXPECT_UINTEQ(state->touches, 0x8);
+	EXPECT_UINTEQ(state->touches_began, 0x8);
+	EXPECT_INTEQ(state->touch_y[3], 200);
+
+	// Edges only last one snapshot, a tap within a snapshot is pressed and released but not down
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_A, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_B, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_B, 0, 0);
+	input_event_post_touch(INPUTEVENT_TOUCHEND, 100, 200, 0, 0, 0, 3, 0);
+	input_event_process();
+	EXPECT_FALSE(input_key_down(KEY_A));
+	EXPECT_FALSE(input_key_pressed(KEY_A));
+	EXPECT_TRUE(input_key_released(KEY_A));
+	EXPECT_FALSE(input_key_down(KEY_B));
+	EXPECT_TRUE(input_key_pressed(KEY_B));
+	EXPECT_TRUE(input_key_released(KEY_B));
+	EXPECT_TRUE(input_key_down(KEY_AUML));
+	EXPECT_FALSE(input_key_pressed(KEY_AUML));
+	EXPECT_TRUE(input_mouse_down(MOUSEBUTTON_LEFT));
+	EXPECT_FALSE(input_mouse_pressed(MOUSEBUTTON_LEFT));
+	EXPECT_REALZERO(state->mouse_dx);
+	EXPECT_UINTEQ(state->touches, 0);
+	EXPECT_UINTEQ(state->touches_ended, 0x8);
+
+	input_event_process();
+	EXPECT_FALSE(input_key_released(KEY_A));
+	EXPECT_FALSE(input_key_pressed(KEY_B));
+	EXPECT_UINTEQ(state->touches_ended, 0);
+
+	// Autorepeat key down and a repeated button down for held inputs are not edges
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_AUML, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_AUML, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 13, 21, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT);
+	input_event_process();
+	EXPECT_TRUE(input_key_down(KEY_AUML));
+	EXPECT_FALSE(input_key_pressed(KEY_AUML));
+	EXPECT_FALSE(input_key_released(KEY_AUML));
+	EXPECT_TRUE(input_mouse_down(MOUSEBUTTON_LEFT));
+	EXPECT_FALSE(input_mouse_pressed(MOUSEBUTTON_LEFT));
+	EXPECT_FALSE(input_mouse_released(MOUSEBUTTON_LEFT));
+	input_event_post_mouse(INPUTEVENT_MOUSEUP, 13, 21, 0, 0, 0, MOUSEBUTTON_LEFT | MOUSEBUTTON_RIGHT, 0);
+	input_event_process();
+	EXPECT_TRUE(input_mouse_released(MOUSEBUTTON_LEFT));
+	EXPECT_FALSE(input_mouse_released(MOUSEBUTTON_RIGHT));
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, state_history) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 0, 0, 0, 0, 0, MOUSEBUTTON_RIGHT, MOUSEBUTTON_RIGHT);
+	EXPECT_FALSE(input_key_pressed_within(KEY_A, 1000));
+	input_event_process();
+	EXPECT_TRUE(input_key_pressed_within(KEY_A, 1000));
+	EXPECT_TRUE(input_key_pressed_within_frames(KEY_A, 1));
+	EXPECT_FALSE(input_key_released_within(KEY_A, 1000));
+	EXPECT_FALSE(input_key_pressed_within(KEY_B, 1000));
+	EXPECT_TRUE(input_mouse_pressed_within(MOUSEBUTTON_RIGHT, 1000));
+	EXPECT_FALSE(input_mouse_pressed_within(MOUSEBUTTON_LEFT, 1000));
+
+	input_event_process();
+	thread_sleep(20);
+	input_event_process();
+	EXPECT_FALSE(input_key_pressed_within_frames(KEY_A, 2));
+	EXPECT_TRUE(input_key_pressed_within_frames(KEY_A, 3));
+	EXPECT_TRUE(input_key_pressed_within(KEY_A, 1000));
+	EXPECT_FALSE(input_key_pressed_within(KEY_A, 5));
+	EXPECT_GE(input_key_hold_duration(KEY_A), 20);
+	EXPECT_GE(input_mouse_hold_duration(MOUSEBUTTON_RIGHT), 20);
+	EXPECT_UINTEQ(input_key_hold_duration(KEY_B), 0);
+
+	// Autorepeat does not push the press out of the history
+	for (int irepeat = 0; irepeat < 8; ++irepeat)
+		input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 0, 0, 0, 0, 0, MOUSEBUTTON_RIGHT, MOUSEBUTTON_RIGHT);
+	input_event_process();
+	EXPECT_FALSE(input_key_pressed_within(KEY_A, 5));
+	EXPECT_GE(input_key_hold_duration(KEY_A), 20);
+	EXPECT_GE(input_mouse_hold_duration(MOUSEBUTTON_RIGHT), 20);
+
+	// Transitions after the latest snapshot are not visible until the next snapshot
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_A, 0, 0);
+	EXPECT_FALSE(input_key_released_within(KEY_A, 1000));
+	EXPECT_GE(input_key_hold_duration(KEY_A), 20);
+	input_event_process();
+	EXPECT_TRUE(input_key_released_within(KEY_A, 1000));
+	EXPECT_UINTEQ(input_key_hold_duration(KEY_A), 0);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, action) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	hash_t jump = hash(STRING_CONST("jump"));
+	hash_t save = hash(STRING_CONST("save"));
+	hash_t fire = hash(STRING_CONST("fire"));
+	hash_t strafe = hash(STRING_CONST("strafe"));
+	hash_t look = hash(STRING_CONST("look"));
+	EXPECT_TRUE(input_action_bind_key(jump, KEY_SPACE, 0, REAL_ONE));
+	EXPECT_TRUE(input_action_bind_key(jump, KEY_W, 0, REAL_ONE));
+	EXPECT_TRUE(input_action_bind_key(save, KEY_S, KEYMODIFIER_CTRL, REAL_ONE));
+	EXPECT_TRUE(input_action_bind_mouse(fire, MOUSEBUTTON_LEFT, 0, REAL_ONE));
+	EXPECT_TRUE(input_action_bind_key(strafe, KEY_A, 0, -REAL_ONE));
+	EXPECT_TRUE(input_action_bind_key(strafe, KEY_D, 0, REAL_ONE));
+	EXPECT_TRUE(input_action_bind_axis(look, INPUTAXIS_MOUSE_X, REAL_C(0.5)));
+	EXPECT_FALSE(input_action_bind_key(jump, KEY_UNKNOWN, 0, REAL_ONE));
+
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_SPACE, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_S, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_D, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 0, 0, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 4, 0, REAL_C(4.0), 0, 0, 0, MOUSEBUTTON_LEFT);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 6, 0, REAL_TWO, 0, 0, 0, MOUSEBUTTON_LEFT);
+	input_event_process();
+	EXPECT_TRUE(input_action_down(jump));
+	EXPECT_TRUE(input_action_pressed(jump));
+	EXPECT_FALSE(input_action_down(save));
+	EXPECT_TRUE(input_action_down(fire));
+	EXPECT_REALEQ(input_action_value(strafe), REAL_ONE);
+	EXPECT_REALEQ(input_action_value(look), REAL_C(3.0));
+	EXPECT_FALSE(input_action_down(hash(STRING_CONST("unbound"))));
+
+	// Action stays down while any bound key is held
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_W, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_SPACE, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_S, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_LCTRL, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_S, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 0, 0);
+	input_event_process();
+	EXPECT_TRUE(input_action_down(jump));
+	EXPECT_FALSE(input_action_pressed(jump));
+	EXPECT_FALSE(input_action_released(jump));
+	EXPECT_TRUE(input_action_pressed(save));
+	EXPECT_REALZERO(input_action_value(strafe));
+	EXPECT_REALZERO(input_action_value(look));
+
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_W, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_LCTRL, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEUP, 0, 0, 0, 0, 0, MOUSEBUTTON_LEFT, 0);
+	input_event_process();
+	EXPECT_FALSE(input_action_down(jump));
+	EXPECT_TRUE(input_action_released(jump));
+	EXPECT_TRUE(input_action_down(save));
+	EXPECT_TRUE(input_action_released(fire));
+
+	input_action_unbind(save);
+	input_event_process();
+	EXPECT_FALSE(input_action_down(save));
+	EXPECT_TRUE(input_action_released(save));
+
+	// Changing other bindings keeps a held action down without edges
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_SPACE, 0, 0);
+	input_event_process();
+	EXPECT_TRUE(input_action_pressed(jump));
+	hash_t crouch = hash(STRING_CONST("crouch"));
+	EXPECT_TRUE(input_action_bind_key(crouch, KEY_C, 0, REAL_ONE));
+	input_action_unbind(strafe);
+	input_event_process();
+	EXPECT_TRUE(input_action_down(jump));
+	EXPECT_FALSE(input_action_pressed(jump));
+	EXPECT_FALSE(input_action_released(jump));
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_SPACE, 0, 0);
+	input_event_process();
+	EXPECT_TRUE(input_action_released(jump));
+
+	input_module_finalize();
+
+	// Unbound actions give their index back once the release has been seen
+	config.action_capacity = 64;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+	for (unsigned int iaction = 0; iaction < 1000; ++iaction) {
+		hash_t action = hash(&iaction, sizeof(iaction));
+		EXPECT_TRUE(input_action_bind_key(action, KEY_Q, 0, REAL_ONE));
+		input_event_post_key(INPUTEVENT_KEYDOWN, KEY_Q, 0, 0);
+		input_event_process();
+		EXPECT_TRUE(input_action_pressed(action));
+		input_action_unbind(action);
+		if (iaction & 1) {
+			EXPECT_TRUE(input_action_bind_key(action, KEY_Q, 0, REAL_ONE));
+			input_action_unbind(action);
+		}
+		input_event_post_key(INPUTEVENT_KEYUP, KEY_Q, 0, 0);
+		input_event_process();
+		EXPECT_TRUE(input_action_released(action));
+	}
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, sequence) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	hash_t fireball = hash(STRING_CONST("fireball"));
+	hash_t dash = hash(STRING_CONST("dash"));
+	hash_t click = hash(STRING_CONST("click"));
+	const unsigned int fireball_steps[] = {KEY_DOWN, KEY_RIGHT, KEY_P | INPUT_SEQUENCE_CHORD};
+	const unsigned int dash_steps[] = {KEY_RIGHT, KEY_RIGHT};
+	const unsigned int click_steps[] = {KEY_LSHIFT, MOUSEBUTTON_LEFT | INPUT_SEQUENCE_MOUSE};
+	const unsigned int invalid_steps[] = {KEY_UNKNOWN};
+	EXPECT_TRUE(input_sequence_add(fireball, fireball_steps, 3, 200));
+	EXPECT_TRUE(input_sequence_add(dash, dash_steps, 2, 0));
+	EXPECT_TRUE(input_sequence_add(click, click_steps, 2, 0));
+	EXPECT_FALSE(input_sequence_add(click, invalid_steps, 1, 0));
+
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_DOWN, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_X, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_P, 0, 0);
+	input_event_process();
+	EXPECT_TRUE(input_sequence_triggered(fireball));
+	EXPECT_FALSE(input_sequence_triggered(dash));
+
+	// Chorded steps match in either order, and overlapping sequences match on the same press
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_DOWN, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_P, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	input_event_process();
+	EXPECT_TRUE(input_sequence_triggered(fireball));
+	EXPECT_FALSE(input_sequence_triggered(dash));
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 0, 0, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT);
+	input_event_process();
+	EXPECT_FALSE(input_sequence_triggered(fireball));
+	EXPECT_TRUE(input_sequence_triggered(dash));
+	EXPECT_FALSE(input_sequence_triggered(click));
+
+	// Chord and sequence windows
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_DOWN, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	thread_sleep(100);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_P, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_DOWN, 0, 0);
+	thread_sleep(250);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_P, 0, 0);
+	input_event_process();
+	EXPECT_FALSE(input_sequence_triggered(fireball));
+
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_LSHIFT, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 0, 0, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT);
+	input_sequence_remove(dash);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_RIGHT, 0, 0);
+	input_event_process();
+	EXPECT_FALSE(input_sequence_triggered(dash));
+	EXPECT_FALSE(input_sequence_triggered(click));
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_LSHIFT, 0, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEDOWN, 0, 0, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT);
+	input_event_process();
+	EXPECT_TRUE(input_sequence_triggered(click));
+	input_module_finalize();
+
+	// Sequences added and removed in a row are compiled once, removed sequences no longer
+	// match and the sequence moved to a removed index keeps matching
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+	for (unsigned int isequence = 0; isequence < 4000; ++isequence) {
+		unsigned int steps[] = {KEY_A + (isequence % 26), KEY_A + ((isequence / 26) % 26), KEY_A + (isequence / 676)};
+		EXPECT_TRUE(input_sequence_add(hash(&isequence, sizeof(isequence)), steps, 3, 0));
+	}
+	for (unsigned int isequence = 1; isequence < 4000; isequence += 2)
+		input_sequence_remove(hash(&isequence, sizeof(isequence)));
+	const unsigned int pressed[] = {2000, 2001, 3998};
+	for (size_t ipress = 0; ipress < sizeof(pressed) / sizeof(pressed[0]); ++ipress) {
+		input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A + (pressed[ipress] % 26), 0, 0);
+		input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A + ((pressed[ipress] / 26) % 26), 0, 0);
+		input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A + (pressed[ipress] / 676), 0, 0);
+	}
+	input_event_process();
+	EXPECT_TRUE(input_sequence_triggered(hash(pressed, sizeof(pressed[0]))));
+	EXPECT_FALSE(input_sequence_triggered(hash(pressed + 1, sizeof(pressed[0]))));
+	EXPECT_TRUE(input_sequence_triggered(hash(pressed + 2, sizeof(pressed[0]))));
+
+	input_module_finalize();
+	return 0;
+}
+
+static size_t
+test_basic_gestures(unsigned int id, input_gesture_event_t* gesture) {
+	size_t count = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		if ((event->id != (int)id) || !input_event_decode(event, &payload))
+			continue;
+		*gesture = payload.gesture;
+		++count;
+	}
+	return count;
+}
+
+DECLARE_TEST(basic, gesture) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_gestures = true;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	input_gesture_event_t gesture;
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 100, 100, 0, 0, 0, 0, 0x1);
+	input_event_post_touch(INPUTEVENT_TOUCHEND, 102, 101, 0, 0, 0, 0, 0);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTURETAP, &gesture), 1);
+	EXPECT_INTEQ(gesture.x, 102);
+	EXPECT_UINTEQ(gesture.touches, 0x1);
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 110, 100, 0, 0, 0, 1, 0x2);
+	input_event_post_touch(INPUTEVENT_TOUCHEND, 110, 100, 0, 0, 0, 1, 0);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTUREDOUBLETAP, &gesture), 1);
+	EXPECT_INTEQ(gesture.x, 110);
+
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 100, 100, 0, 0, 0, 0, 0x1);
+	input_event_post_touch(INPUTEVENT_TOUCHMOVE, 200, 100, 0, 0, 0, 0, 0x1);
+	input_event_post_touch(INPUTEVENT_TOUCHEND, 300, 90, 0, 0, 0, 0, 0);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTURESWIPE, &gesture), 1);
+	EXPECT_REALEQ(gesture.dx, REAL_C(200.0));
+	EXPECT_REALEQ(gesture.dy, REAL_C(-10.0));
+	EXPECT_TRUE(gesture.value >= (real)INPUT_GESTURE_SWIPE_VELOCITY);
+
+	// Pinch and rotate are relative to the touch pair when the second touch began
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 100, 100, 0, 0, 0, 0, 0x1);
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 200, 100, 0, 0, 0, 1, 0x3);
+	input_event_post_touch(INPUTEVENT_TOUCHMOVE, 205, 100, 0, 0, 0, 1, 0x3);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTUREPINCH, &gesture), 0);
+	input_event_post_touch(INPUTEVENT_TOUCHMOVE, 300, 100, 0, 0, 0, 1, 0x3);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTUREPINCH, &gesture), 1);
+	EXPECT_REALEQ(gesture.value, REAL_TWO);
+	EXPECT_INTEQ(gesture.x, 200);
+	input_event_post_touch(INPUTEVENT_TOUCHMOVE, 100, 200, 0, 0, 0, 1, 0x3);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTUREROTATE, &gesture), 1);
+	EXPECT_REALEQ(gesture.value, REAL_HALFPI);
+	input_event_post_touch(INPUTEVENT_TOUCHEND, 100, 100, 0, 0, 0, 0, 0x2);
+	input_event_post_touch(INPUTEVENT_TOUCHEND, 100, 200, 0, 0, 0, 1, 0);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTURETAP, &gesture), 0);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTURESWIPE, &gesture), 0);
+
+	// Long press is reported once by input_event_process and suppresses the tap
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 50, 50, 0, 0, 0, 2, 0x4);
+	input_event_process();
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTURELONGPRESS, &gesture), 0);
+	thread_sleep(INPUT_GESTURE_LONGPRESS_MS + 50);
+	input_event_process();
+	input_event_process();
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTURELONGPRESS, &gesture), 1);
+	EXPECT_UINTEQ(gesture.touches, 0x4);
+	input_event_post_touch(INPUTEVENT_TOUCHEND, 50, 50, 0, 0, 0, 2, 0);
+	EXPECT_SIZEEQ(test_basic_gestures(INPUTEVENT_GESTURETAP, &gesture), 0);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, record) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	string_t path = path_allocate_concat(STRING_ARGS(environment_temporary_directory()),
+	                                     STRING_CONST("input_record.bin"));
+	EXPECT_TRUE(input_record_start(STRING_ARGS(path)));
+	EXPECT_TRUE(input_record_active());
+	EXPECT_FALSE(input_record_start(STRING_ARGS(path)));
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 30, 0);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 1000, -20, REAL_C(3.5), -REAL_ONE, 0, 0, MOUSEBUTTON_LEFT);
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 1002, -21, REAL_TWO, -REAL_ONE, 0, 0, MOUSEBUTTON_LEFT);
+	input_event_post_touch(INPUTEVENT_TOUCHBEGIN, 300, 400, 0, 0, 0, 2, 0x4);
+	input_event_post_acceleration(INPUTEVENT_ACCELERATION, REAL_HALF, 0, REAL_C(-9.5));
+	input_event_post(INPUTEVENT_TOUCHCANCEL);
+	EXPECT_UINTEQ(input_record_stop(), 6);
+	EXPECT_FALSE(input_record_active());
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_A, 30, 0);
+	event_stream_process(input_event_stream());
+
+	input_replay_t* replay = input_replay_allocate(STRING_ARGS(path));
+	EXPECT_NE(replay, 0);
+	EXPECT_FALSE(input_replay_finished(replay));
+	EXPECT_SIZEEQ(input_replay_update(replay, 0), 6);
+	EXPECT_TRUE(input_replay_finished(replay));
+	input_replay_deallocate(replay);
+
+	const unsigned int expect_id[] = {INPUTEVENT_KEYDOWN,    INPUTEVENT_MOUSEMOVE,    INPUTEVENT_MOUSEMOVE,
+	                                  INPUTEVENT_TOUCHBEGIN, INPUTEVENT_ACCELERATION, INPUTEVENT_TOUCHCANCEL};
+	size_t count = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_LT(count, sizeof(expect_id) / sizeof(expect_id[0]));
+		EXPECT_UINTEQ(event->id, expect_id[count]);
+		if (count == 0) {
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			EXPECT_UINTEQ(payload.key.key, KEY_A);
+			EXPECT_UINTEQ(payload.key.scancode, 30);
+		} else if (count == 2) {
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			EXPECT_INTEQ(payload.mouse.x, 1002);
+			EXPECT_INTEQ(payload.mouse.y, -21);
+			EXPECT_REALEQ(payload.mouse.dx, REAL_TWO);
+			EXPECT_UINTEQ(payload.mouse.buttons, MOUSEBUTTON_LEFT);
+		} else if (count == 3) {
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			EXPECT_INTEQ(payload.touch.y, 400);
+			EXPECT_UINTEQ(payload.touch.touch, 2);
+		} else if (count == 4) {
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			EXPECT_REALEQ(payload.acceleration.z, REAL_C(-9.5));
+		} else if (count == 5) {
+			EXPECT_FALSE(input_event_decode(event, &payload));
+		}
+		++count;
+	}
+	EXPECT_SIZEEQ(count, sizeof(expect_id) / sizeof(expect_id[0]));
+
+	// Replay at the recorded pace posts the first event at once and the rest once due
+	replay = input_replay_allocate(STRING_ARGS(path));
+	EXPECT_NE(replay, 0);
+	size_t posted = input_replay_update(replay, REAL_ONE);
+	EXPECT_GE(posted, 1);
+	thread_sleep(10);
+	posted += input_replay_update(replay, REAL_ONE);
+	EXPECT_SIZEEQ(posted, 6);
+	input_replay_deallocate(replay);
+	EXPECT_EQ(input_replay_allocate(STRING_CONST("no/such/recording")), 0);
+	event_stream_process(input_event_stream());
+
+	// Replayed events keep the recorded spacing, so the velocity of a recorded swipe at
+	// 1000 px/s is derived again when posted at once and doubled at twice the pace
+	tick_t ticks_per_ms = time_ticks_per_second() / 1000;
+	EXPECT_TRUE(input_record_start(STRING_ARGS(path)));
+	thread_sleep(50);
+	tick_t now = time_current();
+	for (int isample = 0; isample < 6; ++isample) {
+		tick_t timestamp = now - (tick_t)((5 - isample) * 8) * ticks_per_ms;
+		input_event_id id = isample ? INPUTEVENT_TOUCHMOVE : INPUTEVENT_TOUCHBEGIN;
+		input_event_post_touch_at(id, timestamp, 100 + isample * 8, 200, 0, 0, 0, 1, 0x2);
+	}
+	EXPECT_UINTEQ(input_record_stop(), 6);
+	input_event_process();
+	event_stream_process(input_event_stream());
+
+	real vx, vy;
+	replay = input_replay_allocate(STRING_ARGS(path));
+	EXPECT_SIZEEQ(input_replay_update(replay, 0), 6);
+	input_replay_deallocate(replay);
+	input_event_process();
+	event_stream_process(input_event_stream());
+	EXPECT_TRUE(input_velocity_touch(1, &vx, &vy));
+	EXPECT_TRUE(math_abs(vx - REAL_C(1000.0)) < REAL_C(10.0));
+	EXPECT_TRUE(math_abs(vy) < REAL_C(1.0));
+
+	replay = input_replay_allocate(STRING_ARGS(path));
+	posted = 0;
+	while (!input_replay_finished(replay)) {
+		posted += input_replay_update(replay, REAL_TWO);
+		thread_sleep(1);
+	}
+	EXPECT_SIZEEQ(posted, 6);
+	input_replay_deallocate(replay);
+	input_event_process();
+	event_stream_process(input_event_stream());
+	EXPECT_TRUE(input_velocity_touch(1, &vx, &vy));
+	EXPECT_TRUE(math_abs(vx - REAL_C(2000.0)) < REAL_C(20.0));
+
+	fs_remove_file(STRING_ARGS(path));
+	string_deallocate(path.str);
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, statistics) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 128;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	input_statistics_t statistics;
+	input_mouse_event_t mouse[2];
+	memset(mouse, 0, sizeof(mouse));
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_A, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_B, 0, 0);
+	input_event_post_key(INPUTEVENT_KEYDOWN, KEY_C, 0, 0);
+	input_event_post_mouse_batch(INPUTEVENT_MOUSEMOVE, mouse, 2);
+	input_statistics(&statistics);
+	EXPECT_UINTEQ(statistics.posted[INPUTEVENT_KEYDOWN], 3);
+	EXPECT_UINTEQ(statistics.posted[INPUTEVENT_MOUSEMOVE], 2);
+	EXPECT_UINTEQ(statistics.posted[INPUTEVENT_KEYUP], 0);
+	EXPECT_SIZEEQ(statistics.queue_depth, 5);
+	EXPECT_UINTEQ(statistics.published, 0);
+	EXPECT_UINTEQ(input_statistics_latency_percentile(&statistics, REAL_C(50.0)), 0);
+
+	thread_sleep(5);
+	event_stream_process(input_event_stream());
+	input_statistics(&statistics);
+	EXPECT_SIZEEQ(statistics.queue_depth, 0);
+	EXPECT_SIZEEQ(statistics.queue_high_water, 5);
+	EXPECT_UINTEQ(statistics.published, 5);
+	EXPECT_UINTEQ(statistics.latency_count, 5);
+	EXPECT_GE(statistics.latency_max, 5000000);
+	EXPECT_GE(input_statistics_latency_percentile(&statistics, REAL_C(50.0)), 5000000);
+	EXPECT_LE(input_statistics_latency_percentile(&statistics, REAL_C(99.0)), statistics.latency_max);
+
+	// Buckets are exact below eight nanoseconds and split each power of two in eight
+	EXPECT_UINTEQ(input_statistics_bucket_limit(0), 0);
+	EXPECT_UINTEQ(input_statistics_bucket_limit(8), 8);
+	EXPECT_UINTEQ(input_statistics_bucket_limit(16), 17);
+	EXPECT_UINTEQ(input_statistics_bucket_limit(23), 31);
+	for (unsigned int bucket = 1; bucket < INPUT_STATISTICS_BUCKETS; ++bucket)
+		EXPECT_GT(input_statistics_bucket_limit(bucket), input_statistics_bucket_limit(bucket - 1));
+
+	input_module_finalize();
+
+	// Latency is measured up to the drain with the default ring size as well
+	config.event_ring_size = 0;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+	input_event_post_key_at(INPUTEVENT_KEYDOWN, time_current() - (time_ticks_per_second() / 200), KEY_A, 0, 0);
+	event_stream_process(input_event_stream());
+	input_statistics(&statistics);
+	EXPECT_UINTEQ(statistics.published, 1);
+	EXPECT_UINTEQ(statistics.latency_count, 1);
+	EXPECT_GE(statistics.latency_max, 5000000);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, timestamp) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 128;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	tick_t ticks_per_ms = time_ticks_per_second() / 1000;
+	tick_t before = time_current();
+	tick_t native = before - (20 * ticks_per_ms);
+	input_event_post_key_at(INPUTEVENT_KEYDOWN, native, KEY_A, 0, 0);
+	input_event_post_mouse_at(INPUTEVENT_MOUSEMOVE, native + ticks_per_ms, 10, 20, 1, 2, 0, 0, 0);
+	input_event_post_touch_at(INPUTEVENT_TOUCHBEGIN, native + 2 * ticks_per_ms, 10, 20, 0, 0, 0, 0, 1);
+	input_event_post_acceleration_at(INPUTEVENT_ACCELERATION, native + 3 * ticks_per_ms, 0, 0, 1);
+	input_event_post_key(INPUTEVENT_KEYUP, KEY_A, 0, 0);
+	tick_t after = time_current();
+
+	int count = 0;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		if (count < 4)
+			EXPECT_TRUE(event->timestamp == native + (tick_t)count * ticks_per_ms);
+		else
+			EXPECT_TRUE((event->timestamp >= before) && (event->timestamp <= after));
+		++count;
+	}
+	EXPECT_INTEQ(count, 5);
+
+	// Latency is measured from the native timestamp
+	input_statistics_t statistics;
+	input_statistics(&statistics);
+	EXPECT_GE(statistics.latency_max, 17000000);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, text) {
+	// Text longer than one event with a three byte code point straddling the event size, so the
+	// first run ends one code point early at 23 bytes
+	static const char text[] = "Typing \xc3\xa5\xc3\xa4\xc3\xb6 in \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e in one commit";
+	const size_t length = sizeof(text) - 1;
+
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	for (int icompact = 0; icompact < 2; ++icompact) {
+		config.event_text_runs = true;
+		config.event_compact = (icompact != 0);
+		EXPECT_INTEQ(input_module_initialize(config), 0);
+		input_event_post_text(text, length);
+		input_event_process();
+
+		char received[sizeof(text)];
+		size_t offset = 0;
+		int events = 0;
+		input_event_payload_t payload;
+		event_block_t* block = event_stream_process(input_event_stream());
+		event_t* event = 0;
+		while ((event = event_next(block, event))) {
+			EXPECT_INTEQ(event->id, INPUTEVENT_TEXT);
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			EXPECT_TRUE(payload.text.length <= INPUT_TEXT_MAX);
+			EXPECT_NE(payload.text.text[0] & 0xC0, 0x80);
+			EXPECT_TRUE(offset + payload.text.length <= length);
+			memcpy(received + offset, payload.text.text, payload.text.length);
+			offset += payload.text.length;
+			++events;
+		}
+		EXPECT_SIZEEQ(offset, length);
+		EXPECT_EQ(memcmp(received, text, length), 0);
+		EXPECT_INTEQ(events, 2);
+		input_module_finalize();
+	}
+
+	// Without text runs each code point is a character event
+	config.event_text_runs = false;
+	config.event_compact = false;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+	input_event_post_text(STRING_CONST("a\xc3\xa5\xe6\x97\xa5"));
+	input_event_process();
+	static const unsigned int expect[] = {'a', 0xe5, 0x65e5};
+	int count = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_INTEQ(event->id, INPUTEVENT_CHAR);
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		EXPECT_INTLT(count, 3);
+		EXPECT_UINTEQ(payload.key.key, expect[count]);
+		++count;
+	}
+	EXPECT_INTEQ(count, 3);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, velocity) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 256;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	// Linear motion at 1000 px/s right and 250 px/s up, sampled every 8ms up to now
+	tick_t ticks_per_ms = time_ticks_per_second() / 1000;
+	tick_t now = time_current();
+	const int samples = 10;
+	for (int isample = 0; isample < samples; ++isample) {
+		tick_t timestamp = now - (tick_t)((samples - 1 - isample) * 8) * ticks_per_ms;
+		input_event_id id = isample ? INPUTEVENT_TOUCHMOVE : INPUTEVENT_TOUCHBEGIN;
+		input_event_post_touch_at(id, timestamp, 100 + isample * 8, 500 - isample * 2, 0, 0, 0, 1, 0x2);
+	}
+	input_event_process();
+
+	real vx, vy;
+	EXPECT_TRUE(input_velocity_touch(1, &vx, &vy));
+	EXPECT_TRUE(math_abs(vx - REAL_C(1000.0)) < REAL_C(10.0));
+	EXPECT_TRUE(math_abs(vy + REAL_C(250.0)) < REAL_C(2.5));
+	EXPECT_FALSE(input_velocity_touch(2, &vx, &vy));
+	EXPECT_REALZERO(vx);
+
+	int count = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		if (event->id == INPUTEVENT_TOUCHMOVE)
+			EXPECT_TRUE(math_abs(payload.touch.velocity - REAL_C(1030.8)) < REAL_C(10.0));
+		++count;
+	}
+	EXPECT_INTEQ(count, samples);
+
+	// Circular motion with radius 200 at one revolution per second, the speed along the arc is
+	// 400pi px/s where the chord between the first and last sample of the horizon is shorter
+	now = time_current();
+	const int circle = 63;
+	for (int isample = 0; isample < circle; ++isample) {
+		tick_t timestamp = now - (tick_t)((circle - 1 - isample) * 8) * ticks_per_ms;
+		real angle = REAL_TWOPI * (real)(isample * 8) / REAL_C(1000.0);
+		int x = 500 + (int)math_round(REAL_C(200.0) * math_cos(angle));
+		int y = 500 + (int)math_round(REAL_C(200.0) * math_sin(angle));
+		input_event_id id = isample ? INPUTEVENT_TOUCHMOVE : INPUTEVENT_TOUCHBEGIN;
+		input_event_post_touch_at(id, timestamp, x, y, 0, 0, 0, 0, 0x1);
+	}
+	input_event_process();
+
+	real velocity = 0;
+	block = event_stream_process(input_event_stream());
+	event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		velocity = payload.touch.velocity;
+	}
+	EXPECT_TRUE(math_abs(velocity - REAL_C(400.0) * REAL_PI) < REAL_C(0.03) * REAL_C(400.0) * REAL_PI);
+
+	// Mouse motion older than the horizon is not reported, recent motion is
+	now = time_current();
+	for (int isample = 0; isample < 4; ++isample) {
+		tick_t timestamp = now - (tick_t)(200 - isample * 8) * ticks_per_ms;
+		input_event_post_mouse_at(INPUTEVENT_MOUSEMOVE, timestamp, isample * 4, 0, 4, 0, 0, 0, 0);
+	}
+	input_event_process();
+	EXPECT_FALSE(input_velocity_mouse(&vx, &vy));
+	EXPECT_REALZERO(vx);
+
+	now = time_current();
+	for (int isample = 0; isample < 4; ++isample) {
+		tick_t timestamp = now - (tick_t)(24 - isample * 8) * ticks_per_ms;
+		input_event_post_mouse_at(INPUTEVENT_MOUSEMOVE, timestamp, 0, isample * 4, 0, 4, 0, 0, 0);
+	}
+	input_event_process();
+	EXPECT_TRUE(input_velocity_mouse(&vx, &vy));
+	EXPECT_TRUE(math_abs(vx) < REAL_C(1.0));
+	EXPECT_TRUE(math_abs(vy - REAL_C(500.0)) < REAL_C(5.0));
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, condition) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	// Mouse x with a dead zone of a tenth of a range of 100 and doubled output, mouse y with a
+	// cubic response curve, the wheel passes through unchanged
+	input_condition_t condition;
+	memset(&condition, 0, sizeof(condition));
+	condition.range = REAL_C(100.0);
+	condition.deadzone = REAL_C(0.1);
+	condition.scale = REAL_TWO;
+	input_condition_set(INPUTCHANNEL_MOUSE_DX, 1, &condition);
+	memset(&condition, 0, sizeof(condition));
+	condition.curve = REAL_ONE;
+	input_condition_set(INPUTCHANNEL_MOUSE_DY, 1, &condition);
+	EXPECT_REALEQ(input_condition(INPUTCHANNEL_MOUSE_DY).curve, REAL_ONE);
+	EXPECT_REALEQ(input_condition(INPUTCHANNEL_MOUSE_DX).deadzone, REAL_C(0.1));
+
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 0, 0, REAL_C(5.0), REAL_HALF, REAL_C(3.0), 0, 0);
+	input_event_process();
+	EXPECT_REALEQ(input_channel_raw(INPUTCHANNEL_MOUSE_DX), REAL_C(5.0));
+	EXPECT_REALZERO(input_channel_value(INPUTCHANNEL_MOUSE_DX));
+	EXPECT_REALEQ(input_channel_value(INPUTCHANNEL_MOUSE_DY), REAL_C(0.125));
+	EXPECT_REALEQ(input_channel_value(INPUTCHANNEL_MOUSE_WHEEL), REAL_C(3.0));
+
+	// Past the dead zone the rest of the range is stretched, 0.55 is half way from 0.1 to 1
+	input_event_post_mouse(INPUTEVENT_MOUSEMOVE, 0, 0, REAL_C(-55.0), -REAL_HALF, 0, 0, 0);
+	input_event_process();
+	EXPECT_TRUE(math_abs(input_channel_value(INPUTCHANNEL_MOUSE_DX) + REAL_C(100.0)) < REAL_C(0.001));
+	EXPECT_REALEQ(input_channel_value(INPUTCHANNEL_MOUSE_DY), REAL_C(-0.125));
+	EXPECT_REALZERO(input_channel_values()[INPUTCHANNEL_MOUSE_WHEEL]);
+
+	// Acceleration x smoothed exponentially and y with One Euro filtering, which follows a step
+	// faster. The first snapshot after configuration starts the filter at the raw value
+	memset(&condition, 0, sizeof(condition));
+	condition.cutoff = REAL_ONE;
+	input_condition_set(INPUTCHANNEL_ACCELERATION_X, 1, &condition);
+	condition.beta = REAL_ONE;
+	input_condition_set(INPUTCHANNEL_ACCELERATION_Y, 1, &condition);
+	input_event_post_acceleration(INPUTEVENT_ACCELERATION, REAL_ONE, REAL_ONE, REAL_ONE);
+	input_event_process();
+	EXPECT_REALEQ(input_channel_value(INPUTCHANNEL_ACCELERATION_X), REAL_ONE);
+	EXPECT_REALEQ(input_channel_value(INPUTCHANNEL_ACCELERATION_Y), REAL_ONE);
+
+	input_event_post_acceleration(INPUTEVENT_ACCELERATION, 0, 0, 0);
+	thread_sleep(10);
+	input_event_process();
+	real smoothed = input_channel_value(INPUTCHANNEL_ACCELERATION_X);
+	EXPECT_GT(smoothed, 0);
+	EXPECT_LT(smoothed, REAL_ONE);
+	EXPECT_LT(input_channel_value(INPUTCHANNEL_ACCELERATION_Y), smoothed);
+	EXPECT_REALZERO(input_channel_value(INPUTCHANNEL_ACCELERATION_Z));
+	thread_sleep(10);
+	input_event_process();
+	EXPECT_LT(input_channel_value(INPUTCHANNEL_ACCELERATION_X), smoothed);
+
+	// Resetting passes values through again
+	input_condition_set(INPUTCHANNEL_ACCELERATION_X, 2, 0);
+	input_event_process();
+	EXPECT_REALZERO(input_channel_value(INPUTCHANNEL_ACCELERATION_X));
+	EXPECT_REALZERO(input_condition(INPUTCHANNEL_ACCELERATION_Y).cutoff);
+
+	EXPECT_INTEQ(input_channel_pad(0, PADAXIS_LEFT_X), INPUTCHANNEL_PAD);
+	EXPECT_INTEQ(input_channel_pad(INPUT_PAD_MAX - 1, PADAXIS_RIGHT_TRIGGER), INPUTCHANNEL_COUNT - 1);
+	EXPECT_REALZERO(input_channel_value(input_channel_pad(0, PADAXIS_LEFT_X)));
+	EXPECT_REALZERO(input_channel_value(INPUTCHANNEL_COUNT));
+
+	input_module_finalize();
+	return 0;
+}
+
+#if FOUNDATION_PLATFORM_LINUX
+
+// Layout of struct input_event, linux/input.h collides with the key enumeration
+typedef struct {
+	struct timeval time;
+	uint16_t type;
+	uint16_t code;
+	int32_t value;
+} test_evdev_event_t;
+
+DECLARE_TEST(basic, evdev) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	int fds[2];
+	EXPECT_INTEQ(pipe(fds), 0);
+	EXPECT_TRUE(input_evdev_attach(fds[0]));
+	EXPECT_SIZEEQ(input_evdev_device_count(), 1);
+
+	// Stream as captured from device nodes: motion with wheel, a left click with motion while
+	// held, key A with autorepeat, a frame lost to SYN_DROPPED and a final motion frame
+	static const test_evdev_event_t stream[] = {
+	    {{0, 0}, 2, 0, 5},     {{0, 0}, 2, 1, -3}, {{0, 0}, 2, 8, 1}, {{0, 0}, 0, 0, 0},
+	    {{0, 0}, 1, 0x110, 1}, {{0, 0}, 0, 0, 0},
+	    {{0, 0}, 2, 0, 7},     {{0, 0}, 1, 0x110, 0}, {{0, 0}, 0, 0, 0},
+	    {{0, 0}, 1, 30, 1},    {{0, 0}, 0, 0, 0},
+	    {{0, 0}, 1, 30, 2},    {{0, 0}, 0, 0, 0},
+	    {{0, 0}, 1, 30, 0},    {{0, 0}, 0, 0, 0},
+	    {{0, 0}, 0, 3, 0},     {{0, 0}, 2, 0, 100}, {{0, 0}, 1, 31, 1}, {{0, 0}, 0, 0, 0},
+	    {{0, 0}, 2, 1, 4},     {{0, 0}, 0, 0, 0}};
+
+	// Split the first record across two reads
+	const char* bytes = (const char*)stream;
+	EXPECT_INTEQ((int)write(fds[1], bytes, 10), 10);
+	input_event_process();
+	EXPECT_INTEQ((int)write(fds[1], bytes + 10, sizeof(stream) - 10), (int)(sizeof(stream) - 10));
+	input_event_process();
+
+	static const struct {
+		input_event_id id;
+		int x;
+		int y;
+		int dx;
+		int dy;
+		int dz;
+		unsigned int button;
+		unsigned int buttons;
+	} expect_mouse[] = {{INPUTEVENT_MOUSEMOVE, 5, -3, 5, -3, 1, 0, 0},
+	                    {INPUTEVENT_MOUSEDOWN, 5, -3, 0, 0, 0, MOUSEBUTTON_LEFT, MOUSEBUTTON_LEFT},
+	                    {INPUTEVENT_MOUSEMOVE, 12, -3, 7, 0, 0, 0, MOUSEBUTTON_LEFT},
+	                    {INPUTEVENT_MOUSEUP, 12, -3, 0, 0, 0, MOUSEBUTTON_LEFT, 0}};
+
+	int count = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		input_event_decode(event, &payload);
+		if (count < 4) {
+			EXPECT_INTEQ(event->id, expect_mouse[count].id);
+			EXPECT_INTEQ(payload.mouse.x, expect_mouse[count].x);
+			EXPECT_INTEQ(payload.mouse.y, expect_mouse[count].y);
+			EXPECT_UINTEQ(payload.mouse.button, expect_mouse[count].button);
+			EXPECT_UINTEQ(payload.mouse.buttons, expect_mouse[count].buttons);
+			if (event->id == INPUTEVENT_MOUSEMOVE) {
+				EXPECT_REALEQ(payload.mouse.dx, (real)expect_mouse[count].dx);
+				EXPECT_REALEQ(payload.mouse.dy, (real)expect_mouse[count].dy);
+				EXPECT_REALEQ(payload.mouse.dz, (real)expect_mouse[count].dz);
+			}
+		} else if (count < 6) {
+			EXPECT_INTEQ(event->id, (count == 4) ? INPUTEVENT_KEYDOWN : INPUTEVENT_KEYUP);
+			EXPECT_UINTEQ(payload.key.key, KEY_A);
+			EXPECT_UINTEQ(payload.key.scancode, 30);
+		} else {
+			// Events of the dropped frame are discarded
+			EXPECT_INTEQ(event->id, INPUTEVENT_MOUSEMOVE);
+			EXPECT_INTEQ(payload.mouse.x, 12);
+			EXPECT_INTEQ(payload.mouse.y, 1);
+		}
+		++count;
+	}
+	EXPECT_INTEQ(count, 7);
+
+	// End of stream detaches the device
+	close(fds[1]);
+	input_event_process();
+	EXPECT_SIZEEQ(input_evdev_device_count(), 0);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(basic, evdev_thread) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.thread = true;
+	config.thread_affinity = 1;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	int fds[2];
+	EXPECT_INTEQ(pipe(fds), 0);
+	EXPECT_TRUE(input_evdev_attach(fds[0]));
+
+	static const test_evdev_event_t stream[] = {
+	    {{0, 0}, 1, 30, 1}, {{0, 0}, 0, 0, 0}, {{0, 0}, 1, 30, 0}, {{0, 0}, 0, 0, 0}};
+	EXPECT_INTEQ((int)write(fds[1], stream, sizeof(stream)), (int)sizeof(stream));
+
+	// Events are posted by the input thread without calling input_event_process
+	int count = 0;
+	input_event_payload_t payload;
+	for (int iwait = 0; (iwait < 1000) && (count < 2); ++iwait) {
+		event_block_t* block = event_stream_process(input_event_stream());
+		event_t* event = 0;
+		while ((event = event_next(block, event))) {
+			EXPECT_INTEQ(event->id, count ? INPUTEVENT_KEYUP : INPUTEVENT_KEYDOWN);
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			EXPECT_UINTEQ(payload.key.key, KEY_A);
+			++count;
+		}
+		if (count < 2)
+			thread_sleep(1);
+	}
+	EXPECT_INTEQ(count, 2);
+
+	// End of stream is seen by the input thread which detaches the device
+	close(fds[1]);
+	for (int iwait = 0; (iwait < 1000) && input_evdev_device_count(); ++iwait)
+		thread_sleep(1);
+	EXPECT_SIZEEQ(input_evdev_device_count(), 0);
+
+	input_module_finalize();
+	return 0;
+}
+
+static test_evdev_event_t test_pad_stream[2010];
+
+DECLARE_TEST(basic, pad) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	int fds[2];
+	EXPECT_INTEQ(pipe(fds), 0);
+	EXPECT_INTEQ(input_evdev_attach_pad(fds[0]), 0);
+
+	// Sticks at full deflection, left trigger pulled, south button and hat left pressed, then
+	// a thousand frames of right stick motion as from a 1 kHz pad and a release of the buttons
+	size_t count = 0;
+	test_evdev_event_t* stream = test_pad_stream;
+	stream[count++] = (test_evdev_event_t){{0, 0}, 3, 0x00, 32767};
+	stream[count++] = (test_evdev_event_t){{0, 0}, 3, 0x01, -32768};
+	stream[count++] = (test_evdev_event_t){{0, 0}, 3, 0x02, 255};
+	stream[count++] = (test_evdev_event_t){{0, 0}, 1, 0x130, 1};
+	stream[count++] = (test_evdev_event_t){{0, 0}, 3, 0x10, -1};
+	stream[count++] = (test_evdev_event_t){{0, 0}, 0, 0, 0};
+	for (int32_t iframe = 0; iframe < 1000; ++iframe) {
+		stream[count++] = (test_evdev_event_t){{0, 0}, 3, 0x03, iframe * 32};
+		stream[count++] = (test_evdev_event_t){{0, 0}, 0, 0, 0};
+	}
+	stream[count++] = (test_evdev_event_t){{0, 0}, 1, 0x130, 0};
+	stream[count++] = (test_evdev_event_t){{0, 0}, 3, 0x10, 0};
+	stream[count++] = (test_evdev_event_t){{0, 0}, 0, 0, 0};
+	size_t bytes = count * sizeof(test_evdev_event_t);
+	EXPECT_INTEQ((int)write(fds[1], stream, bytes), (int)bytes);
+	input_event_process();
+
+	// Axis motion is kept in the pad state, only connection and buttons are posted
+	static const struct {
+		input_event_id id;
+		unsigned int button;
+		unsigned int buttons;
+	} expect[] = {{INPUTEVENT_PADCONNECT, 0, 0},
+	              {INPUTEVENT_PADBUTTONDOWN, PADBUTTON_SOUTH, PADBUTTON_SOUTH},
+	              {INPUTEVENT_PADBUTTONDOWN, PADBUTTON_DPAD_LEFT, PADBUTTON_SOUTH | PADBUTTON_DPAD_LEFT},
+	              {INPUTEVENT_PADBUTTONUP, PADBUTTON_SOUTH, PADBUTTON_DPAD_LEFT},
+	              {INPUTEVENT_PADBUTTONUP, PADBUTTON_DPAD_LEFT, 0}};
+	int events = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_INTLT(events, 5);
+		EXPECT_INTEQ(event->id, expect[events].id);
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		EXPECT_UINTEQ(payload.pad.pad, 0);
+		EXPECT_UINTEQ(payload.pad.button, expect[events].button);
+		EXPECT_UINTEQ(payload.pad.buttons, expect[events].buttons);
+		++events;
+	}
+	EXPECT_INTEQ(events, 5);
+
+	const input_pad_state_t* state = input_pad_state(0);
+	EXPECT_TRUE(state->connected);
+	EXPECT_UINTEQ(state->buttons, 0);
+	EXPECT_TRUE(input_pad_button_pressed(0, PADBUTTON_SOUTH));
+	EXPECT_TRUE(input_pad_button_released(0, PADBUTTON_DPAD_LEFT));
+	EXPECT_FALSE(input_pad_button_down(0, PADBUTTON_SOUTH));
+	EXPECT_REALEQ(input_pad_axis(0, PADAXIS_LEFT_X), REAL_ONE);
+	EXPECT_REALEQ(input_pad_axis(0, PADAXIS_LEFT_Y), -REAL_ONE);
+	EXPECT_REALEQ(input_pad_axis(0, PADAXIS_LEFT_TRIGGER), REAL_ONE);
+	EXPECT_REALEQ(input_pad_axis(0, PADAXIS_RIGHT_TRIGGER), 0);
+	EXPECT_TRUE((input_pad_axis(0, PADAXIS_RIGHT_X) > REAL_C(0.97)) &&
+	            (input_pad_axis(0, PADAXIS_RIGHT_X) < REAL_C(0.98)));
+	EXPECT_FALSE(input_pad_state(1)->connected);
+	EXPECT_EQ(input_pad_state(INPUT_PAD_MAX), 0);
+
+	close(fds[1]);
+	input_event_process();
+	EXPECT_FALSE(input_pad_state(0)->connected);
+	EXPECT_FALSE(input_pad_button_pressed(0, PADBUTTON_SOUTH));
+
+	input_module_finalize();
+	return 0;
+}
+
+static void
+test_iio_write(const char* dir, const char* name, const char* value) {
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	FILE* file = fopen(path, "wb");
+	if (file) {
+		fputs(value, file);
+		fclose(file);
+	}
+}
+
+static bool
+test_iio_attribute(const char* dir, const char* name, const char* expect) {
+	char path[512];
+	char value[64];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		return false;
+	size_t size = fread(value, 1, sizeof(value) - 1, file);
+	fclose(file);
+	while (size && (value[size - 1] == '\n'))
+		--size;
+	value[size] = 0;
+	return strcmp(value, expect) == 0;
+}
+
+static void
+test_iio_store(uint8_t* dest, uint64_t value, size_t bytes, bool big_endian) {
+	for (size_t ibyte = 0; ibyte < bytes; ++ibyte)
+		dest[big_endian ? (bytes - 1 - ibyte) : ibyte] = (uint8_t)(value >> (8 * ibyte));
+}
+
+DECLARE_TEST(basic, iio) {
+	char base[256];
+	char sysfs[256];
+	char devfs[256];
+	char device[256];
+	char adc[256];
+	string_const_t temp = environment_temporary_directory();
+	EXPECT_INTLT(snprintf(base, sizeof(base), "%.*s/input_iio", STRING_FORMAT(temp)), (int)sizeof(base));
+	EXPECT_INTLT(snprintf(sysfs, sizeof(sysfs), "%s/sys", base), (int)sizeof(sysfs));
+	EXPECT_INTLT(snprintf(devfs, sizeof(devfs), "%s/dev", base), (int)sizeof(devfs));
+	EXPECT_INTLT(snprintf(device, sizeof(device), "%s/iio:device0", sysfs), (int)sizeof(device));
+	EXPECT_INTLT(snprintf(adc, sizeof(adc), "%s/iio:device1", sysfs), (int)sizeof(adc));
+	fs_remove_directory(base, string_length(base));
+	char path[512];
+	snprintf(path, sizeof(path), "%s/scan_elements", device);
+	fs_make_directory(path, string_length(path));
+	snprintf(path, sizeof(path), "%s/buffer", device);
+	fs_make_directory(path, string_length(path));
+	snprintf(path, sizeof(path), "%s/scan_elements", adc);
+	fs_make_directory(path, string_length(path));
+	fs_make_directory(devfs, string_length(devfs));
+
+	// An accelerometer and gyroscope with mixed endianness, a 12-bit axis in the upper bits of
+	// its storage and 32-bit gyroscope axes aligned after the 16-bit accelerometer axes, giving
+	// a 32 byte scan: accel at 0, 2 and 4, anglvel at 8, 12 and 16 and timestamp at 24
+	test_iio_write(device, "name", "test_imu\n");
+	test_iio_write(device, "buffer/enable", "0\n");
+	test_iio_write(device, "buffer/length", "2\n");
+	test_iio_write(device, "sampling_frequency", "100\n");
+	test_iio_write(device, "current_timestamp_clock", "realtime\n");
+	test_iio_write(device, "in_accel_scale", "0.5\n");
+	test_iio_write(device, "in_accel_z_offset", "-2\n");
+	test_iio_write(device, "in_anglvel_scale", "0.5\n");
+	static const char* element[] = {"accel_x",   "accel_y",   "accel_z",  "anglvel_x",
+	                                "anglvel_y", "anglvel_z", "timestamp"};
+	static const char* type[] = {"le:s16/16>>0", "be:s16/16>>0", "le:s12/16>>4", "le:s32/32>>0",
+	                             "le:s32/32>>0", "le:s32/32>>0", "le:s64/64>>0"};
+	for (int ielement = 0; ielement < 7; ++ielement) {
+		char name[64];
+		char index[16];
+		snprintf(name, sizeof(name), "scan_elements/in_%s_en", element[ielement]);
+		test_iio_write(device, name, "0\n");
+		snprintf(name, sizeof(name), "scan_elements/in_%s_index", element[ielement]);
+		snprintf(index, sizeof(index), "%d\n", ielement);
+		test_iio_write(device, name, index);
+		snprintf(name, sizeof(name), "scan_elements/in_%s_type", element[ielement]);
+		test_iio_write(device, name, type[ielement]);
+	}
+	// A converter without accelerometer or gyroscope channels is not touched
+	test_iio_write(adc, "name", "test_adc\n");
+	test_iio_write(adc, "scan_elements/in_voltage0_en", "0\n");
+
+	// Samples one millisecond apart ending now, followed by half a scan
+	const int samples = 100;
+	static uint8_t stream[(100 * 32) + 16];
+	memset(stream, 0, sizeof(stream));
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t now_ns = ((int64_t)now.tv_sec * 1000000000LL) + now.tv_nsec;
+	tick_t before = time_current();
+	for (int isample = 0; isample < samples; ++isample) {
+		uint8_t* scan = stream + (isample * 32);
+		test_iio_store(scan + 0, (uint64_t)(int64_t)(2 * isample), 2, false);
+		test_iio_store(scan + 2, (uint64_t)(int64_t)(-2 * isample), 2, true);
+		test_iio_store(scan + 4, ((uint64_t)(isample - 50) & 0xfff) << 4, 2, false);
+		test_iio_store(scan + 8, (uint64_t)(int64_t)(2 * isample), 4, false);
+		test_iio_store(scan + 12, (uint64_t)(int64_t)-2, 4, false);
+		test_iio_store(scan + 24, (uint64_t)(now_ns - ((samples - 1 - isample) * 1000000LL)), 8, false);
+	}
+	snprintf(path, sizeof(path), "%s/iio:device0", devfs);
+	FILE* file = fopen(path, "wb");
+	EXPECT_NE(file, 0);
+	EXPECT_SIZEEQ(fwrite(stream, 1, sizeof(stream), file), sizeof(stream));
+	fclose(file);
+
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.sensor_rate = 200;
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+	EXPECT_SIZEEQ(input_iio_scan(sysfs, string_length(sysfs), devfs, string_length(devfs)), 1);
+	EXPECT_SIZEEQ(input_iio_device_count(), 1);
+	EXPECT_TRUE(test_iio_attribute(device, "buffer/enable", "1"));
+	EXPECT_TRUE(test_iio_attribute(device, "sampling_frequency", "200"));
+	EXPECT_TRUE(test_iio_attribute(device, "current_timestamp_clock", "monotonic"));
+	EXPECT_TRUE(test_iio_attribute(device, "scan_elements/in_anglvel_z_en", "1"));
+	EXPECT_TRUE(test_iio_attribute(adc, "scan_elements/in_voltage0_en", "0"));
+
+	// The stream is read in two batches, then the device closes at end of file
+	input_event_process();
+	tick_t after = time_current();
+	EXPECT_SIZEEQ(input_iio_device_count(), 0);
+	EXPECT_TRUE(test_iio_attribute(device, "buffer/enable", "0"));
+
+	int acceleration = 0;
+	int rotation = 0;
+	tick_t previous = 0;
+	input_event_payload_t payload;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		EXPECT_TRUE((event->timestamp >= previous) && (event->timestamp <= after));
+		EXPECT_TRUE(event->timestamp + (time_ticks_per_second() / 5) >= before);
+		previous = event->timestamp;
+		if (event->id == INPUTEVENT_ACCELERATION) {
+			EXPECT_INTEQ(acceleration, rotation);
+			real index = (real)acceleration;
+			EXPECT_REALEQ(payload.acceleration.x, index);
+			EXPECT_REALEQ(payload.acceleration.y, -index);
+			EXPECT_REALEQ(payload.acceleration.z, (index - REAL_C(52.0)) * REAL_HALF);
+			++acceleration;
+		} else {
+			EXPECT_INTEQ(event->id, INPUTEVENT_ROTATION);
+			EXPECT_INTEQ(rotation + 1, acceleration);
+			EXPECT_REALEQ(payload.acceleration.x, (real)rotation);
+			EXPECT_REALEQ(payload.acceleration.y, -REAL_ONE);
+			EXPECT_REALZERO(payload.acceleration.z);
+			++rotation;
+		}
+	}
+	EXPECT_INTEQ(acceleration, samples);
+	EXPECT_INTEQ(rotation, samples);
+
+	input_module_finalize();
+	fs_remove_directory(base, string_length(base));
+	return 0;
+}
+
+static XGenericEventCookie
+test_xinput_cookie(int opcode, int evtype, void* data) {
+	XGenericEventCookie cookie;
+	memset(&cookie, 0, sizeof(cookie));
+	cookie.type = GenericEvent;
+	cookie.extension = opcode;
+	cookie.evtype = evtype;
+	cookie.data = data;
+	return cookie;
+}
+
+static XIDeviceEvent
+test_xinput_touch(int evtype, int device, int detail, double x, double y, Time time) {
+	XIDeviceEvent event;
+	memset(&event, 0, sizeof(event));
+	event.type = GenericEvent;
+	event.evtype = evtype;
+	event.time = time;
+	event.deviceid = 2;
+	event.sourceid = device;
+	event.detail = detail;
+	event.event_x = x;
+	event.event_y = y;
+	return event;
+}
+
+DECLARE_TEST(basic, xinput) {
+	// Requires an X server, run under Xvfb to test without a display
+	Display* display = XOpenDisplay(0);
+	if (!display) {
+		log_info(HASH_TEST, STRING_CONST("No X display, skipping XInput2 test"));
+		return 0;
+	}
+	Window window = XCreateSimpleWindow(display, DefaultRootWindow(display), 0, 0, 64, 64, 0, 0, 0);
+
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+	if (!input_xinput_enable(display, window)) {
+		log_info(HASH_TEST, STRING_CONST("No XInput 2.2, skipping XInput2 test"));
+		input_module_finalize();
+		XDestroyWindow(display, window);
+		XCloseDisplay(display);
+		return 0;
+	}
+
+	int opcode = 0, event_base = 0, error_base = 0;
+	EXPECT_TRUE(XQueryExtension(display, "XInputExtension", &opcode, &event_base, &error_base));
+
+	// Two touches from different devices, the first moving and ending
+	XIDeviceEvent touch[4] = {test_xinput_touch(XI_TouchBegin, 12, 100, 10.5, 20.25, 1000),
+	                          test_xinput_touch(XI_TouchUpdate, 12, 100, 15.0, 25.0, 1010),
+	                          test_xinput_touch(XI_TouchBegin, 13, 100, 40.0, 50.0, 1020),
+	                          test_xinput_touch(XI_TouchEnd, 12, 100, 16.0, 24.0, 1030)};
+	for (int itouch = 0; itouch < 4; ++itouch) {
+		XGenericEventCookie cookie = test_xinput_cookie(opcode, touch[itouch].evtype, touch + itouch);
+		EXPECT_TRUE(input_xinput_handle_event(&cookie));
+	}
+	EXPECT_INTEQ(input_xinput_touch_device(0), -1);
+	EXPECT_INTEQ(input_xinput_touch_device(1), 13);
+
+	// Raw motion from the first relative pointer device the server reports, usually the XTEST
+	// pointer, with values for x and y and a vertical scroll valuator
+	int relative = -1;
+	for (int device = 0; (device < 256) && (relative < 0); ++device) {
+		if (input_xinput_relative_device(device))
+			relative = device;
+	}
+	unsigned char mask[1] = {0x0b};
+	double raw_values[3] = {1.5, -2.25, 1.0};
+	XIRawEvent raw;
+	memset(&raw, 0, sizeof(raw));
+	raw.type = GenericEvent;
+	raw.evtype = XI_RawMotion;
+	raw.time = 1040;
+	raw.deviceid = 2;
+	raw.sourceid = relative;
+	raw.valuators.mask_len = sizeof(mask);
+	raw.valuators.mask = mask;
+	raw.raw_values = raw_values;
+	XGenericEventCookie cookie = test_xinput_cookie(opcode, XI_RawMotion, &raw);
+	EXPECT_TRUE(input_xinput_handle_event(&cookie));
+
+	// Raw motion is ignored until the window has focus, then folded into the next core motion
+	XIFocusInEvent focus;
+	memset(&focus, 0, sizeof(focus));
+	focus.type = GenericEvent;
+	focus.evtype = XI_FocusIn;
+	focus.deviceid = 3;
+	focus.event = window;
+	cookie = test_xinput_cookie(opcode, XI_FocusIn, &focus);
+	EXPECT_TRUE(input_xinput_handle_event(&cookie));
+	cookie = test_xinput_cookie(opcode, XI_RawMotion, &raw);
+	EXPECT_TRUE(input_xinput_handle_event(&cookie));
+
+	struct {
+		window_t* window;
+		XEvent xevent;
+	} data;
+	memset(&data, 0, sizeof(data));
+	data.xevent.type = MotionNotify;
+	data.xevent.xmotion.display = display;
+	data.xevent.xmotion.window = window;
+	data.xevent.xmotion.time = 1040;
+	data.xevent.xmotion.x = 30;
+	data.xevent.xmotion.y = 31;
+	event_stream_t* native = event_stream_allocate(0);
+	event_post(native, WINDOWEVENT_NATIVE, 0, 0, &data, sizeof(data));
+	event_block_t* block = event_stream_process(native);
+	event_t* event = 0;
+	while ((event = event_next(block, event)))
+		input_event_handle_window(event);
+	event_stream_deallocate(native);
+
+	// Events of other extensions are not handled
+	cookie = test_xinput_cookie(opcode + 1, XI_RawMotion, &raw);
+	EXPECT_FALSE(input_xinput_handle_event(&cookie));
+
+	input_event_process();
+
+	static const struct {
+		input_event_id id;
+		int x;
+		int y;
+		int dx;
+		int dy;
+		unsigned int touch;
+		unsigned int touches;
+	} expect[] = {{INPUTEVENT_TOUCHBEGIN, 10, 20, 0, 0, 0, 0x1},
+	              {INPUTEVENT_TOUCHMOVE, 15, 25, 5, 5, 0, 0x1},
+	              {INPUTEVENT_TOUCHBEGIN, 40, 50, 0, 0, 1, 0x3},
+	              {INPUTEVENT_TOUCHEND, 16, 24, 1, -1, 0, 0x2}};
+
+	int count = 0;
+	int moves = 0;
+	input_event_payload_t payload;
+	block = event_stream_process(input_event_stream());
+	event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		if (event->id == INPUTEVENT_MOUSEMOVE) {
+			EXPECT_INTEQ(payload.mouse.x, 30);
+			EXPECT_INTEQ(payload.mouse.y, 31);
+			EXPECT_REALEQ(payload.mouse.dx, (relative >= 0) ? REAL_C(1.5) : 0);
+			EXPECT_REALEQ(payload.mouse.dy, (relative >= 0) ? REAL_C(-2.25) : 0);
+			++moves;
+			continue;
+		}
+		EXPECT_INTLT(count, 4);
+		EXPECT_INTEQ(event->id, expect[count].id);
+		EXPECT_INTEQ(payload.touch.x, expect[count].x);
+		EXPECT_INTEQ(payload.touch.y, expect[count].y);
+		EXPECT_REALEQ(payload.touch.dx, (real)expect[count].dx);
+		EXPECT_REALEQ(payload.touch.dy, (real)expect[count].dy);
+		EXPECT_UINTEQ(payload.touch.touch, expect[count].touch);
+		EXPECT_UINTEQ(payload.touch.touches, expect[count].touches);
+		++count;
+	}
+	EXPECT_INTEQ(count, 4);
+	EXPECT_INTEQ(moves, 1);
+
+	// Core motion without raw motion before it, as from absolute devices, keeps the position delta
+	data.xevent.xmotion.time = 1050;
+	data.xevent.xmotion.x = 35;
+	data.xevent.xmotion.y = 29;
+	native = event_stream_allocate(0);
+	event_post(native, WINDOWEVENT_NATIVE, 0, 0, &data, sizeof(data));
+	block = event_stream_process(native);
+	event = 0;
+	while ((event = event_next(block, event)))
+		input_event_handle_window(event);
+	event_stream_deallocate(native);
+	input_event_process();
+
+	moves = 0;
+	block = event_stream_process(input_event_stream());
+	event = 0;
+	while ((event = event_next(block, event))) {
+		EXPECT_INTEQ(event->id, INPUTEVENT_MOUSEMOVE);
+		EXPECT_TRUE(input_event_decode(event, &payload));
+		EXPECT_INTEQ(payload.mouse.x, 35);
+		EXPECT_REALEQ(payload.mouse.dx, REAL_C(5.0));
+		EXPECT_REALEQ(payload.mouse.dy, REAL_C(-2.0));
+		++moves;
+	}
+	EXPECT_INTEQ(moves, 1);
+
+	input_xinput_disable();
+	cookie = test_xinput_cookie(opcode, XI_RawMotion, &raw);
+	EXPECT_FALSE(input_xinput_handle_event(&cookie));
+
+	// Enabling again after disabling reuses the loaded library
+	EXPECT_TRUE(input_xinput_enable(display, window));
+	input_xinput_disable();
+	input_module_finalize();
+	XDestroyWindow(display, window);
+	XCloseDisplay(display);
+	return 0;
+}
+
+DECLARE_TEST(basic, x11_keys) {
+	Display* display = XOpenDisplay(0);
+	if (!display) {
+		log_info(HASH_TEST, STRING_CONST("No X display, skipping X11 key test"));
+		return 0;
+	}
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	// Keys from the contiguous keysym ranges and from the sorted keysym table
+	static const struct {
+		KeySym sym;
+		unsigned int key;
+	} keys[] = {{XK_a, KEY_A},         {XK_5, KEY_5},           {XK_F2, KEY_F2},         {XK_Escape, KEY_ESCAPE},
+	            {XK_space, KEY_SPACE}, {XK_Shift_L, KEY_LSHIFT}, {XK_Delete, KEY_DELETE}, {XK_Left, KEY_LEFT},
+	            {XK_apostrophe, KEY_APOSTROPHE}};
+	const size_t key_count = sizeof(keys) / sizeof(keys[0]);
+	struct {
+		window_t* window;
+		XEvent xevent;
+	} data;
+	memset(&data, 0, sizeof(data));
+	data.xevent.type = KeyRelease;
+	data.xevent.xkey.display = display;
+	event_stream_t* native = event_stream_allocate(0);
+	for (int ipass = 0; ipass < 2; ++ipass) {
+		// Second pass after a mapping change rebuilds the keycode table
+		if (ipass) {
+			data.xevent.type = MappingNotify;
+			data.xevent.xmapping.display = display;
+			data.xevent.xmapping.request = MappingKeyboard;
+			data.xevent.xmapping.first_keycode = 8;
+			data.xevent.xmapping.count = 248;
+			event_post(native, WINDOWEVENT_NATIVE, 0, 0, &data, sizeof(data));
+			memset(&data.xevent, 0, sizeof(data.xevent));
+			data.xevent.type = KeyRelease;
+			data.xevent.xkey.display = display;
+		}
+		for (size_t ikey = 0; ikey < key_count; ++ikey) {
+			data.xevent.xkey.keycode = XKeysymToKeycode(display, keys[ikey].sym);
+			event_post(native, WINDOWEVENT_NATIVE, 0, 0, &data, sizeof(data));
+		}
+		event_block_t* block = event_stream_process(native);
+		event_t* event = 0;
+		while ((event = event_next(block, event)))
+			input_event_handle_window(event);
+		input_event_process();
+
+		size_t count = 0;
+		input_event_payload_t payload;
+		block = event_stream_process(input_event_stream());
+		event = 0;
+		while ((event = event_next(block, event))) {
+			EXPECT_INTEQ(event->id, INPUTEVENT_KEYUP);
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			EXPECT_TRUE(count < key_count);
+			// Keysyms missing from the server keymap have no keycode
+			if (!XKeysymToKeycode(display, keys[count].sym))
+				EXPECT_UINTEQ(payload.key.key, KEY_UNKNOWN);
+			else
+				EXPECT_UINTEQ(payload.key.key, keys[count].key);
+			++count;
+		}
+		EXPECT_SIZEEQ(count, key_count);
+	}
+
+	event_stream_deallocate(native);
+	input_module_finalize();
+	XCloseDisplay(display);
+	return 0;
+}
+
+#endif
+
 static void
 test_basic_declare(void) {
 	ADD_TEST(basic, initfini);
+	ADD_TEST(basic, event_ring);
+	ADD_TEST(basic, event_compact);
+	ADD_TEST(basic, event_batch);
+	ADD_TEST(basic, event_coalesce);
+	ADD_TEST(basic, event_overflow);
+	ADD_TEST(basic, event_broadcast);
+	ADD_TEST(basic, state);
+	ADD_TEST(basic, state_history);
+	ADD_TEST(basic, action);
+	ADD_TEST(basic, sequence);
+	ADD_TEST(basic, gesture);
+	ADD_TEST(basic, record);
+	ADD_TEST(basic, statistics);
+	ADD_TEST(basic, timestamp);
+	ADD_TEST(basic, text);
+	ADD_TEST(basic, velocity);
+	ADD_TEST(basic, condition);
+#if FOUNDATION_PLATFORM_LINUX
+	ADD_TEST(basic, evdev);
+	ADD_TEST(basic, evdev_thread);
+	ADD_TEST(basic, pad);
+	ADD_TEST(basic, iio);
+	ADD_TEST(basic, xinput);
+	ADD_TEST(basic, x11_keys);
+#endif
 }
 
 static test_suite_t test_basic_suite = {test_basic_application,
@@ -0,0 +1,754 @@
+/* main.c  -  Input library benchmarks  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+#include <test/test.h>
+
+#include <input/input.h>
+
+#if FOUNDATION_PLATFORM_LINUX
+#include <window/event.h>
+#include <X11/Xlib.h>
+#include <X11/keysym.h>
+#endif
+
+#include <stdlib.h>
+
+#define BENCH_PRODUCERS_MAX 16
+#define BENCH_POSTS_PER_PRODUCER 16384
+#define BENCH_ROUNDS 256
+#define BENCH_ROUND_EVENTS 256
+#define BENCH_DRAIN_EVENTS 4096
+
+/* Results are logged as one JSON object per line, prefixed with the bench name, so they can
+   be extracted from the log and tracked across releases. Timed runs are split in rounds and
+   reported as percentiles over the rounds of the time per event */
+
+static atomic32_t bench_start;
+static atomic32_t bench_producers_done;
+
+static application_t
+test_bench_application(void) {
+	application_t app;
+	memset(&app, 0, sizeof(app));
+	app.name = string_const(STRING_CONST("Input benchmarks"));
+	app.short_name = string_const(STRING_CONST("test_bench"));
+	app.company = string_const(STRING_CONST(""));
+	app.flags = APPLICATION_UTILITY;
+	app.exception_handler = test_exception_handler;
+	return app;
+}
+
+static foundation_config_t
+test_bench_config(void) {
+	foundation_config_t config;
+	memset(&config, 0, sizeof(config));
+	return config;
+}
+
+static memory_system_t
+test_bench_memory_system(void) {
+	return memory_system_malloc();
+}
+
+static int
+test_bench_initialize(void) {
+	log_set_suppress(HASH_MEMORY, ERRORLEVEL_DEBUG);
+	return 0;
+}
+
+static void
+test_bench_finalize(void) {
+}
+
+static void*
+bench_producer(void* arg) {
+	tick_t* elapsed = arg;
+	while (!atomic_load32(&bench_start, memory_order_acquire))
+		thread_yield();
+	tick_t start = time_current();
+	for (int ipost = 0; ipost < BENCH_POSTS_PER_PRODUCER; ++ipost)
+		input_event_post_mouse(INPUTEVENT_MOUSEMOVE, ipost, ipost, REAL_ONE, REAL_ONE, 0, 0, 0);
+	*elapsed = time_diff(start, time_current());
+	atomic_incr32(&bench_producers_done, memory_order_release);
+	return 0;
+}
+
+static size_t
+bench_drain(void) {
+	size_t count = 0;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event)))
+		++count;
+	return count;
+}
+
+static int
+bench_post_throughput(size_t ring_size) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = ring_size;
+
+	size_t producers_max = system_hardware_threads();
+	if (producers_max > BENCH_PRODUCERS_MAX)
+		producers_max = BENCH_PRODUCERS_MAX;
+	if (producers_max < 4)
+		producers_max = 4;
+
+	thread_t producer[BENCH_PRODUCERS_MAX];
+	tick_t producer_elapsed[BENCH_PRODUCERS_MAX];
+	for (size_t producers = 1; producers <= producers_max; ++producers) {
+		if (input_module_initialize(config) < 0)
+			return -1;
+
+		atomic_store32(&bench_start, 0, memory_order_release);
+		atomic_store32(&bench_producers_done, 0, memory_order_release);
+		for (size_t ithread = 0; ithread < producers; ++ithread) {
+			thread_initialize(&producer[ithread], bench_producer, &producer_elapsed[ithread],
+			                  STRING_CONST("bench_producer"), THREAD_PRIORITY_NORMAL, 0);
+			thread_start(&producer[ithread]);
+		}
+
+		atomic_store32(&bench_start, 1, memory_order_release);
+
+		// Consume on this thread while producers post, as a game loop would
+		size_t delivered = 0;
+		while (atomic_load32(&bench_producers_done, memory_order_acquire) < (int32_t)producers)
+			delivered += bench_drain();
+		delivered += bench_drain();
+
+		// Throughput is bounded by the slowest producer
+		tick_t elapsed = 0;
+		for (size_t ithread = 0; ithread < producers; ++ithread) {
+			thread_finalize(&producer[ithread]);
+			if (producer_elapsed[ithread] > elapsed)
+				elapsed = producer_elapsed[ithread];
+		}
+
+		input_module_finalize();
+
+		size_t posted = producers * BENCH_POSTS_PER_PRODUCER;
+		double seconds = (double)elapsed / (double)time_ticks_per_second();
+		log_infof(HASH_TEST,
+		          STRING_CONST("{\"bench\":\"post_threads_%s\",\"producers\":%u,\"posted\":%u,\"delivered\":%u,"
+		                       "\"events_per_second\":%.0f,\"ns_per_event\":%.1f}"),
+		          ring_size ? "ring" : "default", (unsigned int)producers, (unsigned int)posted,
+		          (unsigned int)delivered, (double)posted / seconds, (seconds * 1000000000.0) / (double)posted);
+	}
+	return 0;
+}
+
+static int
+bench_compare(const void* lhs, const void* rhs) {
+	double lvalue = *(const double*)lhs;
+	double rvalue = *(const double*)rhs;
+	return (lvalue < rvalue) ? -1 : ((lvalue > rvalue) ? 1 : 0);
+}
+
+static double
+bench_ns_per_event(tick_t elapsed, size_t events) {
+	return ((double)elapsed * 1000000000.0) / ((double)time_ticks_per_second() * (double)events);
+}
+
+static void
+bench_report(const char* name, const char* variant, double* samples, size_t count) {
+	qsort(samples, count, sizeof(double), bench_compare);
+	double p50 = samples[count / 2];
+	double p90 = samples[(count * 90) / 100];
+	double p99 = samples[(count * 99) / 100];
+	log_infof(HASH_TEST,
+	          STRING_CONST("{\"bench\":\"%s\",\"variant\":\"%s\",\"rounds\":%u,\"unit\":\"ns/event\","
+	                       "\"min\":%.1f,\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f,"
+	                       "\"events_per_second\":%.0f}"),
+	          name, variant, (unsigned int)count, samples[0], p50, p90, p99, samples[count - 1],
+	          p50 > 0 ? 1000000000.0 / p50 : 0.0);
+}
+
+typedef void (*bench_post_fn)(size_t count);
+
+static input_key_event_t bench_key[BENCH_ROUND_EVENTS];
+static input_mouse_event_t bench_mouse[BENCH_ROUND_EVENTS];
+static input_touch_event_t bench_touch[BENCH_ROUND_EVENTS];
+static input_acceleration_event_t bench_acceleration[BENCH_ROUND_EVENTS];
+
+static void
+bench_post_key(size_t count) {
+	for (size_t ievent = 0; ievent < count; ++ievent)
+		input_event_post_key(INPUTEVENT_KEYDOWN, bench_key[ievent].key, bench_key[ievent].scancode, 0);
+}
+
+static void
+bench_post_mouse(size_t count) {
+	for (size_t ievent = 0; ievent < count; ++ievent)
+		input_event_post_mouse(INPUTEVENT_MOUSEMOVE, bench_mouse[ievent].x, bench_mouse[ievent].y, REAL_ONE,
+		                       REAL_ONE, 0, 0, 0);
+}
+
+static void
+bench_post_touch(size_t count) {
+	for (size_t ievent = 0; ievent < count; ++ievent)
+		input_event_post_touch(INPUTEVENT_TOUCHMOVE, bench_touch[ievent].x, bench_touch[ievent].y, REAL_ONE, 0, 0,
+		                       bench_touch[ievent].touch, 1U << bench_touch[ievent].touch);
+}
+
+static void
+bench_post_acceleration(size_t count) {
+	for (size_t ievent = 0; ievent < count; ++ievent)
+		input_event_post_acceleration(INPUTEVENT_ACCELERATION, bench_acceleration[ievent].x,
+		                              bench_acceleration[ievent].y, bench_acceleration[ievent].z);
+}
+
+static void
+bench_post_key_batch(size_t count) {
+	input_event_post_key_batch(INPUTEVENT_KEYDOWN, bench_key, count);
+}
+
+static void
+bench_post_mouse_batch(size_t count) {
+	input_event_post_mouse_batch(INPUTEVENT_MOUSEMOVE, bench_mouse, count);
+}
+
+static void
+bench_post_touch_batch(size_t count) {
+	input_event_post_touch_batch(INPUTEVENT_TOUCHMOVE, bench_touch, count);
+}
+
+static void
+bench_post_acceleration_batch(size_t count) {
+	input_event_post_acceleration_batch(INPUTEVENT_ACCELERATION, bench_acceleration, count);
+}
+
+static void
+bench_payload_initialize(void) {
+	for (unsigned int ievent = 0; ievent < BENCH_ROUND_EVENTS; ++ievent) {
+		bench_key[ievent].key = KEY_A + (ievent % 26);
+		bench_key[ievent].scancode = ievent;
+		bench_key[ievent].flags = 0;
+		memset(bench_mouse + ievent, 0, sizeof(input_mouse_event_t));
+		bench_mouse[ievent].x = (int)ievent;
+		bench_mouse[ievent].y = (int)ievent;
+		bench_mouse[ievent].dx = REAL_ONE;
+		bench_mouse[ievent].dy = REAL_ONE;
+		memset(bench_touch + ievent, 0, sizeof(input_touch_event_t));
+		bench_touch[ievent].x = (int)ievent;
+		bench_touch[ievent].y = (int)ievent;
+		bench_touch[ievent].dx = REAL_ONE;
+		bench_touch[ievent].touch = ievent % 10;
+		bench_touch[ievent].touches = 1U << (ievent % 10);
+		bench_acceleration[ievent].x = REAL_HALF;
+		bench_acceleration[ievent].y = 0;
+		bench_acceleration[ievent].z = REAL_C(-9.81);
+	}
+}
+
+static int
+bench_post_function(const char* name, bench_post_fn fn) {
+	double samples[BENCH_ROUNDS];
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	bench_payload_initialize();
+	for (int iconfig = 0; iconfig < 2; ++iconfig) {
+		// Ring holds a full round so the numbers measure posting rather than overflow
+		config.event_ring_size = iconfig ? BENCH_ROUND_EVENTS * 2 : 0;
+		if (input_module_initialize(config) < 0)
+			return -1;
+		for (int iround = 0; iround < BENCH_ROUNDS; ++iround) {
+			tick_t start = time_current();
+			fn(BENCH_ROUND_EVENTS);
+			samples[iround] = bench_ns_per_event(time_diff(start, time_current()), BENCH_ROUND_EVENTS);
+			if (bench_drain() != BENCH_ROUND_EVENTS) {
+				input_module_finalize();
+				return -1;
+			}
+		}
+		input_module_finalize();
+		bench_report(name, iconfig ? "ring" : "default", samples, BENCH_ROUNDS);
+	}
+	return 0;
+}
+
+static int
+bench_drain_cost(input_config_t config, const char* variant) {
+	double samples[BENCH_ROUNDS / 4];
+	input_event_payload_t payload;
+	if (input_module_initialize(config) < 0)
+		return -1;
+	for (int iround = 0; iround < BENCH_ROUNDS / 4; ++iround) {
+		for (int ievent = 0; ievent < BENCH_DRAIN_EVENTS; ++ievent)
+			input_event_post_mouse(INPUTEVENT_MOUSEMOVE, ievent, ievent, REAL_ONE, REAL_ONE, 0, 0, 0);
+
+		size_t count = 0;
+		tick_t start = time_current();
+		event_block_t* block = event_stream_process(input_event_stream());
+		event_t* event = 0;
+		while ((event = event_next(block, event))) {
+			input_event_decode(event, &payload);
+			count += (payload.mouse.buttons == 0) ? 1 : 0;
+		}
+		samples[iround] = bench_ns_per_event(time_diff(start, time_current()), BENCH_DRAIN_EVENTS);
+		if (count != BENCH_DRAIN_EVENTS) {
+			input_module_finalize();
+			return -1;
+		}
+	}
+	input_module_finalize();
+	bench_report("drain", variant, samples, BENCH_ROUNDS / 4);
+	return 0;
+}
+
+static size_t
+bench_footprint_event(input_event_id id) {
+	switch (id) {
+		case INPUTEVENT_KEYDOWN:
+			bench_post_key(1);
+			break;
+		case INPUTEVENT_MOUSEMOVE:
+			bench_post_mouse(1);
+			break;
+		case INPUTEVENT_TOUCHMOVE:
+			bench_post_touch(1);
+			break;
+		case INPUTEVENT_ACCELERATION:
+		default:
+			bench_post_acceleration(1);
+			break;
+	}
+	size_t size = 0;
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event)))
+		size += event->size;
+	return size;
+}
+
+static int
+bench_footprint(void) {
+	const input_event_id id[] = {INPUTEVENT_KEYDOWN, INPUTEVENT_MOUSEMOVE, INPUTEVENT_TOUCHMOVE,
+	                             INPUTEVENT_ACCELERATION};
+	const char* name[] = {"key", "mouse", "touch", "acceleration"};
+	size_t stream_size[4] = {0};
+	size_t compact_size[4] = {0};
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	bench_payload_initialize();
+	for (int iconfig = 0; iconfig < 2; ++iconfig) {
+		config.event_compact = (iconfig > 0);
+		if (input_module_initialize(config) < 0)
+			return -1;
+		for (int iid = 0; iid < 4; ++iid) {
+			size_t size = bench_footprint_event(id[iid]);
+			if (iconfig)
+				compact_size[iid] = size;
+			else
+				stream_size[iid] = size;
+		}
+		input_module_finalize();
+	}
+	for (int iid = 0; iid < 4; ++iid)
+		log_infof(HASH_TEST,
+		          STRING_CONST("{\"bench\":\"footprint\",\"variant\":\"%s\",\"unit\":\"bytes/event\","
+		                       "\"stream\":%u,\"compact\":%u,\"ring\":%u}"),
+		          name[iid], (unsigned int)stream_size[iid], (unsigned int)compact_size[iid],
+		          (unsigned int)sizeof(input_event_t));
+	return 0;
+}
+
+static int
+bench_condition(const char* variant, const input_condition_t* condition) {
+	double samples[BENCH_ROUNDS];
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	if (input_module_initialize(config) < 0)
+		return -1;
+	input_condition_set(INPUTCHANNEL_ACCELERATION_X, INPUTCHANNEL_COUNT, condition);
+
+	// Snapshot cost per channel, including the key, mouse and pad snapshots the conditioning
+	// pass reads from
+	for (int iround = 0; iround < BENCH_ROUNDS; ++iround) {
+		real value = (real)(iround % 16) * REAL_C(0.0625);
+		input_event_post_mouse(INPUTEVENT_MOUSEMOVE, iround, iround, value, -value, 0, 0, 0);
+		input_event_post_acceleration(INPUTEVENT_ACCELERATION, value, -value, REAL_ONE);
+		tick_t start = time_current();
+		input_event_process();
+		samples[iround] = bench_ns_per_event(time_diff(start, time_current()), INPUTCHANNEL_COUNT);
+		bench_drain();
+	}
+	input_module_finalize();
+	bench_report("condition", variant, samples, BENCH_ROUNDS);
+	return 0;
+}
+
+#if FOUNDATION_PLATFORM_LINUX
+
+typedef struct bench_native_t bench_native_t;
+
+/* Layout of the window library native event payload */
+struct bench_native_t {
+	window_t* window;
+	XEvent xevent;
+};
+
+static int
+bench_decode_linux(void) {
+	double samples[BENCH_ROUNDS];
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	if (input_module_initialize(config) < 0)
+		return -1;
+
+	// Key events need a display for keysym lookup, so only pointer events are synthesized
+	event_stream_t* native = event_stream_allocate(BENCH_ROUND_EVENTS);
+	bench_native_t data;
+	memset(&data, 0, sizeof(data));
+	for (int iround = 0; iround < BENCH_ROUNDS; ++iround) {
+		for (int ievent = 0; ievent < BENCH_ROUND_EVENTS; ++ievent) {
+			int phase = ievent % 16;
+			if (phase == 0) {
+				data.xevent.type = ButtonPress;
+				data.xevent.xbutton.button = 1;
+			} else if (phase == 15) {
+				data.xevent.type = ButtonRelease;
+				data.xevent.xbutton.button = 1;
+			} else {
+				data.xevent.type = MotionNotify;
+			}
+			data.xevent.xmotion.x = ievent;
+			data.xevent.xmotion.y = iround;
+			event_post(native, WINDOWEVENT_NATIVE, 0, 0, &data, sizeof(data));
+		}
+
+		event_block_t* block = event_stream_process(native);
+		event_t* event = 0;
+		tick_t start = time_current();
+		while ((event = event_next(block, event)))
+			input_event_handle_window(event);
+		samples[iround] = bench_ns_per_event(time_diff(start, time_current()), BENCH_ROUND_EVENTS);
+		bench_drain();
+	}
+
+	event_stream_deallocate(native);
+	input_module_finalize();
+	bench_report("decode_x11", "pointer", samples, BENCH_ROUNDS);
+	return 0;
+}
+
+/* Keysym translation done for every key event before the keycode table, kept to compare
+   the two on the same events */
+static unsigned long
+bench_lookup_key_switch(KeySym sym) {
+	if (sym >= XK_a && sym <= XK_z)
+		return KEY_A + (sym - XK_a);
+	if (sym >= XK_A && sym <= XK_Z)
+		return KEY_A + (sym - XK_A);
+	if (sym >= XK_0 && sym <= XK_9)
+		return KEY_0 + (sym - XK_0);
+	if (sym >= XK_F1 && sym <= XK_F24)
+		return KEY_F1 + (sym - XK_F1);
+	if (sym >= XK_KP_0 && sym <= XK_KP_9)
+		return KEY_NP_0 + (sym - XK_KP_0);
+	switch (sym) {
+		case XK_Escape:
+			return KEY_ESCAPE;
+		case XK_space:
+			return KEY_SPACE;
+		case XK_Return:
+			return KEY_RETURN;
+		case XK_KP_Enter:
+			return KEY_RETURN;
+		case XK_Up:
+			return KEY_UP;
+		case XK_Down:
+			return KEY_DOWN;
+		case XK_Left:
+			return KEY_LEFT;
+		case XK_Right:
+			return KEY_RIGHT;
+		case XK_BackSpace:
+			return KEY_BACKSPACE;
+		case XK_KP_Add:
+			return KEY_NP_PLUS;
+		case XK_KP_Subtract:
+			return KEY_NP_MINUS;
+		case XK_KP_Separator:
+			return KEY_NP_DECIMAL;
+		case XK_KP_Divide:
+			return KEY_NP_DIVIDE;
+		case XK_KP_Multiply:
+			return KEY_NP_MULTIPLY;
+		case XK_Num_Lock:
+			return KEY_NP_NUMLOCK;
+		case XK_KP_Insert:
+			return KEY_NP_0;
+		case XK_KP_End:
+			return KEY_NP_1;
+		case XK_KP_Down:
+			return KEY_NP_2;
+		case XK_KP_Page_Down:
+			return KEY_NP_3;
+		case XK_KP_Left:
+			return KEY_NP_4;
+		case XK_KP_Begin:
+			return KEY_NP_5;
+		case XK_KP_Right:
+			return KEY_NP_6;
+		case XK_KP_Home:
+			return KEY_NP_7;
+		case XK_KP_Up:
+			return KEY_NP_8;
+		case XK_KP_Page_Up:
+			return KEY_NP_9;
+		case XK_Tab:
+			return KEY_TAB;
+		case XK_Caps_Lock:
+			return KEY_CAPSLOCK;
+		case XK_Shift_L:
+			return KEY_LSHIFT;
+		case XK_Shift_R:
+			return KEY_RSHIFT;
+		case XK_Control_L:
+			return KEY_LCTRL;
+		case XK_Control_R:
+			return KEY_RCTRL;
+		case XK_Alt_L:
+			return KEY_LALT;
+		case XK_Alt_R:
+			return KEY_RALT;
+		case 0xFE03:
+			return KEY_RALT;
+		case XK_Super_L:
+			return KEY_LMETA;
+		case XK_Super_R:
+			return KEY_RMETA;
+		case XK_Menu:
+			return KEY_MENU;
+		case XK_less:
+			return KEY_LESS;
+		case XK_Insert:
+			return KEY_INSERT;
+		case XK_Delete:
+			return KEY_DELETE;
+		case XK_Home:
+			return KEY_HOME;
+		case XK_End:
+			return KEY_END;
+		case XK_Page_Up:
+			return KEY_PAGEUP;
+		case XK_Page_Down:
+			return KEY_PAGEDOWN;
+		case XK_Print:
+			return KEY_PRINTSCREEN;
+		case XK_Scroll_Lock:
+			return KEY_SCROLLLOCK;
+		case XK_Pause:
+			return KEY_PAUSE;
+		case XK_plus:
+			return KEY_PLUS;
+		case XK_grave:
+			return KEY_GRAVEACCENT;
+		// case XK_dead_acute: return KEY_GRAVEACCENT;
+		case XK_apostrophe:
+			return KEY_APOSTROPHE;
+		case XK_comma:
+			return KEY_COMMA;
+		case XK_minus:
+			return KEY_MINUS;
+		case XK_period:
+			return KEY_PERIOD;
+		case XK_slash:
+			return KEY_SLASH;
+		case XK_backslash:
+			return KEY_BACKSLASH;
+		case XK_bracketleft:
+			return KEY_LEFTBRACKET;
+		case XK_bracketright:
+			return KEY_RIGHTBRACKET;
+		case XK_colon:
+			return KEY_COLON;
+		case XK_semicolon:
+			return KEY_SEMICOLON;
+		case XK_numbersign:
+			return KEY_HASH;
+		case XK_equal:
+			return KEY_EQUAL;
+	}
+	return KEY_UNKNOWN;
+}
+
+static int
+bench_decode_linux_keys(void) {
+	Display* display = XOpenDisplay(0);
+	if (!display) {
+		log_info(HASH_TEST, STRING_CONST("No X display, skipping key translation bench"));
+		return 0;
+	}
+	double samples[BENCH_ROUNDS];
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	if (input_module_initialize(config) < 0) {
+		XCloseDisplay(display);
+		return -1;
+	}
+
+	// Key releases, which unlike presses do not look up text, cycling through letters, digits,
+	// function keys and a few keys found by search in the keysym table
+	static const KeySym syms[] = {XK_a, XK_s, XK_d, XK_w, XK_1, XK_2, XK_F1, XK_space, XK_Return, XK_Escape,
+	                              XK_Left, XK_Right, XK_Shift_L, XK_Control_L, XK_Tab, XK_BackSpace};
+	const size_t sym_count = sizeof(syms) / sizeof(syms[0]);
+	event_stream_t* native = event_stream_allocate(BENCH_ROUND_EVENTS);
+	bench_native_t data;
+	memset(&data, 0, sizeof(data));
+	data.xevent.type = KeyRelease;
+	data.xevent.xkey.display = display;
+	for (int ievent = 0; ievent < BENCH_ROUND_EVENTS; ++ievent) {
+		data.xevent.xkey.keycode = XKeysymToKeycode(display, syms[(size_t)ievent % sym_count]);
+		data.xevent.xkey.time = (Time)ievent;
+		event_post(native, WINDOWEVENT_NATIVE, 0, 0, &data, sizeof(data));
+	}
+	event_block_t* block = event_stream_process(native);
+
+	// Xlib keysym lookup and switch translation per event, then posting the key as before
+	for (int iround = 0; iround < BENCH_ROUNDS; ++iround) {
+		event_t* event = 0;
+		tick_t start = time_current();
+		while ((event = event_next(block, event))) {
+			XKeyEvent* keyevent = &((bench_native_t*)event->payload)->xevent.xkey;
+			unsigned long key = bench_lookup_key_switch(XLookupKeysym(keyevent, 0));
+			input_event_post_key(INPUTEVENT_KEYUP, (unsigned int)key, keyevent->keycode, 0);
+		}
+		samples[iround] = bench_ns_per_event(time_diff(start, time_current()), BENCH_ROUND_EVENTS);
+		bench_drain();
+	}
+	bench_report("decode_x11", "switch", samples, BENCH_ROUNDS);
+
+	for (int iround = 0; iround < BENCH_ROUNDS; ++iround) {
+		event_t* event = 0;
+		tick_t start = time_current();
+		while ((event = event_next(block, event)))
+			input_event_handle_window(event);
+		samples[iround] = bench_ns_per_event(time_diff(start, time_current()), BENCH_ROUND_EVENTS);
+		bench_drain();
+	}
+	bench_report("decode_x11", "key", samples, BENCH_ROUNDS);
+
+	event_stream_deallocate(native);
+	input_module_finalize();
+	XCloseDisplay(display);
+	return 0;
+}
+
+#endif
+
+DECLARE_TEST(bench, post_default) {
+	EXPECT_INTEQ(bench_post_throughput(0), 0);
+	return 0;
+}
+
+DECLARE_TEST(bench, post_ring) {
+	// Size the ring to hold every post so the numbers measure posting rather than overflow
+	EXPECT_INTEQ(bench_post_throughput(BENCH_PRODUCERS_MAX * BENCH_POSTS_PER_PRODUCER * 2), 0);
+	return 0;
+}
+
+DECLARE_TEST(bench, post_functions) {
+	EXPECT_INTEQ(bench_post_function("post_key", bench_post_key), 0);
+	EXPECT_INTEQ(bench_post_function("post_mouse", bench_post_mouse), 0);
+	EXPECT_INTEQ(bench_post_function("post_touch", bench_post_touch), 0);
+	EXPECT_INTEQ(bench_post_function("post_acceleration", bench_post_acceleration), 0);
+	EXPECT_INTEQ(bench_post_function("post_key_batch", bench_post_key_batch), 0);
+	EXPECT_INTEQ(bench_post_function("post_mouse_batch", bench_post_mouse_batch), 0);
+	EXPECT_INTEQ(bench_post_function("post_touch_batch", bench_post_touch_batch), 0);
+	EXPECT_INTEQ(bench_post_function("post_acceleration_batch", bench_post_acceleration_batch), 0);
+	return 0;
+}
+
+DECLARE_TEST(bench, drain) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(bench_drain_cost(config, "default"), 0);
+	config.event_compact = true;
+	EXPECT_INTEQ(bench_drain_cost(config, "compact"), 0);
+	config.event_compact = false;
+	config.event_ring_size = BENCH_DRAIN_EVENTS * 2;
+	EXPECT_INTEQ(bench_drain_cost(config, "ring"), 0);
+	return 0;
+}
+
+DECLARE_TEST(bench, footprint) {
+	EXPECT_INTEQ(bench_footprint(), 0);
+	return 0;
+}
+
+DECLARE_TEST(bench, condition) {
+	input_condition_t condition;
+	memset(&condition, 0, sizeof(condition));
+	EXPECT_INTEQ(bench_condition("passthrough", &condition), 0);
+	condition.deadzone = REAL_C(0.1);
+	condition.curve = REAL_HALF;
+	condition.cutoff = REAL_ONE;
+	condition.beta = REAL_C(0.05);
+	EXPECT_INTEQ(bench_condition("one_euro", &condition), 0);
+	return 0;
+}
+
+DECLARE_TEST(bench, decode) {
+#if FOUNDATION_PLATFORM_LINUX
+	EXPECT_INTEQ(bench_decode_linux(), 0);
+	EXPECT_INTEQ(bench_decode_linux_keys(), 0);
+#endif
+	return 0;
+}
+
+static void
+test_bench_declare(void) {
+	ADD_TEST(bench, post_default);
+	ADD_TEST(bench, post_ring);
+	ADD_TEST(bench, post_functions);
+	ADD_TEST(bench, drain);
+	ADD_TEST(bench, footprint);
+	ADD_TEST(bench, condition);
+	ADD_TEST(bench, decode);
+}
+
+static test_suite_t test_bench_suite = {test_bench_application,
+                                        test_bench_memory_system,
+                                        test_bench_config,
+                                        test_bench_declare,
+                                        test_bench_initialize,
+                                        test_bench_finalize,
+                                        0};
+
+#if FOUNDATION_PLATFORM_ANDROID
+
+int
+test_bench_run(void);
+
+int
+test_bench_run(void) {
+	test_suite = test_bench_suite;
+	return test_run_all();
+}
+
+#else
+
+test_suite_t
+test_suite_define(void);
+
+test_suite_t
+test_suite_define(void) {
+	return test_bench_suite;
+}
+
+#endif
@@ -0,0 +1,268 @@
+/* main.c  -  Input library load generator tests  -  Public Domain  -  2017 Mattias Jansson
+ *
+ * This library provides a cross-platform input handling in C11 providing for projects based on our
+ * foundation library. The latest source code is always available at
+ *
+ * https://github.com/mjansson/input_lib
+ *
+ * This library is built on top of the foundation library available at
+ *
+ * https://github.com/mjansson/foundation_lib
+ *
+ * This library is put in the public domain; you can redistribute it and/or modify it without any restrictions.
+ *
+ */
+
+#include <foundation/foundation.h>
+#include <test/test.h>
+
+#include <input/input.h>
+
+#define LOADGEN_FRAME_MS 16
+
+static application_t
+test_loadgen_application(void) {
+	application_t app;
+	memset(&app, 0, sizeof(app));
+	app.name = string_const(STRING_CONST("Input load generator tests"));
+	app.short_name = string_const(STRING_CONST("test_loadgen"));
+	app.company = string_const(STRING_CONST(""));
+	app.flags = APPLICATION_UTILITY;
+	app.exception_handler = test_exception_handler;
+	return app;
+}
+
+static foundation_config_t
+test_loadgen_config(void) {
+	foundation_config_t config;
+	memset(&config, 0, sizeof(config));
+	return config;
+}
+
+static memory_system_t
+test_loadgen_memory_system(void) {
+	return memory_system_malloc();
+}
+
+static int
+test_loadgen_initialize(void) {
+	log_set_suppress(HASH_MEMORY, ERRORLEVEL_DEBUG);
+	return 0;
+}
+
+static void
+test_loadgen_finalize(void) {
+}
+
+static size_t
+loadgen_drain(void) {
+	size_t count = 0;
+	input_event_process();
+	event_block_t* block = event_stream_process(input_event_stream());
+	event_t* event = 0;
+	while ((event = event_next(block, event)))
+		++count;
+	return count;
+}
+
+/* Run a generator for the given simulated time in frames of LOADGEN_FRAME_MS, draining
+   the event stream after each frame. Fails unless every posted event is accounted for */
+static int
+loadgen_run(const char* name, input_config_t config, input_loadgen_workload workload, unsigned int rate,
+            unsigned int channels, unsigned int milliseconds, size_t* delivered,
+            input_queue_statistics_t* statistics) {
+	if (input_module_initialize(config) < 0)
+		return -1;
+	input_loadgen_t* generator = input_loadgen_allocate(workload, rate, channels, 1);
+
+	*delivered = 0;
+	tick_t elapsed = 0;
+	for (unsigned int time = 0; time < milliseconds; time += LOADGEN_FRAME_MS) {
+		input_loadgen_step(generator, LOADGEN_FRAME_MS);
+		tick_t start = time_current();
+		*delivered += loadgen_drain();
+		elapsed += time_diff(start, time_current());
+	}
+
+	uint64_t posted = input_loadgen_posted(generator);
+	*statistics = input_event_queue_statistics();
+	input_loadgen_deallocate(generator);
+	input_module_finalize();
+
+	double seconds = (double)elapsed / (double)time_ticks_per_second();
+	log_infof(HASH_TEST,
+	          STRING_CONST("%s: %" PRIu64 " posted, %u delivered, %" PRIu64 " coalesced, %" PRIu64
+	                       " dropped, high water %u, %.1f ns/event drained"),
+	          name, posted, (unsigned int)*delivered, statistics->coalesced, statistics->dropped,
+	          (unsigned int)statistics->high_water, (seconds * 1000000000.0) / (double)(posted ? posted : 1));
+
+	if (posted != (uint64_t)*delivered + statistics->coalesced + statistics->dropped)
+		return -1;
+	return 0;
+}
+
+DECLARE_TEST(loadgen, deterministic) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	EXPECT_INTEQ(input_module_initialize(config), 0);
+
+	int position[2][64];
+	for (int irun = 0; irun < 2; ++irun) {
+		input_loadgen_t* generator = input_loadgen_allocate(INPUTLOADGEN_MOUSE_MOTION, 8000, 0, 1234);
+		// Stepping in different intervals posts the same samples
+		EXPECT_SIZEEQ(input_loadgen_step(generator, irun ? 8 : 3), irun ? 64 : 24);
+		if (!irun)
+			EXPECT_SIZEEQ(input_loadgen_step(generator, 5), 40);
+		EXPECT_UINTEQ(input_loadgen_posted(generator), 64);
+		input_loadgen_deallocate(generator);
+
+		int count = 0;
+		input_event_payload_t payload;
+		event_block_t* block = event_stream_process(input_event_stream());
+		event_t* event = 0;
+		while ((event = event_next(block, event)) && (count < 64)) {
+			EXPECT_TRUE(input_event_decode(event, &payload));
+			position[irun][count++] = payload.mouse.x;
+		}
+		EXPECT_INTEQ(count, 64);
+	}
+	EXPECT_EQ(memcmp(position[0], position[1], sizeof(position[0])), 0);
+
+	input_loadgen_t* generator = input_loadgen_allocate(INPUTLOADGEN_ACCELERATION, 400, 0, 1);
+	EXPECT_SIZEEQ(input_loadgen_step(generator, 1), 0);
+	EXPECT_SIZEEQ(input_loadgen_step(generator, 4), 2);
+	input_loadgen_deallocate(generator);
+
+	input_module_finalize();
+	return 0;
+}
+
+DECLARE_TEST(loadgen, mouse_8khz) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 1024;
+	size_t delivered;
+	input_queue_statistics_t statistics;
+	EXPECT_INTEQ(loadgen_run("mouse 8 kHz", config, INPUTLOADGEN_MOUSE_MOTION, 8000, 0, 1000, &delivered,
+	                         &statistics),
+	             0);
+	EXPECT_UINTEQ(statistics.dropped, 0);
+	EXPECT_GE(statistics.high_water, 8000 * LOADGEN_FRAME_MS / 1000);
+
+	// Coalescing merges the moves of each frame into a single event
+	config.event_coalesce = true;
+	EXPECT_INTEQ(loadgen_run("mouse 8 kHz coalesced", config, INPUTLOADGEN_MOUSE_MOTION, 8000, 0, 1000,
+	                         &delivered, &statistics),
+	             0);
+	EXPECT_SIZEEQ(delivered, (1000 + LOADGEN_FRAME_MS - 1) / LOADGEN_FRAME_MS);
+	return 0;
+}
+
+DECLARE_TEST(loadgen, touch_storm) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	config.event_ring_size = 64;
+	config.event_overflow = INPUTOVERFLOW_DROP_NEWEST;
+	size_t delivered;
+	input_queue_statistics_t statistics;
+	EXPECT_INTEQ(loadgen_run("touch storm 10x1 kHz drop newest", config, INPUTLOADGEN_TOUCH_STORM, 1000, 10,
+	                         1000, &delivered, &statistics),
+	             0);
+	EXPECT_GT(statistics.dropped, 0);
+
+	config.event_overflow = INPUTOVERFLOW_DROP_OLDEST;
+	EXPECT_INTEQ(loadgen_run("touch storm 10x1 kHz drop oldest", config, INPUTLOADGEN_TOUCH_STORM, 1000, 10,
+	                         1000, &delivered, &statistics),
+	             0);
+	EXPECT_GT(statistics.dropped, 0);
+
+	config.event_overflow = INPUTOVERFLOW_GROW;
+	config.event_coalesce = true;
+	EXPECT_INTEQ(loadgen_run("touch storm 10x1 kHz coalesced", config, INPUTLOADGEN_TOUCH_STORM, 1000, 10, 1000,
+	                         &delivered, &statistics),
+	             0);
+	EXPECT_UINTEQ(statistics.dropped, 0);
+	EXPECT_GT(statistics.coalesced, 0);
+	return 0;
+}
+
+DECLARE_TEST(loadgen, key_rollover) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	size_t delivered;
+	input_queue_statistics_t statistics;
+	EXPECT_INTEQ(loadgen_run("key rollover 10 keys", config, INPUTLOADGEN_KEY_ROLLOVER, 100, 10, 1000, &delivered,
+	                         &statistics),
+	             0);
+	size_t frames = (1000 + LOADGEN_FRAME_MS - 1) / LOADGEN_FRAME_MS;
+	EXPECT_SIZEEQ(delivered, ((100 * frames * LOADGEN_FRAME_MS) / 1000) * 20);
+	EXPECT_UINTEQ(statistics.coalesced, 0);
+
+	// Key events are discrete and never coalesced or dropped oldest
+	config.event_coalesce = true;
+	config.event_overflow = INPUTOVERFLOW_DROP_OLDEST;
+	EXPECT_INTEQ(loadgen_run("key rollover 10 keys drop oldest", config, INPUTLOADGEN_KEY_ROLLOVER, 100, 10, 1000,
+	                         &delivered, &statistics),
+	             0);
+	EXPECT_UINTEQ(statistics.coalesced, 0);
+	EXPECT_UINTEQ(statistics.dropped, 0);
+	return 0;
+}
+
+DECLARE_TEST(loadgen, acceleration_400hz) {
+	input_config_t config;
+	memset(&config, 0, sizeof(config));
+	size_t delivered;
+	input_queue_statistics_t statistics;
+	EXPECT_INTEQ(loadgen_run("acceleration 400 Hz", config, INPUTLOADGEN_ACCELERATION, 400, 0, 1000, &delivered,
+	                         &statistics),
+	             0);
+	EXPECT_UINTEQ(statistics.coalesced, 0);
+
+	config.event_coalesce = true;
+	EXPECT_INTEQ(loadgen_run("acceleration 400 Hz coalesced", config, INPUTLOADGEN_ACCELERATION, 400, 0, 1000,
+	                         &delivered, &statistics),
+	             0);
+	EXPECT_SIZEEQ(delivered, (1000 + LOADGEN_FRAME_MS - 1) / LOADGEN_FRAME_MS);
+	return 0;
+}
+
+static void
+test_loadgen_declare(void) {
+	ADD_TEST(loadgen, deterministic);
+	ADD_TEST(loadgen, mouse_8khz);
+	ADD_TEST(loadgen, touch_storm);
+	ADD_TEST(loadgen, key_rollover);
+	ADD_TEST(loadgen, acceleration_400hz);
+}
+
+static test_suite_t test_loadgen_suite = {test_loadgen_application,
+                                          test_loadgen_memory_system,
+                                          test_loadgen_config,
+                                          test_loadgen_declare,
+                                          test_loadgen_initialize,
+                                          test_loadgen_finalize,
+                                          0};
+
+#if FOUNDATION_PLATFORM_ANDROID
+
+int
+test_loadgen_run(void);
+
+int
+test_loadgen_run(void) {
+	test_suite = test_loadgen_suite;
+	return test_run_all();
+}
+
+#else
+
+test_suite_t
+test_suite_define(void);
+
+test_suite_t
+test_suite_define(void) {
+	return test_loadgen_suite;
+}
+
+#endif